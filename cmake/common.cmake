@@ -110,6 +110,42 @@ include(CheckCXXSymbolExists)
 list(APPEND CMAKE_REQUIRED_INCLUDES ${Trilinos_INCLUDE_DIRS})
 check_cxx_symbol_exists(HAVE_TEUCHOS_COMPLEX "Teuchos_config.h" HAVE_TEUCHOS_COMPLEX)
 
+# SuiteSparse provides CHOLMOD, UMFPACK and KLU for the SparseDirectSolver.
+# Look next to the Trilinos TPLs first, since the "Cholmod" and "UMFPACK"
+# TPLs of Amesos usually come from the same installation.
+if (HYMLS_USE_SUITESPARSE)
+  set(SUITESPARSE_HINTS ${Trilinos_TPL_INCLUDE_DIRS} ${Trilinos_TPL_LIBRARY_DIRS})
+  if (DEFINED ENV{SUITESPARSE_DIR})
+    list(INSERT SUITESPARSE_HINTS 0 $ENV{SUITESPARSE_DIR})
+  endif()
+
+  find_path(SUITESPARSE_INCLUDE_DIR NAMES cholmod.h umfpack.h klu.h
+    HINTS ${SUITESPARSE_HINTS} PATH_SUFFIXES include suitesparse include/suitesparse)
+
+  set(SUITESPARSE_LIBRARIES)
+  set(SUITESPARSE_FOUND ON)
+  foreach (lib umfpack cholmod klu btf amd camd colamd ccolamd suitesparseconfig)
+    find_library(SUITESPARSE_${lib}_LIBRARY NAMES ${lib}
+      HINTS ${SUITESPARSE_HINTS} PATH_SUFFIXES lib lib64)
+    if (SUITESPARSE_${lib}_LIBRARY)
+      list(APPEND SUITESPARSE_LIBRARIES ${SUITESPARSE_${lib}_LIBRARY})
+    elseif (NOT lib MATCHES "^c(amd|colamd)$")
+      # camd and ccolamd are only needed by some CHOLMOD builds
+      set(SUITESPARSE_FOUND OFF)
+    endif()
+  endforeach()
+
+  if (SUITESPARSE_INCLUDE_DIR AND SUITESPARSE_FOUND)
+    message(STATUS "SuiteSparse found in ${SUITESPARSE_INCLUDE_DIR}")
+    include_directories(${SUITESPARSE_INCLUDE_DIR})
+    set(HAVE_SUITESPARSE ON)
+  else()
+    message(WARNING "HYMLS_USE_SUITESPARSE is set but SuiteSparse was not found, "
+      "set SUITESPARSE_DIR. The SparseDirectSolver will only provide KLU.")
+    set(SUITESPARSE_LIBRARIES)
+  endif()
+endif()
+
 if (HYMLS_USE_PHIST)
   find_package(phist REQUIRED CONFIG)
 endif()
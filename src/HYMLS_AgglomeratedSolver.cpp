@@ -0,0 +1,553 @@
+#include "HYMLS_AgglomeratedSolver.hpp"
+
+#include "HYMLS_config.h"
+
+#include "HYMLS_Macros.hpp"
+#include "HYMLS_Tools.hpp"
+#include "HYMLS_HyperCube.hpp"
+#include "HYMLS_MatrixUtils.hpp"
+#include "HYMLS_OverlappingPartitioner.hpp"
+#include "HYMLS_PerformanceReport.hpp"
+#include "HYMLS_Preconditioner.hpp"
+
+#include "Epetra_Comm.h"
+#include "Epetra_MpiComm.h"
+#include "Epetra_Map.h"
+#include "Epetra_Import.h"
+#include "Epetra_CrsMatrix.h"
+#include "Epetra_MultiVector.h"
+#include "Epetra_Vector.h"
+#include "Epetra_SerialDenseMatrix.h"
+
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_Array.hpp"
+#include "Teuchos_ParameterList.hpp"
+#include "Teuchos_toString.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace HYMLS
+  {
+
+AgglomeratedSolver::AgglomeratedSolver(
+  Teuchos::RCP<const Epetra_Map> map,
+  Teuchos::RCP<const OverlappingPartitioner> hid,
+  int numProc, int level)
+  :
+  comm_(Teuchos::rcp(map->Comm().Clone())),
+  myLevel_(level),
+  numProc_(numProc),
+  subComm_(MPI_COMM_NULL),
+  map_(map),
+  threadBudget_(-1),
+  haveBorder_(false),
+  label_("AgglomeratedSolver"),
+  initialized_(false), computed_(false)
+  {
+  HYMLS_LPROF2(label_, "Constructor");
+
+  const Epetra_MpiComm *mpiComm = dynamic_cast<const Epetra_MpiComm *>(comm_.get());
+  if (!mpiComm)
+    Tools::Error("agglomeration requires an Epetra_MpiComm", __FILE__, __LINE__);
+
+  int myPID = comm_->MyPID();
+  int group = (int)((long long)myPID * numProc_ / comm_->NumProc());
+
+  // Gather the nodes of every group of consecutive processors on the
+  // first one, like BasePartitioner::MoveMap() does. The first processor
+  // of group 0 is processor 0, so that one is always active.
+  MPI_Comm groupComm;
+  CHECK_ZERO(MPI_Comm_split(mpiComm->Comm(), group, myPID, &groupComm));
+
+  bool active = false;
+  Teuchos::Array<hymls_gidx> myGlobalElements;
+    {
+    Epetra_MpiComm groupEpetraComm(groupComm);
+    active = groupEpetraComm.MyPID() == 0;
+
+    hymls_gidx *baseGlobalElements;
+#ifdef HYMLS_LONG_LONG
+    baseGlobalElements = map_->MyGlobalElements64();
+#else
+    baseGlobalElements = map_->MyGlobalElements();
+#endif
+    Epetra_Map groupMap((hymls_gidx)-1, map_->NumMyElements(), baseGlobalElements,
+      (hymls_gidx)map_->IndexBase64(), groupEpetraComm);
+    Teuchos::RCP<Epetra_Map> gatheredMap = MatrixUtils::Gather(groupMap, 0);
+
+    for (int lid = 0; lid < gatheredMap->NumMyElements(); lid++)
+      myGlobalElements.append(gatheredMap->GID64(lid));
+    }
+  CHECK_ZERO(MPI_Comm_free(&groupComm));
+
+  agglomeratedMap_ = Teuchos::rcp(new Epetra_Map((hymls_gidx)-1,
+      myGlobalElements.size(), myGlobalElements.getRawPtr(),
+      (hymls_gidx)map_->IndexBase64(), *comm_));
+  importer_ = Teuchos::rcp(new Epetra_Import(*agglomeratedMap_, *map_));
+
+  CHECK_ZERO(MPI_Comm_split(mpiComm->Comm(), active ? 0 : MPI_UNDEFINED,
+      myPID, &subComm_));
+  if (active)
+    {
+    restrictedComm_ = Teuchos::rcp(new Epetra_MpiComm(subComm_));
+    restrictedMap_ = Teuchos::rcp(new Epetra_Map((hymls_gidx)-1,
+        myGlobalElements.size(), myGlobalElements.getRawPtr(),
+        (hymls_gidx)map_->IndexBase64(), *restrictedComm_));
+    }
+
+  hid_ = hid->SpawnRestrictedNextLevel(agglomeratedMap_, restrictedMap_);
+
+  // The HyperCube cannot be queried on the sub-communicator, so give the
+  // cores of the inactive processors to the active ones on the same node here
+  HyperCube const *topology = HyperCube::Instance();
+  if (topology != NULL && topology->IsCongruent(*comm_))
+    threadBudget_ = topology->NumThreads(IsActive());
+  }
+
+AgglomeratedSolver::~AgglomeratedSolver()
+  {
+  HYMLS_LPROF3(label_, "Destructor");
+
+  // Everything that lives on the sub-communicator has to be
+  // destroyed before we free it
+  preconditioner_ = Teuchos::null;
+  aggV_ = Teuchos::null;
+  aggW_ = Teuchos::null;
+  hid_ = Teuchos::null;
+  restrictedMap_ = Teuchos::null;
+  restrictedComm_ = Teuchos::null;
+
+  if (subComm_ != MPI_COMM_NULL)
+    MPI_Comm_free(&subComm_);
+  }
+
+int AgglomeratedSolver::NumAgglomeratedProcs(Epetra_Map const &map, int threshold)
+  {
+  int numProc = map.Comm().NumProc();
+  if (threshold <= 0 || numProc == 1)
+    return numProc;
+
+  if (!dynamic_cast<const Epetra_MpiComm *>(&map.Comm()))
+    return numProc;
+
+  hymls_gidx n = map.NumGlobalElements64();
+  if (n / numProc >= threshold)
+    return numProc;
+
+  return std::max((int)(n / threshold), 1);
+  }
+
+Teuchos::RCP<Epetra_CrsMatrix> AgglomeratedSolver::Restrict(
+  Epetra_CrsMatrix const &matrix) const
+  {
+  HYMLS_LPROF3(label_, "Restrict");
+
+  // The import is done by all processors
+  Epetra_CrsMatrix aggMatrix(Copy, *agglomeratedMap_, matrix.MaxNumEntries());
+  CHECK_ZERO(aggMatrix.Import(matrix, *importer_, Insert));
+
+  if (!IsActive())
+    return Teuchos::null;
+
+  Teuchos::RCP<Epetra_CrsMatrix> restrictedMatrix = Teuchos::rcp(new
+    Epetra_CrsMatrix(Copy, *restrictedMap_, matrix.MaxNumEntries()));
+
+  Teuchos::Array<hymls_gidx> indices;
+  Teuchos::Array<double> values;
+  for (int lid = 0; lid < restrictedMap_->NumMyElements(); lid++)
+    {
+    hymls_gidx gid = restrictedMap_->GID64(lid);
+    int len = aggMatrix.NumGlobalEntries(gid);
+    indices.resize(len);
+    values.resize(len);
+    CHECK_ZERO(aggMatrix.ExtractGlobalRowCopy(gid, len, len,
+        values.getRawPtr(), indices.getRawPtr()));
+    CHECK_NONNEG(restrictedMatrix->InsertGlobalValues(gid, len,
+        values.getRawPtr(), indices.getRawPtr()));
+    }
+  CHECK_ZERO(restrictedMatrix->FillComplete(*restrictedMap_, *restrictedMap_));
+
+  restrictedMatrix->SetLabel(matrix.Label());
+
+  return restrictedMatrix;
+  }
+
+Teuchos::RCP<Epetra_MultiVector> AgglomeratedSolver::RestrictedView(
+  Epetra_MultiVector &X) const
+  {
+  return Teuchos::rcp(new Epetra_MultiVector(View, *restrictedMap_,
+      X.Values(), X.Stride(), X.NumVectors()));
+  }
+
+int AgglomeratedSolver::SetMatrix(Teuchos::RCP<const Epetra_CrsMatrix> matrix,
+  Teuchos::RCP<Teuchos::ParameterList> params,
+  Teuchos::RCP<const Epetra_Vector> testVector)
+  {
+  HYMLS_LPROF2(label_, "SetMatrix");
+
+  matrix_ = matrix;
+  Teuchos::RCP<Epetra_CrsMatrix> restrictedMatrix = Restrict(*matrix_);
+
+  Teuchos::RCP<Epetra_Vector> restrictedTestVector = Teuchos::null;
+  if (testVector != Teuchos::null)
+    {
+    Epetra_Vector aggTestVector(*agglomeratedMap_);
+    CHECK_ZERO(aggTestVector.Import(*testVector, *importer_, Insert));
+    if (IsActive())
+      restrictedTestVector = Teuchos::rcp(new Epetra_Vector(Copy,
+          *restrictedMap_, aggTestVector.Values()));
+    }
+
+  preconditioner_ = Teuchos::null;
+  if (IsActive())
+    {
+    preconditioner_ = Teuchos::rcp(new Preconditioner(restrictedMatrix,
+        params, restrictedTestVector, myLevel_, hid_));
+    preconditioner_->SetThreadBudget(threadBudget_);
+    }
+
+  initialized_ = false;
+  computed_ = false;
+
+  return 0;
+  }
+
+int AgglomeratedSolver::SetMatrix(Teuchos::RCP<const Epetra_CrsMatrix> matrix)
+  {
+  HYMLS_LPROF2(label_, "SetMatrix");
+
+  matrix_ = matrix;
+  Teuchos::RCP<Epetra_CrsMatrix> restrictedMatrix = Restrict(*matrix_);
+
+  if (IsActive())
+    {
+    if (preconditioner_ == Teuchos::null)
+      Tools::Error("no preconditioner to set the matrix of", __FILE__, __LINE__);
+    preconditioner_->SetMatrix(restrictedMatrix);
+    }
+
+  initialized_ = false;
+  computed_ = false;
+
+  return 0;
+  }
+
+int AgglomeratedSolver::SetParameters(Teuchos::ParameterList& List)
+  {
+  HYMLS_LPROF3(label_, "SetParameters");
+  if (preconditioner_ != Teuchos::null)
+    {
+    CHECK_ZERO(preconditioner_->SetParameters(List));
+    }
+  return 0;
+  }
+
+int AgglomeratedSolver::Initialize()
+  {
+  HYMLS_LPROF2(label_, "Initialize");
+
+  if (IsActive())
+    {
+    if (preconditioner_ == Teuchos::null)
+      Tools::Error("SetMatrix() has not been called", __FILE__, __LINE__);
+    CHECK_ZERO(preconditioner_->Initialize());
+    }
+
+  initialized_ = true;
+  computed_ = false;
+
+  return 0;
+  }
+
+int AgglomeratedSolver::Compute()
+  {
+  HYMLS_LPROF(label_, "Compute");
+
+  int ierr = 0;
+  if (IsActive())
+    ierr = preconditioner_->Compute();
+
+  // Let everyone return the same value
+  CHECK_ZERO(comm_->Broadcast(&ierr, 1, 0));
+
+  computed_ = (ierr == 0);
+
+  return ierr;
+  }
+
+double AgglomeratedSolver::Condest(const Ifpack_CondestType CT,
+  const int MaxIters,
+  const double Tol,
+  Epetra_RowMatrix* Matrix)
+  {
+  return -1.0;
+  }
+
+double AgglomeratedSolver::Condest() const
+  {
+  return -1.0;
+  }
+
+int AgglomeratedSolver::ApplyInverse(const Epetra_MultiVector &X,
+  Epetra_MultiVector &Y) const
+  {
+  HYMLS_LPROF(label_, "ApplyInverse");
+
+  if (aggX_ == Teuchos::null || aggX_->NumVectors() != X.NumVectors())
+    {
+    aggX_ = Teuchos::rcp(new Epetra_MultiVector(*agglomeratedMap_, X.NumVectors()));
+    aggY_ = Teuchos::rcp(new Epetra_MultiVector(*agglomeratedMap_, X.NumVectors()));
+    }
+
+  CHECK_ZERO(aggX_->Import(X, *importer_, Insert));
+
+  if (IsActive())
+    {
+    CHECK_ZERO(preconditioner_->ApplyInverse(
+        *RestrictedView(*aggX_), *RestrictedView(*aggY_)));
+    }
+
+  CHECK_ZERO(Y.Export(*aggY_, *importer_, Insert));
+
+  return 0;
+  }
+
+const Epetra_RowMatrix& AgglomeratedSolver::Matrix() const
+  {
+  return *matrix_;
+  }
+
+int AgglomeratedSolver::NumInitialize() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0;
+  return preconditioner_->NumInitialize();
+  }
+
+int AgglomeratedSolver::NumCompute() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0;
+  return preconditioner_->NumCompute();
+  }
+
+int AgglomeratedSolver::NumApplyInverse() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0;
+  return preconditioner_->NumApplyInverse();
+  }
+
+double AgglomeratedSolver::InitializeTime() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0.0;
+  return preconditioner_->InitializeTime();
+  }
+
+double AgglomeratedSolver::ComputeTime() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0.0;
+  return preconditioner_->ComputeTime();
+  }
+
+double AgglomeratedSolver::ApplyInverseTime() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0.0;
+  return preconditioner_->ApplyInverseTime();
+  }
+
+double AgglomeratedSolver::InitializeFlops() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0.0;
+  return preconditioner_->InitializeFlops();
+  }
+
+double AgglomeratedSolver::ComputeFlops() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0.0;
+  return preconditioner_->ComputeFlops();
+  }
+
+double AgglomeratedSolver::ApplyInverseFlops() const
+  {
+  if (preconditioner_ == Teuchos::null)
+    return 0.0;
+  return preconditioner_->ApplyInverseFlops();
+  }
+
+void AgglomeratedSolver::AddToReport(PerformanceReport &report) const
+  {
+  HYMLS_LPROF3(label_, "AddToReport");
+
+  if (matrix_ == Teuchos::null)
+    return;
+
+  // The report of the preconditioner only exists on the active
+  // processors, the others add zeros
+  Teuchos::RCP<PerformanceReport> restrictedReport = Teuchos::null;
+  if (preconditioner_ != Teuchos::null)
+    {
+    restrictedReport = Teuchos::rcp(new PerformanceReport(restrictedComm_));
+    preconditioner_->AddToReport(*restrictedReport);
+    }
+  report.Merge(restrictedReport.get(), 0);
+  }
+
+void AgglomeratedSolver::Visualize(std::string filename) const
+  {
+  if (preconditioner_ != Teuchos::null)
+    preconditioner_->Visualize(filename);
+  }
+
+std::ostream& AgglomeratedSolver::Print(std::ostream& os) const
+  {
+  os << label_ << " on " << numProc_ << " processors" << std::endl;
+  if (preconditioner_ != Teuchos::null)
+    preconditioner_->Print(os);
+  return os;
+  }
+
+int AgglomeratedSolver::SetUseTranspose(bool UseTranspose)
+  {
+  return -1;
+  }
+
+int AgglomeratedSolver::Apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
+  {
+  return matrix_->Apply(X, Y);
+  }
+
+double AgglomeratedSolver::NormInf() const
+  {
+  return matrix_->NormInf();
+  }
+
+const char * AgglomeratedSolver::Label() const
+  {
+  return label_.c_str();
+  }
+
+bool AgglomeratedSolver::UseTranspose() const
+  {
+  return false;
+  }
+
+bool AgglomeratedSolver::HasNormInf() const
+  {
+  return true;
+  }
+
+const Epetra_Comm & AgglomeratedSolver::Comm() const
+  {
+  return *comm_;
+  }
+
+const Epetra_Map & AgglomeratedSolver::OperatorDomainMap() const
+  {
+  return *map_;
+  }
+
+const Epetra_Map & AgglomeratedSolver::OperatorRangeMap() const
+  {
+  return *map_;
+  }
+
+int AgglomeratedSolver::SetBorder(Teuchos::RCP<const Epetra_MultiVector> V,
+  Teuchos::RCP<const Epetra_MultiVector> W,
+  Teuchos::RCP<const Epetra_SerialDenseMatrix> C)
+  {
+  HYMLS_LPROF(label_, "SetBorder");
+
+  if (V == Teuchos::null)
+    {
+    // unset
+    haveBorder_ = false;
+    if (preconditioner_ != Teuchos::null)
+      {
+      CHECK_ZERO(preconditioner_->SetBorder(Teuchos::null));
+      }
+    aggV_ = Teuchos::null;
+    aggW_ = Teuchos::null;
+    return 0;
+    }
+
+  aggV_ = Teuchos::rcp(new Epetra_MultiVector(*agglomeratedMap_, V->NumVectors()));
+  CHECK_ZERO(aggV_->Import(*V, *importer_, Insert));
+
+  aggW_ = Teuchos::null;
+  if (W != Teuchos::null)
+    {
+    aggW_ = Teuchos::rcp(new Epetra_MultiVector(*agglomeratedMap_, W->NumVectors()));
+    CHECK_ZERO(aggW_->Import(*W, *importer_, Insert));
+    }
+
+  haveBorder_ = true;
+
+  if (preconditioner_ == Teuchos::null)
+    return 0;
+
+  Teuchos::RCP<const Epetra_MultiVector> restrictedW = Teuchos::null;
+  if (aggW_ != Teuchos::null)
+    restrictedW = RestrictedView(*aggW_);
+
+  return preconditioner_->SetBorder(RestrictedView(*aggV_), restrictedW, C);
+  }
+
+int AgglomeratedSolver::Apply(const Epetra_MultiVector & B, const Epetra_SerialDenseMatrix & C,
+  Epetra_MultiVector& X, Epetra_SerialDenseMatrix & Y) const
+  {
+  return -1;
+  }
+
+// compute [X S]' = [K V;W' C]\[Y T]'
+int AgglomeratedSolver::ApplyInverse(const Epetra_MultiVector &X,
+  const Epetra_SerialDenseMatrix &T,
+  Epetra_MultiVector &Y,
+  Epetra_SerialDenseMatrix &S) const
+  {
+  HYMLS_LPROF2(label_, "ApplyInverse (bordered)");
+
+  if (!IsComputed())
+    {
+    return -1;
+    }
+
+  if (!HaveBorder())
+    {
+    HYMLS_DEBUG("border not set!");
+    return ApplyInverse(X, Y);
+    }
+
+  if (S.LDA() != S.M())
+    Tools::Error("Unsupported communication: " + Teuchos::toString(S.M()) + " "
+      + Teuchos::toString(S.LDA()), __FILE__, __LINE__);
+
+  if (aggX_ == Teuchos::null || aggX_->NumVectors() != X.NumVectors())
+    {
+    aggX_ = Teuchos::rcp(new Epetra_MultiVector(*agglomeratedMap_, X.NumVectors()));
+    aggY_ = Teuchos::rcp(new Epetra_MultiVector(*agglomeratedMap_, X.NumVectors()));
+    }
+
+  CHECK_ZERO(aggX_->Import(X, *importer_, Insert));
+
+  if (IsActive())
+    {
+    CHECK_ZERO(preconditioner_->ApplyInverse(
+        *RestrictedView(*aggX_), T, *RestrictedView(*aggY_), S));
+    }
+
+  // S is only computed on the active processors
+  CHECK_ZERO(comm_->Broadcast(S.A(), S.M() * S.N(), 0));
+
+  CHECK_ZERO(Y.Export(*aggY_, *importer_, Insert));
+
+  return 0;
+  }
+
+  }
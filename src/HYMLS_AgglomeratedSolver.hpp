@@ -0,0 +1,295 @@
+#ifndef HYMLS_AGGLOMERATED_SOLVER_H
+#define HYMLS_AGGLOMERATED_SOLVER_H
+
+#include "HYMLS_config.h"
+
+#include "Teuchos_RCP.hpp"
+
+#include "Ifpack_CondestType.h"
+#include "Ifpack_Preconditioner.h"
+
+#include "HYMLS_BorderedOperator.hpp"
+
+#include <mpi.h>
+
+#include <string>
+
+// forward declarations
+class Epetra_Comm;
+class Epetra_MpiComm;
+class Epetra_Map;
+class Epetra_Import;
+class Epetra_RowMatrix;
+class Epetra_CrsMatrix;
+class Epetra_SerialDenseMatrix;
+class Epetra_MultiVector;
+class Epetra_Vector;
+
+namespace Teuchos
+  {
+class ParameterList;
+  }
+
+namespace HYMLS {
+
+class OverlappingPartitioner;
+class PerformanceReport;
+class Preconditioner;
+
+//! Solver for a level of the preconditioner on fewer processors
+
+/*! The reduced Schur complement of a coarse level is small, but by
+  default it still lives on all processors, so every collective on
+  that level involves the full communicator. This class moves the
+  matrix to the first processor of each of numProc groups of
+  consecutive ranks, and solves it with a HYMLS::Preconditioner on a
+  communicator that only contains those processors (created with
+  MPI_Comm_split). The other processors only take part in the
+  import and export of vectors. See "Agglomeration Threshold".
+*/
+class AgglomeratedSolver: public Ifpack_Preconditioner,
+                          public BorderedOperator
+  {
+public:
+  AgglomeratedSolver() = delete;
+
+  //! Create the sub-communicator and the maps for the vector space
+  //! map and the partitioner of the next level, spawned from hid.
+  AgglomeratedSolver(
+    Teuchos::RCP<const Epetra_Map> map,
+    Teuchos::RCP<const OverlappingPartitioner> hid,
+    int numProc, int level);
+
+  virtual ~AgglomeratedSolver();
+
+  //! Number of processors that a level with the given map should be
+  //! agglomerated on to have at least threshold nodes per processor.
+  //! Returns the number of processors in the communicator if nothing
+  //! has to be done or if it is not an Epetra_MpiComm.
+  static int NumAgglomeratedProcs(Epetra_Map const &map, int threshold);
+
+  //! Set the matrix and create the preconditioner for it. The matrix
+  //! and the test vector are based on the map from the constructor.
+  int SetMatrix(Teuchos::RCP<const Epetra_CrsMatrix> matrix,
+    Teuchos::RCP<Teuchos::ParameterList> params,
+    Teuchos::RCP<const Epetra_Vector> testVector);
+
+  //! Replace the matrix but keep the preconditioner. This has the
+  //! same restrictions as Preconditioner::SetMatrix().
+  int SetMatrix(Teuchos::RCP<const Epetra_CrsMatrix> matrix);
+
+  //! true if this processor is in the sub-communicator
+  bool IsActive() const {return restrictedComm_ != Teuchos::null;}
+
+  //! Number of processors in the sub-communicator
+  int NumActiveProcs() const {return numProc_;}
+
+  //! Cores per thread that are given to the preconditioner on the
+  //! sub-communicator, see Preconditioner::SetThreadBudget()
+  int ThreadBudget() const {return threadBudget_;}
+
+  //! The preconditioner on the sub-communicator, null on the
+  //! processors that are not in it
+  Teuchos::RCP<const Preconditioner> NextLevel() const {return preconditioner_;}
+
+  //! Add the performance data of the preconditioner on the
+  //! sub-communicator. This has to be called by all processors.
+  void AddToReport(PerformanceReport &report) const;
+
+  //! Write the ordering of the next level (only for the active processors)
+  void Visualize(std::string filename) const;
+
+  //! \name Ifpack_Preconditioner interface
+  //@{
+
+  //! Sets all parameters for the preconditioner.
+  int SetParameters(Teuchos::ParameterList& List);
+
+  //! Computes all it is necessary to initialize the preconditioner.
+  int Initialize();
+
+  //! Returns true if the  preconditioner has been successfully initialized, false otherwise.
+  bool IsInitialized() const {return initialized_;}
+
+  //! Computes all it is necessary to apply the preconditioner.
+  int Compute();
+
+  //! Returns true if the  preconditioner has been successfully computed, false otherwise.
+  bool IsComputed() const {return computed_;}
+
+  //! Computes the condition number estimate, returns its value.
+  double Condest(const Ifpack_CondestType CT = Ifpack_Cheap,
+    const int MaxIters = 1550,
+    const double Tol = 1e-9,
+    Epetra_RowMatrix* Matrix = 0);
+
+  //! Returns the computed condition number estimate, or -1.0 if not computed.
+  double Condest() const;
+
+  //! Applies the preconditioner to vector X, returns the result in Y.
+  int ApplyInverse(const Epetra_MultiVector& X,
+    Epetra_MultiVector& Y) const;
+
+  //! Returns a pointer to the matrix to be preconditioned.
+  const Epetra_RowMatrix& Matrix() const;
+
+  //! Returns the number of calls to Initialize().
+  int NumInitialize() const;
+
+  //! Returns the number of calls to Compute().
+  int NumCompute() const;
+
+  //! Returns the number of calls to ApplyInverse().
+  int NumApplyInverse() const;
+
+  //! Returns the time spent in Initialize().
+  double InitializeTime() const;
+
+  //! Returns the time spent in Compute().
+  double ComputeTime() const;
+
+  //! Returns the time spent in ApplyInverse().
+  double ApplyInverseTime() const;
+
+  //! Returns the number of flops in the initialization phase.
+  double InitializeFlops() const;
+
+  //! Returns the number of flops in the computation phase.
+  double ComputeFlops() const;
+
+  //! Returns the number of flops in the application of the preconditioner.
+  double ApplyInverseFlops() const;
+
+  //! Prints basic information on iostream. This function is used by operator<<.
+  std::ostream& Print(std::ostream& os) const;
+
+  //@}
+
+  //! \name Epetra_Operator interface
+  //@{
+
+  //! If set true, transpose of this operator will be applied.
+  int SetUseTranspose(bool UseTranspose);
+
+  //! Returns the result of a Epetra_Operator applied to a Epetra_MultiVector X in Y.
+  int Apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const;
+
+  //! Returns the infinity norm of the global matrix.
+  double NormInf() const;
+
+  //! Returns a character string describing the operator
+  const char * Label() const;
+
+  //! Returns the current UseTranspose setting.
+  bool UseTranspose() const;
+
+  //! Returns true if the \e this object can provide an approximate Inf-norm, false otherwise.
+  bool HasNormInf() const;
+
+  //! Returns a pointer to the Epetra_Comm communicator associated with this operator.
+  const Epetra_Comm & Comm() const;
+
+  //! Returns the Epetra_Map object associated with the domain of this operator.
+  const Epetra_Map & OperatorDomainMap() const;
+
+  //! Returns the Epetra_Map object associated with the range of this operator.
+  const Epetra_Map & OperatorRangeMap() const;
+
+  //@}
+
+  //! \name HYMLS BorderedOperator interface
+  //@{
+
+  //!
+  int SetBorder(Teuchos::RCP<const Epetra_MultiVector> V,
+    Teuchos::RCP<const Epetra_MultiVector> W,
+    Teuchos::RCP<const Epetra_SerialDenseMatrix> C);
+
+  //!
+  bool HaveBorder() const {return haveBorder_;}
+
+  //!
+  int Apply(const Epetra_MultiVector & B, const Epetra_SerialDenseMatrix & C,
+    Epetra_MultiVector& X, Epetra_SerialDenseMatrix & Y) const;
+
+  //! Compute [X S]' = [K V;W' C] \ [Y T]'
+  int ApplyInverse(const Epetra_MultiVector& X,
+    const Epetra_SerialDenseMatrix& T,
+    Epetra_MultiVector& Y,
+    Epetra_SerialDenseMatrix& S) const;
+
+  //@}
+
+protected:
+
+  //! Copy a matrix based on map_ to restrictedMap_
+  Teuchos::RCP<Epetra_CrsMatrix> Restrict(Epetra_CrsMatrix const &matrix) const;
+
+  //! View of a vector based on agglomeratedMap_ as a vector based
+  //! on restrictedMap_ (only on the active processors)
+  Teuchos::RCP<Epetra_MultiVector> RestrictedView(Epetra_MultiVector &X) const;
+
+  //! communicator
+  Teuchos::RCP<const Epetra_Comm> comm_;
+
+  //! my level ID
+  int myLevel_;
+
+  //! number of processors in the sub-communicator
+  int numProc_;
+
+  //! the sub-communicator (MPI_COMM_NULL if not active)
+  MPI_Comm subComm_;
+
+  //! the sub-communicator as Epetra object (null if not active)
+  Teuchos::RCP<Epetra_MpiComm> restrictedComm_;
+
+  //! map of the operator
+  Teuchos::RCP<const Epetra_Map> map_;
+
+  //! map with all nodes on the active processors
+  Teuchos::RCP<const Epetra_Map> agglomeratedMap_;
+
+  //! agglomeratedMap_ on the sub-communicator (null if not active)
+  Teuchos::RCP<const Epetra_Map> restrictedMap_;
+
+  //! importer from map_ to agglomeratedMap_
+  Teuchos::RCP<Epetra_Import> importer_;
+
+  //! partitioner for the next level on the sub-communicator
+  Teuchos::RCP<const OverlappingPartitioner> hid_;
+
+  //! cores per thread of the active processors, computed with the
+  //! HyperCube on the full communicator (-1 if there is none), see
+  //! Preconditioner::SetThreadBudget()
+  int threadBudget_;
+
+  //! input matrix
+  Teuchos::RCP<const Epetra_CrsMatrix> matrix_;
+
+  //! preconditioner on the sub-communicator
+  Teuchos::RCP<Preconditioner> preconditioner_;
+
+  //! agglomerated border, which is viewed by the border of preconditioner_
+  Teuchos::RCP<Epetra_MultiVector> aggV_, aggW_;
+
+  //! agglomerated vectors used in ApplyInverse(), mutable temporary data
+  mutable Teuchos::RCP<Epetra_MultiVector> aggX_, aggY_;
+
+  //! true if addBorder() has been called with non-null args
+  bool haveBorder_;
+
+  //! label
+  std::string label_;
+
+  //! has Initialize() been called?
+  bool initialized_;
+
+  //! has Compute() been called?
+  bool computed_;
+
+  };
+
+  }
+
+#endif
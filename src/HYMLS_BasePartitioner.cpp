@@ -12,6 +12,7 @@
 #include "Teuchos_StandardParameterEntryValidators.hpp"
 
 #include "Epetra_Map.h"
+#include "Epetra_Vector.h"
 #include "Epetra_Comm.h"
 #include "Epetra_MpiComm.h"
 #include "Epetra_Distributor.h"
@@ -20,6 +21,10 @@
 #include "HYMLS_Tester.hpp"
 #endif
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 namespace HYMLS {
 
 BasePartitioner::BasePartitioner(Epetra_Comm const &comm, int level)
@@ -42,7 +47,7 @@ void BasePartitioner::SetParameters(Teuchos::ParameterList& params)
   ny_ = probList.get("ny", nx_);
   nz_ = probList.get("nz", dim_ > 2 ? nx_ : 1);
 
-  if (nx_ == -1)
+  if (nx_ == -1 && NeedsGridSize())
     Tools::Error("You must presently specify nx, ny (and possibly nz) in the 'Problem' sublist",
       __FILE__, __LINE__);
 
@@ -375,6 +380,9 @@ int BasePartitioner::CreatePIDMap()
     return 0;
     }
 
+  if (weights_ != Teuchos::null)
+    return CreateWeightedPIDMap();
+
   pidMap_ = Teuchos::rcp(new Teuchos::Array<int>(nparts, -1));
   Teuchos::Array<Teuchos::Array<int> > pidGroups(nparts);
   Teuchos::Array<int> sdPidNum(nparts, 0);
@@ -585,6 +593,114 @@ int BasePartitioner::CreatePIDMap()
   return 0;
   }
 
+int BasePartitioner::CreateWeightedPIDMap()
+  {
+  HYMLS_PROF2("BasePartitioner", "CreateWeightedPIDMap");
+
+  int nparts = NumGlobalParts(sx_, sy_, sz_);
+
+  // Add up the cost of the nodes in every subdomain
+  Teuchos::Array<double> localCost(nparts, 0.0);
+  Teuchos::Array<double> cost(nparts, 0.0);
+  for (int lid = 0; lid < weights_->MyLength(); lid++)
+    {
+    int i, j, k, var;
+    hymls_gidx gid = weights_->Map().GID64(lid);
+    Tools::ind2sub(nx_, ny_, nz_, dof_, gid, i, j, k, var);
+    int sd = GetSubdomainID(sx_, sy_, sz_, i, j, k);
+    if (sd < 0 || sd >= nparts)
+      Tools::Error("Invalid subdomain index " + Teuchos::toString(sd) +
+        " for gid " + Teuchos::toString(gid), __FILE__, __LINE__);
+    localCost[sd] += (*weights_)[lid];
+    }
+  CHECK_ZERO(comm_->SumAll(localCost.getRawPtr(), cost.getRawPtr(), nparts));
+
+  double totalCost = std::accumulate(cost.begin(), cost.end(), 0.0);
+  if (totalCost <= 0.0)
+    {
+    Tools::Warning("All weights are zero, distributing the subdomains evenly",
+      __FILE__, __LINE__);
+    std::fill(cost.begin(), cost.end(), 1.0);
+    totalCost = nparts;
+    }
+
+  // Subdomain sizes on all coarser levels up to the entire domain
+  Teuchos::Array<int> sizes;
+  int sx = sx_;
+  int sy = sy_;
+  int sz = sz_;
+  while (true)
+    {
+    sizes.append(sx);
+    sizes.append(sy);
+    sizes.append(sz);
+
+    if ((sx >= nx_ || cx_ <= 1) && (sy >= ny_ || cy_ <= 1) &&
+      (sz >= nz_ || cz_ <= 1))
+      break;
+
+    sx = sx * cx_;
+    sy = sy * cy_;
+    if (nz_ > 1)
+      sz = sz * cz_;
+    }
+
+  // Sort the subdomains by the subdomain they are in on the
+  // coarsest level, then the next level, and so on. Consecutive
+  // subdomains are then close to each other, and on the next levels
+  // a subdomain is spread over as few processors as possible.
+  std::vector<std::vector<int> > keys(nparts);
+  for (int sd = 0; sd < nparts; sd++)
+    {
+    int x, y, z;
+    GetSubdomainPosition(sd, sx_, sy_, sz_, x, y, z);
+
+    x = (x % nx_ + nx_) % nx_;
+    y = (y % ny_ + ny_) % ny_;
+    z = (z % nz_ + nz_) % nz_;
+
+    for (int l = sizes.size() - 3; l >= 0; l -= 3)
+      keys[sd].push_back(GetSubdomainID(sizes[l], sizes[l+1], sizes[l+2], x, y, z));
+    keys[sd].push_back(sd);
+    }
+
+  std::vector<int> order(nparts);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+    [&keys](int a, int b){return keys[a] < keys[b];});
+
+  // Cut the ordered subdomains into consecutive chunks of about
+  // equal cost. The target is updated after every chunk so the
+  // last processors do not end up with the remainder.
+  int nprocs = std::min(comm_->NumProc(), nparts);
+  pidMap_ = Teuchos::rcp(new Teuchos::Array<int>(nparts, -1));
+  Teuchos::Array<double> pidCost(nprocs, 0.0);
+
+  int pid = 0;
+  double remainingCost = totalCost;
+  double targetCost = totalCost / nprocs;
+  for (int sd: order)
+    {
+    if (pidCost[pid] > 0.0 && pid < nprocs - 1 &&
+      pidCost[pid] + cost[sd] / 2 > targetCost)
+      {
+      remainingCost -= pidCost[pid];
+      pid++;
+      targetCost = remainingCost / (nprocs - pid);
+      }
+    (*pidMap_)[sd] = pid;
+    pidCost[pid] += cost[sd];
+    }
+
+  nprocs_ = pid + 1;
+
+  double maxCost = *std::max_element(pidCost.begin(), pidCost.end());
+  Tools::Out("Load imbalance of the weighted partitioning: " +
+    Teuchos::toString(maxCost * nprocs_ / totalCost));
+
+  return 0;
+  }
+
 Teuchos::RCP<const Epetra_Map> BasePartitioner::MoveMap(
   Teuchos::RCP<const Epetra_Map> baseMap) const
   {
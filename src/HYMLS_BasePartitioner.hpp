@@ -9,6 +9,7 @@
 
 class Epetra_Map;
 class Epetra_Comm;
+class Epetra_Vector;
 
 namespace Teuchos {
 class ParameterList;
@@ -88,8 +89,21 @@ public:
   virtual Teuchos::RCP<const Epetra_Map> MoveMap(
     Teuchos::RCP<const Epetra_Map> baseMap) const;
 
+  //! set the cost of every node in the map that is partitioned
+  //! (e.g. the number of nonzeros in its row, or 0 for inactive
+  //! nodes). If set before Partition(), the subdomains are
+  //! distributed such that every processor gets an equal share
+  //! of the total cost. The separators are not affected.
+  void SetWeights(Teuchos::RCP<const Epetra_Vector> weights)
+    {
+    weights_ = weights;
+    }
+
 protected:
 
+  //! does this partitioner need the grid size nx, ny and nz?
+  virtual bool NeedsGridSize() const {return true;}
+
   //! Get the position of the first node of the subdomain
   virtual int GetSubdomainPosition(int sd, int sx, int sy, int sz, int &x, int &y, int &z) const = 0;
 
@@ -99,6 +113,12 @@ protected:
   //! Create a map of what processor a subdomain belongs to
   virtual int CreatePIDMap();
 
+  //! Create a map of what processor a subdomain belongs to
+  //! based on the cost of the subdomains. Subdomains that are
+  //! in the same subdomain on a coarser level are kept together
+  //! as much as possible.
+  int CreateWeightedPIDMap();
+
   //! Repartitioning may occur for two reasons, typically on coarser levels:
   //! a) the number of subdomains becomes smaller than the number of processes,
   //! b) the subdomains can't be nicely distributed among the processes.
@@ -161,6 +181,9 @@ protected:
   //! map of what processor a subdomain belongs to
   Teuchos::RCP<Teuchos::Array<int> > pidMap_;
 
+  //! cost of every node for load balancing (may be null)
+  Teuchos::RCP<const Epetra_Vector> weights_;
+
   //! pid which all nodes on this processor have to be moved to
   mutable int destinationPID_;
 
@@ -6,6 +6,8 @@
 #include "HYMLS_MatrixUtils.hpp"
 #include "HYMLS_DenseUtils.hpp"
 #include "HYMLS_ProjectedOperator.hpp"
+#include "HYMLS_PerformanceReport.hpp"
+#include "HYMLS_Preconditioner.hpp"
 
 #include "Epetra_Comm.h"
 #include "Epetra_RowMatrix.h"
@@ -46,6 +48,7 @@ BaseSolver::BaseSolver(Teuchos::RCP<const Epetra_Operator> K,
   massMatrix_(Teuchos::null),
   V_(Teuchos::null), W_(Teuchos::null),
   useTranspose_(false), normInf_(-1.0), numIter_(0),
+  numSolves_(0), totalNumIter_(0),
   label_("HYMLS::BaseSolver"),
   lor_default_("Right")
   {
@@ -136,6 +139,30 @@ void BaseSolver::SetPrecond(Teuchos::RCP<Epetra_Operator> P)
     {
     // no preconditioning
     }
+
+  // With inner iterations the preconditioner changes in every
+  // iteration, which only flexible GMRES can handle
+  Teuchos::RCP<const Preconditioner> hymlsPrec =
+    Teuchos::rcp_dynamic_cast<const Preconditioner>(precond_);
+  if (hymlsPrec != Teuchos::null && hymlsPrec->IsVariable())
+    {
+    if (solverType_ == "GMRES" && lor == "Right")
+      {
+      Teuchos::ParameterList& belosList = PL().sublist("Iterative Solver");
+      belosList.set("Flexible Gmres", true);
+      if (belosSolverPtr_ != Teuchos::null)
+        {
+        Teuchos::RCP<Teuchos::ParameterList> belosListPtr = Teuchos::rcp(&belosList, false);
+        belosSolverPtr_->setParameters(belosListPtr);
+        }
+      }
+    else
+      {
+      Tools::Warning("The preconditioner uses \"Schur Complement Iterations\", "
+        "which requires GMRES with right preconditioning as outer solver",
+        __FILE__, __LINE__);
+      }
+    }
   }
 
 void BaseSolver::SetMassMatrix(Teuchos::RCP<const Epetra_RowMatrix> mass)
@@ -358,6 +385,12 @@ int BaseSolver::ApplyInverse(const Epetra_MultiVector& B,
   return ConvergenceStatus(B, X, ret);
   }
 
+void BaseSolver::AddToReport(PerformanceReport &report) const
+  {
+  report.Add(0, "Solve", "calls", numSolves_);
+  report.Add(0, "Solve", "iterations", totalNumIter_);
+  }
+
 int BaseSolver::ConvergenceStatus(const Epetra_MultiVector& B, const Epetra_MultiVector& X,
   const ::Belos::ReturnType &ret) const
   {
@@ -365,6 +398,9 @@ int BaseSolver::ConvergenceStatus(const Epetra_MultiVector& B, const Epetra_Mult
 
   int ierr = 0;
 
+  numSolves_++;
+  totalNumIter_ += numIter_;
+
   if (ret != ::Belos::Converged)
     {
     HYMLS::Tools::Warning("Belos returned " + ::Belos::convertReturnTypeToString(ret) + "!",
@@ -28,6 +28,8 @@ namespace Teuchos { class ParameterList; }
 
 namespace HYMLS {
 
+class PerformanceReport;
+
 /*! iterative solver class, basically         
    an Epetra wrapper for Belos extended with  
    some bordering and deflation functionality.
@@ -132,6 +134,9 @@ public:
   //! get number of iterations performed in last ApplyInverse() call
   inline int getNumIter() const {return numIter_;}
 
+  //! Add the number of solves and iterations to a report (level 0)
+  void AddToReport(PerformanceReport &report) const;
+
   //! For singular problems with a known null space, add the null space
   //! as a border so that in fact the linear system
   //!
@@ -213,6 +218,12 @@ protected:
   
   //! number of iterations performed in last ApplyInverse() call
   mutable int numIter_;
+
+  //! number of ApplyInverse() calls
+  mutable int numSolves_;
+
+  //! number of iterations summed over all ApplyInverse() calls
+  mutable int totalNumIter_;
   
   //! label
   std::string label_;
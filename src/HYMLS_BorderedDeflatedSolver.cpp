@@ -90,30 +90,13 @@ int BorderedDeflatedSolver::SetupDeflation()
   CHECK_ZERO(BorderedSolver::SetBorder(Teuchos::null, Teuchos::null));
   CHECK_ZERO(ifpack_precond->Compute());
 
-  precEigs_ = EigsPrec(numEigs_);
-  numEigs_ = precEigs_->numVecs;
-
-  if (numEigs_ == 0)
-    {
-    return 1;
-    }
-
-  if (precEigs_->Evecs == Teuchos::null)
+  bool keepBasis = false;
+  int ierr = ComputeDeflationVectors(keepBasis);
+  if (ierr)
     {
-    Tools::Error("no eigenvectors have been returned.", __FILE__, __LINE__);
+    return ierr;
     }
 
-  if (precEigs_->Espace == Teuchos::null)
-    {
-    Tools::Error("no eigenvector basis has been returned.", __FILE__, __LINE__);
-    }
-
-  // FIXME: This should always be orthogonal according to Anasazi documentation
-  // but it is not.
-  deflationVectors_ = precEigs_->Espace;
-  Teuchos::RCP<Anasazi::SVQBOrthoManager<double, Epetra_MultiVector, Epetra_Operator> > ortho = Teuchos::rcp(new Anasazi::SVQBOrthoManager<double, Epetra_MultiVector, Epetra_Operator>(massMatrix_));
-  ortho->normalize(*deflationVectors_);
-
   int n = deflationVectors_->NumVectors();
   deflationMatrix_ = Teuchos::rcp(new Epetra_SerialDenseMatrix(n, n));
 
@@ -130,10 +113,18 @@ int BorderedDeflatedSolver::SetupDeflation()
   CHECK_ZERO(BorderedSolver::SetBorder(deflationVectors_, massDeflationVectors_));
   CHECK_ZERO(ifpack_precond->Compute());
 
-  deflationRhs_ = Teuchos::rcp(new Epetra_MultiVector(*deflationVectors_));
+  // If the deflation vectors did not change, the old solution is a good
+  // starting vector for the solves with the new matrix
+  std::string startVec = startVec_;
+  if (keepBasis)
+    startVec_ = "Previous";
+  else
+    deflationRhs_ = Teuchos::rcp(new Epetra_MultiVector(*deflationVectors_));
+
   Epetra_MultiVector tmp(*deflationVectors_);
   CHECK_ZERO(DenseUtils::ApplyOrth(*deflationVectors_, AV, tmp, massDeflationVectors_));
   int ret = BorderedSolver::ApplyInverse(tmp, *deflationRhs_);
+  startVec_ = startVec;
 
   CHECK_ZERO(DenseUtils::MatMul(*deflationVectors_, AV, *deflationMatrix_));
 
@@ -8,14 +8,79 @@
 #include "Epetra_SerialDenseMatrix.h"
 #include "Epetra_MultiVector.h"
 #include "Epetra_LocalMap.h"
+#include "Epetra_BLAS.h"
 
 #include "BelosEpetraAdapter.hpp"
 
 #include <math.h>
+#include <algorithm>
 #include <vector>
 
 namespace HYMLS {
 
+namespace {
+
+// The local results of the distributed parts are combined in a single
+// reduction. Parts that are not distributed, like the border, have the
+// same values on every process and are added after the reduction.
+
+//! result[j] += A[j]^T * B[j] over the local rows
+void LocalDot(const Epetra_MultiVector &A, const Epetra_MultiVector &B,
+  double *result)
+  {
+  Epetra_BLAS blas;
+  for (int j = 0; j < A.NumVectors(); j++)
+    result[j] += blas.DOT(A.MyLength(), A[j], B[j]);
+  }
+
+//! result[j] += sum |A[j]| over the local rows
+void LocalAbsSum(const Epetra_MultiVector &A, double *result)
+  {
+  Epetra_BLAS blas;
+  for (int j = 0; j < A.NumVectors(); j++)
+    result[j] += blas.ASUM(A.MyLength(), A[j]);
+  }
+
+//! result[j] = max(result[j], max |A[j]|) over the local rows
+void LocalAbsMax(const Epetra_MultiVector &A, double *result)
+  {
+  for (int j = 0; j < A.NumVectors(); j++)
+    for (int i = 0; i < A.MyLength(); i++)
+      result[j] = std::max(result[j], fabs(A[j][i]));
+  }
+
+//! C(i,j) += A[i]^T * B[j] over the local rows, with C column major
+void LocalTransMultiply(const Epetra_MultiVector &A, const Epetra_MultiVector &B,
+  double *C)
+  {
+  Epetra_BLAS blas;
+  int m = A.NumVectors();
+  for (int j = 0; j < B.NumVectors(); j++)
+    for (int i = 0; i < m; i++)
+      C[i + j * m] += blas.DOT(A.MyLength(), A[i], B[j]);
+  }
+
+//! result = SumAll(distributed) + replicated
+int SumParts(const Epetra_Comm &comm, bool isDistributed,
+  std::vector<double> &distributed, std::vector<double> const &replicated,
+  double *result)
+  {
+  int n = replicated.size();
+  if (n == 0)
+    return 0;
+
+  int info = 0;
+  std::vector<double> sum(distributed);
+  if (isDistributed)
+    info = comm.SumAll(&distributed[0], &sum[0], n);
+
+  for (int i = 0; i < n; i++)
+    result[i] = sum[i] + replicated[i];
+  return info;
+  }
+
+  } // namespace
+
 BorderedVector::BorderedVector(const Epetra_BlockMap &map1, const Epetra_BlockMap &map2,
   int numVectors, bool zeroOut)
   {
@@ -238,6 +303,11 @@ bool BorderedVector::DistributedGlobal() const
   return first_->DistributedGlobal();
   }
 
+bool BorderedVector::IsDistributed() const
+  {
+  return first_->DistributedGlobal() || second_->DistributedGlobal();
+  }
+
 const Epetra_Comm& BorderedVector::Comm() const
   {
   return first_->Comm();
@@ -249,6 +319,41 @@ int BorderedVector::Multiply(char transA, char transB, double scalarAB,
   double scalarThis)
   {
   int info = 0;
+  if (transA == 'T' && transB == 'N')
+    {
+    // this = A^T * B, which has the same values on all processes.
+    // This is the inner product in the orthogonalization of the Krylov
+    // solvers, so we only do one reduction for both parts
+    int m = A.NumVectors();
+    int n = B.NumVectors();
+    if (first_->MyLength() != m || first_->NumVectors() != n ||
+      first_->DistributedGlobal())
+      return -1;
+
+    std::vector<double> distributed(m * n, 0.0);
+    std::vector<double> replicated(m * n, 0.0);
+    bool isDistributed = false;
+    for (int k = 0; k < 2; k++)
+      {
+      const Epetra_MultiVector &Ak = k == 0 ? *A.First() : *A.Second();
+      const Epetra_MultiVector &Bk = k == 0 ? *B.First() : *B.Second();
+      isDistributed = isDistributed || Ak.DistributedGlobal();
+      LocalTransMultiply(Ak, Bk, Ak.DistributedGlobal()
+        ? &distributed[0] : &replicated[0]);
+      }
+
+    std::vector<double> AB(m * n, 0.0);
+    info = SumParts(first_->Comm(), isDistributed, distributed, replicated, &AB[0]);
+
+    for (int j = 0; j < n; j++)
+      for (int i = 0; i < m; i++)
+        {
+        double &c = (*first_)[j][i];
+        c = (scalarThis == 0.0 ? 0.0 : scalarThis * c) + scalarAB * AB[i + j * m];
+        }
+    return info;
+    }
+
   if (transA == 'T')
     {
     info =  first_->Multiply(transA, transB, scalarAB, *A.First(), *B.First(), scalarThis);
@@ -284,18 +389,15 @@ int BorderedVector::Update(double scalarA, const BorderedVector &A,
 // b[j] := this[j]^T * A[j]
 int BorderedVector::Dot(const BorderedVector& A, std::vector<double> &b1) const
   {
-  // we need two arrays storing results
-  std::vector<double> b2 = b1;
-
-  int info = 0;
-  info += first_->Dot(*A.First(), &b1[0]);
-  info += second_->Dot(*A.Second(), &b2[0]);
+  std::vector<double> distributed(NumVectors(), 0.0);
+  std::vector<double> replicated(NumVectors(), 0.0);
 
-  // combine the results
-  for (int i = 0; i != NumVectors(); ++i)
-    b1[i] += b2[i];
+  LocalDot(*first_, *A.First(), first_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
+  LocalDot(*second_, *A.Second(), second_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
 
-  return info;
+  return SumParts(Comm(), IsDistributed(), distributed, replicated, &b1[0]);
   }
 
 // result[j] := this[j]^T * A[j]
@@ -318,17 +420,15 @@ int BorderedVector::Scale(double scalarValue)
 
 int BorderedVector::Norm1(std::vector<double> &result) const
   {
-  // copy result vector
-  std::vector<double> result_tmp = result;
+  std::vector<double> distributed(NumVectors(), 0.0);
+  std::vector<double> replicated(NumVectors(), 0.0);
 
-  int info = 0;
-  info =  first_->Norm1(&result[0]);
-  info += second_->Norm1(&result_tmp[0]);
+  LocalAbsSum(*first_, first_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
+  LocalAbsSum(*second_, second_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
 
-  // combine results
-  for (int i = 0; i != NumVectors(); ++i)
-    result[i] += result_tmp[i];
-  return info;
+  return SumParts(Comm(), IsDistributed(), distributed, replicated, &result[0]);
   }
 
 int BorderedVector::Norm2(double *result) const
@@ -342,31 +442,39 @@ int BorderedVector::Norm2(double *result) const
 
 int BorderedVector::Norm2(std::vector<double> &result) const
   {
-  // copy result vector
-  std::vector<double> result_tmp = result;
+  std::vector<double> distributed(NumVectors(), 0.0);
+  std::vector<double> replicated(NumVectors(), 0.0);
 
-  int info = 0;
-  info =  first_->Norm2(&result[0]);
-  info += second_->Norm2(&result_tmp[0]);
+  LocalDot(*first_, *first_, first_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
+  LocalDot(*second_, *second_, second_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
+
+  int info = SumParts(Comm(), IsDistributed(), distributed, replicated, &result[0]);
 
-  // combine results
   for (int i = 0; i != NumVectors(); ++i)
-    result[i] = sqrt(pow(result[i],2) + pow(result_tmp[i],2));
+    result[i] = sqrt(result[i]);
 
   return info;
   }
 
 int BorderedVector::NormInf(std::vector<double> &result) const
   {
-  std::vector<double> result_tmp = result;
+  std::vector<double> distributed(NumVectors(), 0.0);
+  std::vector<double> replicated(NumVectors(), 0.0);
+
+  LocalAbsMax(*first_, first_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
+  LocalAbsMax(*second_, second_->DistributedGlobal()
+    ? &distributed[0] : &replicated[0]);
 
   int info = 0;
-  info =  first_->NormInf(&result[0]);
-  info += second_->NormInf(&result_tmp[0]);
+  std::vector<double> max(distributed);
+  if (IsDistributed() && NumVectors() > 0)
+    info = Comm().MaxAll(&distributed[0], &max[0], NumVectors());
 
-  // combine results
   for (int i = 0; i != NumVectors(); ++i)
-    result[i] = std::max(result[i], result_tmp[i]);
+    result[i] = std::max(max[i], replicated[i]);
 
   return info;
   }
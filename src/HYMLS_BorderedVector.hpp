@@ -104,6 +104,14 @@ public:
 
   const Epetra_Comm& Comm() const;
 
+protected:
+
+  // True if one of the parts is distributed, in which case the inner
+  // products and norms need a reduction
+  bool IsDistributed() const;
+
+public:
+
   // this = alpha*A*B + scalarThis*this
   int Multiply(char transA, char transB, double scalarAB,
     const BorderedVector &A, const BorderedVector &B,
@@ -0,0 +1,145 @@
+#ifndef HYMLS_CACHE_IO_H
+#define HYMLS_CACHE_IO_H
+
+#include "HYMLS_config.h"
+
+#include "Teuchos_Array.hpp"
+
+#include "Epetra_Map.h"
+#include "Epetra_CrsMatrix.h"
+#include "Epetra_CrsGraph.h"
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace HYMLS {
+
+// Helper functions for the binary cache files of the partitioning
+// and the Schur complements. We only need plain values, strings and
+// arrays of plain values. The files are only meant to be read by the
+// same build on the same machine, so we do not care about endianness.
+
+template<typename T>
+void CacheWrite(std::ostream &os, T const &value)
+  {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+template<typename T>
+void CacheWrite(std::ostream &os, Teuchos::Array<T> const &array)
+  {
+  long long n = array.size();
+  CacheWrite(os, n);
+  if (n > 0)
+    os.write(reinterpret_cast<const char *>(array.getRawPtr()), n * sizeof(T));
+  }
+
+inline void CacheWrite(std::ostream &os, std::string const &str)
+  {
+  CacheWrite(os, Teuchos::Array<char>(str.begin(), str.end()));
+  }
+
+template<typename T>
+bool CacheRead(std::istream &is, T &value)
+  {
+  is.read(reinterpret_cast<char *>(&value), sizeof(T));
+  return is.good();
+  }
+
+template<typename T>
+bool CacheRead(std::istream &is, Teuchos::Array<T> &array)
+  {
+  long long n;
+  if (!CacheRead(is, n) || n < 0)
+    return false;
+  array.resize(n);
+  if (n > 0)
+    is.read(reinterpret_cast<char *>(array.getRawPtr()), n * sizeof(T));
+  return is.good();
+  }
+
+inline bool CacheRead(std::istream &is, std::string &str)
+  {
+  Teuchos::Array<char> array;
+  if (!CacheRead(is, array))
+    return false;
+  str.assign(array.begin(), array.end());
+  return true;
+  }
+
+//! initial value of CacheHash()
+const unsigned long long cacheHashInit = 14695981039346656037ULL;
+
+// FNV-1a hash
+inline unsigned long long CacheHash(unsigned long long hash, const void *data, size_t len)
+  {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < len; i++)
+    {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+    }
+  return hash;
+  }
+
+//! hash of the local rows of a matrix (global indices and values)
+inline unsigned long long CacheHash(unsigned long long hash, Epetra_CrsMatrix const &A)
+  {
+  int len;
+  int *indices;
+  double *values;
+  Teuchos::Array<hymls_gidx> gids;
+  for (int i = 0; i < A.NumMyRows(); i++)
+    {
+    hymls_gidx row = A.GRID64(i);
+    hash = CacheHash(hash, &row, sizeof(hymls_gidx));
+
+    A.ExtractMyRowView(i, len, values, indices);
+    gids.resize(len);
+    for (int j = 0; j < len; j++)
+      gids[j] = A.GCID64(indices[j]);
+    if (len > 0)
+      {
+      hash = CacheHash(hash, gids.getRawPtr(), len * sizeof(hymls_gidx));
+      hash = CacheHash(hash, values, len * sizeof(double));
+      }
+    }
+  return hash;
+  }
+
+//! hash of the local rows of a graph (global row and column indices)
+inline unsigned long long CacheHash(unsigned long long hash, Epetra_CrsGraph const &G)
+  {
+  int len;
+  int *indices;
+  Teuchos::Array<hymls_gidx> gids;
+  for (int i = 0; i < G.NumMyRows(); i++)
+    {
+    hymls_gidx row = G.GRID64(i);
+    hash = CacheHash(hash, &row, sizeof(hymls_gidx));
+
+    G.ExtractMyRowView(i, len, indices);
+    hash = CacheHash(hash, &len, sizeof(int));
+    gids.resize(len);
+    for (int j = 0; j < len; j++)
+      gids[j] = G.GCID64(indices[j]);
+    if (len > 0)
+      hash = CacheHash(hash, gids.getRawPtr(), len * sizeof(hymls_gidx));
+    }
+  return hash;
+  }
+
+//! global indices of the local elements of a map
+inline Teuchos::Array<hymls_gidx> MyGIDs(Epetra_Map const &map)
+  {
+  Teuchos::Array<hymls_gidx> gids(map.NumMyElements());
+  for (int lid = 0; lid < map.NumMyElements(); lid++)
+    gids[lid] = map.GID64(lid);
+  return gids;
+  }
+
+  }
+
+#endif
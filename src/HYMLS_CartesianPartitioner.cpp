@@ -178,7 +178,9 @@ int CartesianPartitioner::Partition(bool repart)
 
   CHECK_ZERO(CreatePIDMap());
 
-  if (nprocs_ != comm_->NumProc())
+  // with weights the processor partitioning differs from the
+  // one of the input map
+  if (nprocs_ != comm_->NumProc() || weights_ != Teuchos::null)
     repart = true;
 
   CHECK_ZERO(CreateSubdomainMap());
@@ -7,6 +7,7 @@
 #include "HYMLS_Macros.hpp"
 #include "HYMLS_Tools.hpp"
 #include "HYMLS_MatrixUtils.hpp"
+#include "HYMLS_DenseUtils.hpp"
 
 #include "Epetra_Comm.h"
 #include "Epetra_Map.h"
@@ -14,6 +15,7 @@
 #include "Epetra_Import.h"
 #include "Epetra_MultiVector.h"
 #include "Epetra_SerialDenseMatrix.h"
+#include "Epetra_SerialDenseSolver.h"
 #include "Epetra_CrsMatrix.h"
 #include "Epetra_MpiComm.h"
 #include "Epetra_Operator.h"
@@ -53,7 +55,8 @@ CoarseSolver::CoarseSolver(
   haveBorder_(false),
   label_("CoarseSolver"),
   isEmpty_(false),
-  initialized_(false), computed_(false)
+  initialized_(false), computed_(false),
+  lowRankBorder_(false)
   {
   }
 
@@ -95,6 +98,8 @@ int CoarseSolver::SetParameters(Teuchos::ParameterList& List)
 
   HYMLS_DEBVAR(fix_gid_);
 
+  lowRankBorder_ = getMyNonconstParamList()->get("Low-Rank Border Update", lowRankBorder_);
+
   return 0;
   }
 
@@ -197,7 +202,7 @@ int CoarseSolver::Compute()
   ////////////////////////////////////////////////////////////////////////////
   // this next section is just for the bordered case                        //
   ////////////////////////////////////////////////////////////////////////////
-  if (HaveBorder() && amActive_)
+  if (HaveBorder() && amActive_ && !lowRankBorder_)
     {
     if (V_ == Teuchos::null || W_ == Teuchos::null || C_ == Teuchos::null)
       {
@@ -244,6 +249,42 @@ int CoarseSolver::Compute()
 
   computed_ = true;
 
+  if (HaveBorder() && lowRankBorder_)
+    {
+    CHECK_ZERO(ComputeCapacitance());
+    }
+
+  return 0;
+  }
+
+// For the low-rank border update we use that
+// [K V; W' C] \ [X; T] = [Y - Q S; S], with Y = K\X, Q = K\V and
+// S = (C - W'Q) \ (T - W'Y), so only the m x m capacitance matrix
+// C - W'Q has to be factored when the border changes.
+int CoarseSolver::ComputeCapacitance()
+  {
+  HYMLS_LPROF2(label_, "ComputeCapacitance");
+
+  if (V_ == Teuchos::null || W_ == Teuchos::null || C_ == Teuchos::null)
+    {
+    Tools::Error("border not set correctly", __FILE__, __LINE__);
+    }
+
+  int m = V_->NumVectors();
+  borderQ_ = Teuchos::rcp(new Epetra_MultiVector(V_->Map(), m));
+  if (!isEmpty_)
+    {
+    CHECK_ZERO(ApplyInverse(*V_, *borderQ_));
+    }
+
+  capacitance_ = Teuchos::rcp(new Epetra_SerialDenseMatrix(*C_));
+  CHECK_ZERO(DenseUtils::MatMul(-1.0, *W_, *borderQ_, 1.0, *capacitance_));
+
+  capacitanceSolver_ = Teuchos::rcp(new Epetra_SerialDenseSolver());
+  CHECK_ZERO(capacitanceSolver_->SetMatrix(*capacitance_));
+  capacitanceSolver_->FactorWithEquilibration(true);
+  CHECK_ZERO(capacitanceSolver_->Factor());
+
   return 0;
   }
 
@@ -329,46 +370,64 @@ const Epetra_RowMatrix& CoarseSolver::Matrix() const
 
 int CoarseSolver::NumInitialize() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0;
   return reducedSchurSolver_->NumInitialize();
   }
 
 int CoarseSolver::NumCompute() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0;
   return reducedSchurSolver_->NumCompute();
   }
 
 int CoarseSolver::NumApplyInverse() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0;
   return reducedSchurSolver_->NumApplyInverse();
   }
 
 double CoarseSolver::InitializeTime() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0.0;
   return reducedSchurSolver_->InitializeTime();
   }
 
 double CoarseSolver::ComputeTime() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0.0;
   return reducedSchurSolver_->ComputeTime();
   }
 
 double CoarseSolver::ApplyInverseTime() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0.0;
   return reducedSchurSolver_->ApplyInverseTime();
   }
 
 double CoarseSolver::InitializeFlops() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0.0;
   return reducedSchurSolver_->InitializeFlops();
   }
 
 double CoarseSolver::ComputeFlops() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0.0;
   return reducedSchurSolver_->ComputeFlops();
   }
 
 double CoarseSolver::ApplyInverseFlops() const
   {
+  if (reducedSchurSolver_ == Teuchos::null)
+    return 0.0;
   return reducedSchurSolver_->ApplyInverseFlops();
   }
 
@@ -439,8 +498,15 @@ int CoarseSolver::SetBorder(Teuchos::RCP<const Epetra_MultiVector> V,
   W_ = W;
   C_ = C;
 
-  computed_ = false;
   haveBorder_ = true;
+
+  // keep the factorization and only update the capacitance matrix
+  if (lowRankBorder_ && IsComputed())
+    {
+    return ComputeCapacitance();
+    }
+
+  computed_ = false;
   return 0;
   }
 
@@ -469,6 +535,28 @@ int CoarseSolver::ApplyInverse(const Epetra_MultiVector &X,
     return ApplyInverse(X, Y);
     }
 
+  if (lowRankBorder_)
+    {
+    // Y = K\X, S = (C - W'Q)\(T - W'Y), Y = Y - Q S
+    if (isEmpty_)
+      {
+      CHECK_ZERO(Y.PutScalar(0.0));
+      }
+    else
+      {
+      CHECK_ZERO(ApplyInverse(X, Y));
+      }
+
+    Epetra_SerialDenseMatrix rhs(T);
+    CHECK_ZERO(DenseUtils::MatMul(-1.0, *W_, Y, 1.0, rhs));
+    CHECK_ZERO(capacitanceSolver_->SetVectors(S, rhs));
+    CHECK_ZERO(capacitanceSolver_->Solve());
+
+    Teuchos::RCP<const Epetra_MultiVector> Sview = DenseUtils::CreateView(S);
+    CHECK_ZERO(Y.Multiply('N', 'N', -1.0, *borderQ_, *Sview, 1.0));
+    return 0;
+    }
+
   Epetra_SerialDenseMatrix S_local(S.M(), S.N());
   CHECK_ZERO(Y.PutScalar(0.0));
   if (amActive_ && !isEmpty_)
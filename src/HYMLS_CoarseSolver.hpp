@@ -20,6 +20,7 @@ class Epetra_Map;
 class Epetra_RowMatrix;
 class Epetra_CrsMatrix;
 class Epetra_SerialDensematrix;
+class Epetra_SerialDenseSolver;
 class Epetra_MultiVector;
 class Epetra_Vector;
 
@@ -257,6 +258,21 @@ protected:
   //! augmented matrix for V-sums, [M22 V2; W2 C]
   Teuchos::RCP<Epetra_RowMatrix> augmentedMatrix_;
 
+  //! if true, the matrix is factored without the border and the
+  //! border is handled with the Sherman-Morrison-Woodbury formula, so
+  //! that changing the border does not require a new factorization
+  bool lowRankBorder_;
+
+  //! K\V for the low-rank border update
+  Teuchos::RCP<Epetra_MultiVector> borderQ_;
+
+  //! the capacitance matrix C-W'K\V and its factorization
+  Teuchos::RCP<Epetra_SerialDenseMatrix> capacitance_;
+  Teuchos::RCP<Epetra_SerialDenseSolver> capacitanceSolver_;
+
+  //! compute borderQ_ and factor the capacitance matrix
+  int ComputeCapacitance();
+
   };
 
   }
@@ -24,7 +24,9 @@
 #include "AnasaziEpetraAdapter.hpp"
 #include "AnasaziSVQBOrthoManager.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 namespace HYMLS {
 
@@ -37,6 +39,8 @@ DeflatedSolver::DeflatedSolver(Teuchos::RCP<const Epetra_Operator> K,
   BaseSolver(K, P, params, validate),
   label_("HYMLS::DeflatedSolver"),
   numEigs_(0),
+  deflationRefinementSteps_(0),
+  deflationUpdateTol_(0.0),
   deflationComputed_(false)
   {
   HYMLS_PROF3(label_, "Constructor");
@@ -64,6 +68,9 @@ void DeflatedSolver::setParameterList(const Teuchos::RCP<Teuchos::ParameterList>
 
   numEigs_ = PL().get("Deflated Subspace Dimension", numEigs_);
   deflThres_ = PL().get("Deflation Threshold", 0.0);
+  deflationRefinementSteps_ = PL().get("Deflation Refinement Steps",
+    deflationRefinementSteps_);
+  deflationUpdateTol_ = PL().get("Deflation Update Tolerance", deflationUpdateTol_);
 
   BaseSolver::setParameterList(params, validateParameters);
   }
@@ -81,6 +88,15 @@ Teuchos::RCP<const Teuchos::ParameterList> DeflatedSolver::getValidParameters()
   VPL().set("Deflation Threshold", 1.0e-3,
     "An eigenmode is deflated if the eigenvalue is within [-eps 0]");
 
+  VPL().set("Deflation Update Tolerance", 0.0,
+    "When the deflation is set up again, the old deflation vectors are kept "
+    "if they still span an invariant subspace of the preconditioner up to this "
+    "relative residual. If 0, the eigenvalue problem is always solved again.");
+
+  VPL().set("Deflation Refinement Steps", 0,
+    "Maximum number of subspace iteration steps to refine the old deflation "
+    "vectors before the eigenvalue problem is solved again");
+
   return validParams_;
   }
 
@@ -89,30 +105,13 @@ int DeflatedSolver::SetupDeflation()
   if (numEigs_ <= 0)
     return -1;
 
-  precEigs_ = EigsPrec(numEigs_);
-  numEigs_ = precEigs_->numVecs;
-
-  if (numEigs_ == 0)
-    {
-    return 1;
-    }
-
-  if (precEigs_->Evecs == Teuchos::null)
+  bool keepBasis = false;
+  int ierr = ComputeDeflationVectors(keepBasis);
+  if (ierr)
     {
-    Tools::Error("no eigenvectors have been returned.", __FILE__, __LINE__);
+    return ierr;
     }
 
-  if (precEigs_->Espace == Teuchos::null)
-    {
-    Tools::Error("no eigenvector basis has been returned.", __FILE__, __LINE__);
-    }
-
-  // FIXME: This should always be orthogonal according to Anasazi documentation
-  // but it is not.
-  deflationVectors_ = precEigs_->Espace;
-  Teuchos::RCP<Anasazi::SVQBOrthoManager<double, Epetra_MultiVector, Epetra_Operator> > ortho = Teuchos::rcp(new Anasazi::SVQBOrthoManager<double, Epetra_MultiVector, Epetra_Operator>(massMatrix_));
-  ortho->normalize(*deflationVectors_);
-
   int n = deflationVectors_->NumVectors();
   deflationMatrix_ = Teuchos::rcp(new Epetra_SerialDenseMatrix(n, n));
 
@@ -128,10 +127,18 @@ int DeflatedSolver::SetupDeflation()
   CHECK_ZERO(BaseSolver::ApplyMatrix(*deflationVectors_, AV));
   CHECK_ZERO(BaseSolver::setProjectionVectors(deflationVectors_, massDeflationVectors_));
 
-  deflationRhs_ = Teuchos::rcp(new Epetra_MultiVector(*deflationVectors_));
+  // If the deflation vectors did not change, the old solution is a good
+  // starting vector for the solves with the new matrix
+  std::string startVec = startVec_;
+  if (keepBasis)
+    startVec_ = "Previous";
+  else
+    deflationRhs_ = Teuchos::rcp(new Epetra_MultiVector(*deflationVectors_));
+
   Epetra_MultiVector tmp(*deflationVectors_);
   CHECK_ZERO(DenseUtils::ApplyOrth(*deflationVectors_, AV, tmp, massDeflationVectors_));
   int ret = BaseSolver::ApplyInverse(tmp, *deflationRhs_);
+  startVec_ = startVec;
 
   CHECK_ZERO(DenseUtils::MatMul(*deflationVectors_, AV, *deflationMatrix_));
 
@@ -156,6 +163,115 @@ int DeflatedSolver::SetupDeflation()
   return ret;
   }
 
+int DeflatedSolver::ComputeDeflationVectors(bool &keepBasis)
+  {
+  HYMLS_PROF(label_, "ComputeDeflationVectors");
+
+  keepBasis = false;
+
+  Teuchos::RCP<Anasazi::SVQBOrthoManager<double, Epetra_MultiVector, Epetra_Operator> > ortho = Teuchos::rcp(new Anasazi::SVQBOrthoManager<double, Epetra_MultiVector, Epetra_Operator>(massMatrix_));
+
+  Teuchos::RCP<Epetra_MultiVector> V = Teuchos::null;
+  if (deflationComputed_ && !deflationVectors_.is_null())
+    {
+    V = Teuchos::rcp(new Epetra_MultiVector(*deflationVectors_));
+    }
+
+  // Across Newton or continuation steps the near null space of the
+  // preconditioner hardly changes, so we first check if the old deflation
+  // vectors are still good enough, and otherwise try to improve them with
+  // a few steps of subspace iteration before solving the eigenvalue problem.
+  if (!V.is_null() && deflationUpdateTol_ > 0.0)
+    {
+    Teuchos::RCP<Epetra_Operator> op = PrecOperator();
+    Epetra_MultiVector W(*V);
+    for (int step = 0; step <= deflationRefinementSteps_; step++)
+      {
+      double residual = InvariantSubspaceResidual(*op, *V, W);
+      Tools::Out("Deflation subspace residual after " + Teuchos::toString(step)
+        + " refinement steps: " + Teuchos::toString(residual));
+
+      if (residual < deflationUpdateTol_)
+        {
+        keepBasis = (step == 0);
+        if (!keepBasis)
+          {
+          deflationVectors_ = V;
+          }
+        return 0;
+        }
+
+      if (step < deflationRefinementSteps_)
+        {
+        *V = W;
+        ortho->normalize(*V);
+        }
+      }
+    }
+
+  precEigs_ = EigsPrec(numEigs_, V);
+  numEigs_ = precEigs_->numVecs;
+
+  if (numEigs_ == 0)
+    {
+    return 1;
+    }
+
+  if (precEigs_->Evecs == Teuchos::null)
+    {
+    Tools::Error("no eigenvectors have been returned.", __FILE__, __LINE__);
+    }
+
+  if (precEigs_->Espace == Teuchos::null)
+    {
+    Tools::Error("no eigenvector basis has been returned.", __FILE__, __LINE__);
+    }
+
+  // FIXME: This should always be orthogonal according to Anasazi documentation
+  // but it is not.
+  deflationVectors_ = precEigs_->Espace;
+  ortho->normalize(*deflationVectors_);
+
+  return 0;
+  }
+
+double DeflatedSolver::InvariantSubspaceResidual(Epetra_Operator const &op,
+  Epetra_MultiVector const &V, Epetra_MultiVector &W) const
+  {
+  HYMLS_PROF3(label_, "InvariantSubspaceResidual");
+
+  CHECK_ZERO(op.Apply(V, W));
+
+  Epetra_MultiVector MV(V);
+  if (massMatrix_ != Teuchos::null)
+    {
+    CHECK_ZERO(massMatrix_->Apply(V, MV));
+    }
+
+  // R = W - V*V'*M*W
+  Epetra_SerialDenseMatrix H;
+  CHECK_ZERO(DenseUtils::MatMul(MV, W, H));
+
+  Epetra_SerialComm comm;
+  Epetra_LocalMap map(H.M(), 0, comm);
+  Epetra_MultiVector Hmv(View, map, H.A(), H.LDA(), H.N());
+
+  Epetra_MultiVector R(W);
+  CHECK_ZERO(R.Multiply('N', 'N', -1.0, V, Hmv, 1.0));
+
+  int n = V.NumVectors();
+  std::vector<double> normR(n), normW(n);
+  CHECK_ZERO(R.Norm2(&normR[0]));
+  CHECK_ZERO(W.Norm2(&normW[0]));
+
+  double residual = 0.0;
+  for (int j = 0; j < n; j++)
+    {
+    residual = std::max(residual, normW[j] > 0.0 ? normR[j] / normW[j] : normR[j]);
+    }
+  return residual;
+  }
+
 int DeflatedSolver::ApplyInverse(const Epetra_MultiVector& X,
   Epetra_MultiVector& Y) const
   {
@@ -244,15 +360,9 @@ int DeflatedSolver::ApplyInverse(const Epetra_MultiVector& X,
   return ret;
   }
 
-Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > DeflatedSolver::EigsPrec(int numEigs) const
+Teuchos::RCP<Epetra_Operator> DeflatedSolver::PrecOperator() const
   {
-  // If there is a null-space, deflate it.
-  // If no NS and no additional vectors asked for -
-  // nothing to be done.
-  HYMLS_PROF(label_, "EigsPrec");
-
   Teuchos::RCP<Epetra_Operator> op, iop;
-  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > precEigs = Teuchos::null;
   Teuchos::RCP<const Epetra_Operator> op_array[2];
 
   op = precond_;
@@ -283,6 +393,19 @@ Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > DeflatedSolver
     iop = Teuchos::rcp(new Epetra_InvOperator(op.get()));
     deflationWithMassMatrix_ = false;
     }
+  return iop;
+  }
+
+Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > DeflatedSolver::EigsPrec(int numEigs,
+  Teuchos::RCP<const Epetra_MultiVector> initVec) const
+  {
+  // If there is a null-space, deflate it.
+  // If no NS and no additional vectors asked for -
+  // nothing to be done.
+  HYMLS_PROF(label_, "EigsPrec");
+
+  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > precEigs = Teuchos::null;
+  Teuchos::RCP<Epetra_Operator> iop = PrecOperator();
 
   ////////////////////////////////////////////////////
   // compute dominant eigenvalues of (P^{-1}, M).
@@ -290,7 +413,7 @@ Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > DeflatedSolver
   bool status = true;
   try {
     Tools::Out("Compute max eigs of inv(P)");
-    precEigs = MatrixUtils::Eigs(iop, Teuchos::null, numEigs, 1.0e-8);
+    precEigs = MatrixUtils::Eigs(iop, Teuchos::null, numEigs, 1.0e-8, initVec);
     } TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, status);
   if (!status) Tools::Fatal("caught an exception", __FILE__, __LINE__);
 
@@ -62,13 +62,33 @@ public:
   //! See SetupDeflation in the base solver. Maybe this one works
   virtual int SetupDeflation();
 
-  //! computes dominant eigenpairs of inv(P)
-  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > EigsPrec(int numEigs) const;
+  //! computes dominant eigenpairs of inv(P). If initVec is given, it
+  //! is used to start the eigensolver.
+  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > EigsPrec(int numEigs,
+    Teuchos::RCP<const Epetra_MultiVector> initVec = Teuchos::null) const;
 
   //! use same preconditioner but operator (I-VV')A
   virtual int setProjectionVectors(Teuchos::RCP<const Epetra_MultiVector> V,
     Teuchos::RCP<const Epetra_MultiVector> W = Teuchos::null);
 
+protected:
+
+  //! computes the normalized deflation vectors. If they were computed
+  //! before and still span an invariant subspace of inv(P) up to the
+  //! "Deflation Update Tolerance", possibly after a few steps of
+  //! subspace iteration, the eigensolver is not called. keepBasis is
+  //! set to true if the previous deflation vectors are kept as they
+  //! are. Returns 1 if no deflation vectors were found.
+  int ComputeDeflationVectors(bool &keepBasis);
+
+  //! operator inv(P)*M of which the dominant eigenvectors are computed
+  Teuchos::RCP<Epetra_Operator> PrecOperator() const;
+
+  //! computes W = op*V and returns max_j ||W_j - V*H_j|| / ||W_j||
+  //! with H = V'*M*W, which is zero if V spans an invariant subspace
+  double InvariantSubspaceResidual(Epetra_Operator const &op,
+    Epetra_MultiVector const &V, Epetra_MultiVector &W) const;
+
 private:
 
   //! label
@@ -86,6 +106,14 @@ protected:
   //! "Deflation Threshold" in the "Solver" sublist).     
   double deflThres_;
 
+  //! maximum number of subspace iteration steps with the old deflation
+  //! vectors before the eigensolver is called ("Deflation Refinement Steps")
+  int deflationRefinementSteps_;
+
+  //! relative residual below which the old deflation vectors are reused
+  //! ("Deflation Update Tolerance"). If 0, they are always recomputed.
+  double deflationUpdateTol_;
+
   //! tells if deflation vectors were already computed
   bool deflationComputed_;
 
@@ -0,0 +1,624 @@
+#include "HYMLS_GraphPartitioner.hpp"
+
+#include "HYMLS_config.h"
+
+#include "HYMLS_Tools.hpp"
+#include "HYMLS_Macros.hpp"
+#include "HYMLS_InteriorGroup.hpp"
+#include "HYMLS_SeparatorGroup.hpp"
+
+#include "Epetra_Comm.h"
+#include "Epetra_Map.h"
+#include "Epetra_CrsGraph.h"
+#include "Epetra_FECrsGraph.h"
+#include "Epetra_Import.h"
+#include "Epetra_IntVector.h"
+#include "Epetra_MultiVector.h"
+#include "Epetra_Vector.h"
+
+#include "Teuchos_Array.hpp"
+#include "Teuchos_toString.hpp"
+#include "Teuchos_ParameterList.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+using Teuchos::toString;
+
+namespace HYMLS {
+
+// constructor
+GraphPartitioner::GraphPartitioner(
+  Teuchos::RCP<const Epetra_Map> map,
+  Teuchos::RCP<const Epetra_CrsGraph> graph,
+  Teuchos::RCP<Teuchos::ParameterList> const &params,
+  Epetra_Comm const &comm, int level)
+  : BasePartitioner(comm, level), label_("GraphPartitioner"),
+    baseMap_(map), graph_(graph), sdMap_(Teuchos::null),
+    numLocalSubdomains_(-1), numGlobalSubdomains_(-1)
+  {
+  HYMLS_PROF3(label_, "Constructor");
+
+  SetParameters(*params);
+  }
+
+// destructor
+GraphPartitioner::~GraphPartitioner()
+  {
+  HYMLS_PROF3(label_,"Destructor");
+  }
+
+void GraphPartitioner::SetParameters(Teuchos::ParameterList& params)
+  {
+  BasePartitioner::SetParameters(params);
+
+  Teuchos::ParameterList& precList = params.sublist("Preconditioner");
+
+  // Without nz the base class assumes that there is only one
+  // layer of nodes in the z-direction
+  if (dim_ > 2 && nz_ <= 1)
+    {
+    if (!precList.isParameter("Separator Length (z)"))
+      sz_ = precList.get("Separator Length", sx_);
+    if (!precList.isParameter("Coarsening Factor (z)"))
+      cz_ = precList.get("Coarsening Factor", cx_);
+    }
+
+  if (precList.isParameter("Number of Subdomains"))
+    numGlobalSubdomains_ = precList.get("Number of Subdomains", -1);
+  }
+
+void GraphPartitioner::SetNextLevelParameters(Teuchos::ParameterList& params) const
+  {
+  BasePartitioner::SetNextLevelParameters(params);
+
+  // The next level has a lot less nodes, so we can't use the
+  // separator length there. Instead we merge cx*cy*cz subdomains.
+  int factor = cx_ * cy_ * (dim_ > 2 ? cz_ : 1);
+  int numGlobalSubdomains = (sdMap_->NumGlobalElements() + factor - 1) / factor;
+
+  params.sublist("Preconditioner").set("Number of Subdomains",
+    std::max(numGlobalSubdomains, 1));
+  }
+
+// get non-overlapping subdomain id
+int GraphPartitioner::operator()(hymls_gidx gid) const
+  {
+#ifdef HYMLS_TESTING
+  if (!Partitioned())
+    {
+    Tools::Error("Partition() not yet called!", __FILE__, __LINE__);
+    }
+#endif
+  int lid = baseMap_->LID(gid);
+  if (lid < 0)
+    Tools::Error("gid " + toString(gid) + " is not owned by this processor",
+      __FILE__, __LINE__);
+  return partition_[lid];
+  }
+
+int GraphPartitioner::GetSubdomainPosition(
+  int sd, int sx, int sy, int sz, int &x, int &y, int &z) const
+  {
+  Tools::Error("Subdomains of a graph partitioning have no position",
+    __FILE__, __LINE__);
+  return -1;
+  }
+
+int GraphPartitioner::GetSubdomainID(
+  int sx, int sy, int sz, int x, int y, int z) const
+  {
+  Tools::Error("Subdomains of a graph partitioning have no position",
+    __FILE__, __LINE__);
+  return -1;
+  }
+
+int GraphPartitioner::PID(hymls_gidx gid) const
+  {
+  return baseMap_->MyGID(gid) ? comm_->MyPID() : -1;
+  }
+
+//! return the number of subdomains in this proc partition
+int GraphPartitioner::NumLocalParts() const
+  {
+  if (numLocalSubdomains_ < 0)
+    {
+    Tools::Error("Partition() not yet called!", __FILE__, __LINE__);
+    }
+  return numLocalSubdomains_;
+  }
+
+//! return the global number of subdomains
+int GraphPartitioner::NumGlobalParts(int sx, int sy, int sz) const
+  {
+  if (!Partitioned())
+    {
+    Tools::Error("Partition() not yet called!", __FILE__, __LINE__);
+    }
+  return sdMap_->NumGlobalElements();
+  }
+
+bool GraphPartitioner::IsInteriorVariable(hymls_gidx gid) const
+  {
+  VariableType type = variableType_[(int)(gid % dof_)];
+  return type == VariableType::Pressure || type == VariableType::Interior;
+  }
+
+// Order the nodes of the current set breadth first, starting from start.
+// Nodes that are not connected to start are appended in the same way.
+// The last node in the ordering is far away from the start node.
+static void LevelStructure(int start, Teuchos::Array<int> const &nodes,
+  int set, Teuchos::Array<int> const &member,
+  Teuchos::Array<Teuchos::Array<int> > const &adj,
+  Teuchos::Array<int> &visited, int &stamp,
+  Teuchos::Array<int> &order)
+  {
+  stamp++;
+  order.clear();
+
+  int next = 0;
+  int node = start;
+  while (order.size() < nodes.size())
+    {
+    if (visited[node] != stamp)
+      {
+      visited[node] = stamp;
+      order.append(node);
+      for (int pos = order.size() - 1; pos < order.size(); pos++)
+        {
+        for (int neighbor: adj[order[pos]])
+          {
+          if (member[neighbor] == set && visited[neighbor] != stamp)
+            {
+            visited[neighbor] = stamp;
+            order.append(neighbor);
+            }
+          }
+        }
+      }
+
+    // start a new connected component
+    while (next < nodes.size() && visited[nodes[next]] == stamp)
+      next++;
+    if (next < nodes.size())
+      node = nodes[next];
+    }
+  }
+
+// Recursively bisect the nodes into nparts parts of approximately
+// equal weight. Parts are numbered from firstPart.
+static void Bisect(Teuchos::Array<int> const &nodes, int nparts, int firstPart,
+  Teuchos::Array<double> const &weight,
+  Teuchos::Array<Teuchos::Array<int> > const &adj,
+  Teuchos::Array<int> &member, int &numSets,
+  Teuchos::Array<int> &visited, int &stamp,
+  Teuchos::Array<int> &nodePart)
+  {
+  if (nparts <= 1 || nodes.size() <= 1)
+    {
+    for (int node: nodes)
+      nodePart[node] = firstPart;
+    return;
+    }
+
+  int set = ++numSets;
+  double totalWeight = 0.0;
+  for (int node: nodes)
+    {
+    member[node] = set;
+    totalWeight += weight[node];
+    }
+
+  // Grow the first part from a pseudo-peripheral node
+  Teuchos::Array<int> order;
+  LevelStructure(nodes[0], nodes, set, member, adj, visited, stamp, order);
+  LevelStructure(order.back(), nodes, set, member, adj, visited, stamp, order);
+
+  int nleft = nparts / 2;
+  int nright = nparts - nleft;
+  double targetWeight = totalWeight * nleft / nparts;
+
+  int split = 0;
+  double weightLeft = 0.0;
+  while ((weightLeft < targetWeight || split < nleft) &&
+    order.size() - split > nright)
+    {
+    weightLeft += weight[order[split]];
+    split++;
+    }
+
+  Teuchos::Array<int> left;
+  Teuchos::Array<int> right;
+  left.assign(order.begin(), order.begin() + split);
+  right.assign(order.begin() + split, order.end());
+  order.clear();
+
+  Bisect(left, nleft, firstPart, weight, adj,
+    member, numSets, visited, stamp, nodePart);
+  Bisect(right, nright, firstPart + nleft, weight, adj,
+    member, numSets, visited, stamp, nodePart);
+  }
+
+int GraphPartitioner::CreateLocalParts(Teuchos::Array<int> &rowNode,
+  Teuchos::Array<int> &nodePart)
+  {
+  HYMLS_PROF3(label_, "CreateLocalParts");
+
+  Epetra_BlockMap const &rowMap = graph_->RowMap();
+  Epetra_BlockMap const &colMap = graph_->ColMap();
+  int numMyRows = rowMap.NumMyElements();
+
+  // All variables in a grid cell are put in the same node
+  std::map<hymls_gidx, int> nodeIDs;
+  rowNode.resize(numMyRows);
+  for (int lid = 0; lid < numMyRows; lid++)
+    {
+    hymls_gidx cell = rowMap.GID64(lid) / dof_;
+    auto it = nodeIDs.find(cell);
+    if (it == nodeIDs.end())
+      it = nodeIDs.insert(std::make_pair(cell, (int)nodeIDs.size())).first;
+    rowNode[lid] = it->second;
+    }
+  int numNodes = nodeIDs.size();
+
+  // The weight of a node is the sum of the weights of its rows that
+  // were set with SetWeights(), or its number of nonzeros otherwise.
+  // Nodes that only have a diagonal entry are inactive.
+  Teuchos::RCP<const Epetra_Vector> rowWeights = weights_;
+  if (weights_ != Teuchos::null && !weights_->Map().SameAs(rowMap))
+    {
+    Teuchos::RCP<Epetra_Vector> importedWeights =
+      Teuchos::rcp(new Epetra_Vector(rowMap));
+    Epetra_Import import(rowMap, weights_->Map());
+    CHECK_ZERO(importedWeights->Import(*weights_, import, Insert));
+    rowWeights = importedWeights;
+    }
+
+  Teuchos::Array<double> weight(numNodes, 0.0);
+  Teuchos::Array<int> active(numNodes, 0);
+  Teuchos::Array<Teuchos::Array<int> > adj(numNodes);
+  for (int lid = 0; lid < numMyRows; lid++)
+    {
+    int node = rowNode[lid];
+    int len;
+    int *indices;
+    CHECK_ZERO(graph_->ExtractMyRowView(lid, len, indices));
+    weight[node] += rowWeights != Teuchos::null ? (*rowWeights)[lid] : len;
+    if (len > 1)
+      active[node] = 1;
+    for (int j = 0; j < len; j++)
+      {
+      int lid2 = rowMap.LID(colMap.GID64(indices[j]));
+      if (lid2 < 0 || rowNode[lid2] == node)
+        continue;
+      adj[node].append(rowNode[lid2]);
+      adj[rowNode[lid2]].append(node);
+      }
+    }
+
+  for (auto &neighbors: adj)
+    {
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+  double myWeight = 0.0;
+  int numActive = 0;
+  for (int node = 0; node < numNodes; node++)
+    {
+    myWeight += weight[node];
+    numActive += active[node];
+    }
+
+  double totalWeight = 0.0;
+  CHECK_ZERO(comm_->SumAll(&myWeight, &totalWeight, 1));
+
+  numLocalSubdomains_ = 0;
+  if (numNodes > 0)
+    {
+    if (numGlobalSubdomains_ > 0 && totalWeight > 0.0)
+      {
+      // distribute the subdomains according to the work on each process
+      numLocalSubdomains_ = (int)std::round(
+        numGlobalSubdomains_ * myWeight / totalWeight);
+      }
+    else
+      {
+      // take the size of a Cartesian subdomain, but only count
+      // active nodes
+      int sdSize = sx_ * sy_ * (dim_ > 2 ? sz_ : 1);
+      numLocalSubdomains_ = (numActive + sdSize - 1) / sdSize;
+      }
+    numLocalSubdomains_ = std::max(numLocalSubdomains_, 1);
+    numLocalSubdomains_ = std::min(numLocalSubdomains_, numNodes);
+    }
+
+  Teuchos::Array<int> nodes(numNodes);
+  for (int node = 0; node < numNodes; node++)
+    nodes[node] = node;
+
+  nodePart.assign(numNodes, -1);
+  Teuchos::Array<int> member(numNodes, 0);
+  Teuchos::Array<int> visited(numNodes, 0);
+  int numSets = 0;
+  int stamp = 0;
+
+  Bisect(nodes, numLocalSubdomains_, 0, weight, adj,
+    member, numSets, visited, stamp, nodePart);
+
+  return 0;
+  }
+
+int GraphPartitioner::CreateSymmetricGraph()
+  {
+  HYMLS_PROF3(label_, "CreateSymmetricGraph");
+
+  Epetra_BlockMap const &rowMap = graph_->RowMap();
+  Epetra_BlockMap const &colMap = graph_->ColMap();
+
+  Teuchos::RCP<Epetra_FECrsGraph> graph = Teuchos::rcp(
+    new Epetra_FECrsGraph(Copy, rowMap, 2 * graph_->MaxNumIndices() + 1));
+
+  // Every row gets a diagonal entry, so all owned nodes are
+  // also in the column map
+  Teuchos::Array<hymls_gidx> cols(graph_->MaxNumIndices() + 1);
+  for (int lid = 0; lid < rowMap.NumMyElements(); lid++)
+    {
+    hymls_gidx row = rowMap.GID64(lid);
+    int len;
+    int *indices;
+    CHECK_ZERO(graph_->ExtractMyRowView(lid, len, indices));
+
+    cols[0] = row;
+    for (int j = 0; j < len; j++)
+      cols[j + 1] = colMap.GID64(indices[j]);
+
+    CHECK_NONNEG(graph->InsertGlobalIndices(1, &row, len + 1, cols.getRawPtr()));
+    for (int j = 1; j <= len; j++)
+      CHECK_NONNEG(graph->InsertGlobalIndices(1, &cols[j], 1, &row));
+    }
+  CHECK_ZERO(graph->GlobalAssemble());
+
+  graph_ = graph;
+
+  return 0;
+  }
+
+int GraphPartitioner::CreateGroups(Teuchos::Array<int> const &rowActive)
+  {
+  HYMLS_PROF3(label_, "CreateGroups");
+
+  Epetra_BlockMap const &rowMap = graph_->RowMap();
+  Epetra_BlockMap const &colMap = graph_->ColMap();
+  int numMyRows = rowMap.NumMyElements();
+
+  // Get the subdomains of all neighbours
+  Epetra_Import colImport(colMap, rowMap);
+
+  Epetra_IntVector rowPart(rowMap);
+  for (int lid = 0; lid < numMyRows; lid++)
+    rowPart[lid] = partition_[lid];
+
+  Epetra_IntVector colPart(colMap);
+  CHECK_ZERO(colPart.Import(rowPart, colImport, Insert));
+
+  // Of every edge between two subdomains, one of the end points
+  // becomes a separator node. This is the one in the subdomain with
+  // the lowest ID, unless that is a pressure node and the other one
+  // is not.
+  Teuchos::Array<int> isSeparator(numMyRows, 0);
+  Teuchos::Array<Teuchos::Array<int> > borders(numMyRows);
+  int myMaxBorders = 0;
+  for (int lid = 0; lid < numMyRows; lid++)
+    {
+    int sd = partition_[lid];
+    bool interiorVariable = IsInteriorVariable(rowMap.GID64(lid));
+
+    int len;
+    int *indices;
+    CHECK_ZERO(graph_->ExtractMyRowView(lid, len, indices));
+    for (int j = 0; j < len; j++)
+      {
+      int sd2 = colPart[indices[j]];
+      if (sd2 == sd)
+        continue;
+
+      bool interiorVariable2 = IsInteriorVariable(colMap.GID64(indices[j]));
+      if ((sd2 > sd && !(interiorVariable && !interiorVariable2)) ||
+        (sd2 < sd && interiorVariable2 && !interiorVariable))
+        isSeparator[lid] = 1;
+
+      borders[lid].append(sd2);
+      }
+
+    std::sort(borders[lid].begin(), borders[lid].end());
+    borders[lid].erase(std::unique(borders[lid].begin(), borders[lid].end()),
+      borders[lid].end());
+    myMaxBorders = std::max(myMaxBorders, (int)borders[lid].size());
+    }
+
+  int maxBorders = 0;
+  CHECK_ZERO(comm_->MaxAll(&myMaxBorders, &maxBorders, 1));
+
+  // Send the separator nodes and the subdomains they border to all
+  // neighbouring processes. The first column contains 1 for separator
+  // nodes, the others the bordering subdomains padded with -1.
+  Epetra_MultiVector rowInfo(rowMap, maxBorders + 1);
+  CHECK_ZERO(rowInfo.PutScalar(-1.0));
+  for (int lid = 0; lid < numMyRows; lid++)
+    {
+    rowInfo[0][lid] = isSeparator[lid];
+    for (int k = 0; k < borders[lid].size(); k++)
+      rowInfo[k + 1][lid] = borders[lid][k];
+    }
+
+  Epetra_MultiVector colInfo(colMap, maxBorders + 1);
+  CHECK_ZERO(colInfo.Import(rowInfo, colImport, Insert));
+
+  // A separator group contains all separator nodes of a variable in
+  // the same subdomain that border the same subdomains. It belongs
+  // to all of those subdomains.
+  typedef std::pair<std::vector<int>, int> GroupKey;
+  std::vector<std::map<GroupKey, Teuchos::Array<hymls_gidx> > > groups(numLocalSubdomains_);
+  for (int lid = 0; lid < colMap.NumMyElements(); lid++)
+    {
+    if (colInfo[0][lid] < 0.5)
+      continue;
+
+    hymls_gidx gid = colMap.GID64(lid);
+
+    std::vector<int> subdomains(1, colPart[lid]);
+    for (int k = 1; k <= maxBorders && colInfo[k][lid] > -0.5; k++)
+      subdomains.push_back((int)colInfo[k][lid]);
+
+    GroupKey key(subdomains, (int)(gid % dof_));
+    for (int sd: subdomains)
+      {
+      int lsd = sdMap_->LID(sd);
+      if (lsd >= 0)
+        groups[lsd][key].append(gid);
+      }
+    }
+
+  interiorGroups_.clear();
+  interiorGroups_.resize(numLocalSubdomains_);
+  separatorGroups_.clear();
+  separatorGroups_.resize(numLocalSubdomains_);
+
+  // Retain active pressure nodes in the interior of every subdomain
+  // to keep the pressure on the next level connected
+  for (int lid = 0; lid < numMyRows; lid++)
+    {
+    if (isSeparator[lid])
+      continue;
+
+    hymls_gidx gid = rowMap.GID64(lid);
+    int lsd = sdMap_->LID(partition_[lid]);
+
+    int numRetained = 0;
+    for (SeparatorGroup const &group: separatorGroups_[lsd])
+      numRetained += group.length();
+
+    if (variableType_[(int)(gid % dof_)] == VariableType::Pressure &&
+      rowActive[lid] && numRetained < retainPressures_)
+      {
+      SeparatorGroup group;
+      group.append(gid);
+      separatorGroups_[lsd].append(group);
+      }
+    else
+      interiorGroups_[lsd].append(gid);
+    }
+
+  for (int lsd = 0; lsd < numLocalSubdomains_; lsd++)
+    {
+    Teuchos::Array<SeparatorGroup> retained = separatorGroups_[lsd];
+    separatorGroups_[lsd].clear();
+
+    // Groups on the same separator have the same type, as in the
+    // CartesianPartitioner
+    int pos = -1;
+    std::vector<int> last;
+    for (auto const &entry: groups[lsd])
+      {
+      if (pos < 0 || entry.first.first != last)
+        {
+        last = entry.first.first;
+        pos++;
+        }
+
+      int d = entry.first.second;
+      bool velocity = variableType_[d] == VariableType::Velocity_U ||
+        variableType_[d] == VariableType::Velocity_V ||
+        variableType_[d] == VariableType::Velocity_W;
+
+      int type = -1000;
+      if (link_retained_nodes_)
+        type = 2 * dof_ * pos;
+      if (!(link_velocities_ && velocity))
+        type += 2 * d;
+
+      SeparatorGroup group;
+      group.set_type(type);
+      group.nodes() = entry.second;
+      separatorGroups_[lsd].append(group);
+      }
+
+    for (SeparatorGroup const &group: retained)
+      separatorGroups_[lsd].append(group);
+    }
+
+  return 0;
+  }
+
+// partition the graph into subdomains
+int GraphPartitioner::Partition(bool repart)
+  {
+  HYMLS_PROF3(label_,"Partition");
+
+  if (graph_ == Teuchos::null)
+    Tools::Error("The graph partitioner needs the graph of the matrix",
+      __FILE__, __LINE__);
+
+  if (baseMap_ == Teuchos::null)
+    baseMap_ = Teuchos::rcp(new Epetra_Map(
+        static_cast<const Epetra_Map &>(graph_->RowMap())));
+
+  if (!graph_->RowMap().SameAs(*baseMap_))
+    Tools::Error("The graph should have the same row map as the map that is partitioned",
+      __FILE__, __LINE__);
+
+  int numMyRows = baseMap_->NumMyElements();
+
+  Teuchos::Array<int> rowActive(numMyRows);
+  for (int lid = 0; lid < numMyRows; lid++)
+    rowActive[lid] = graph_->NumMyIndices(lid) > 1;
+
+  Teuchos::Array<int> rowNode;
+  Teuchos::Array<int> nodePart;
+  CHECK_ZERO(CreateLocalParts(rowNode, nodePart));
+
+  sdMap_ = Teuchos::rcp(new Epetra_Map(-1, numLocalSubdomains_, 0, *comm_));
+
+  partition_.resize(numMyRows);
+  for (int lid = 0; lid < numMyRows; lid++)
+    partition_[lid] = sdMap_->GID(nodePart[rowNode[lid]]);
+
+  nprocs_ = comm_->NumProc();
+  destinationPID_ = -1;
+
+  CHECK_ZERO(CreateSymmetricGraph());
+  CHECK_ZERO(CreateGroups(rowActive));
+
+  Tools::Out("Partition graph: ");
+  Tools::Out("Number of Rows: " + toString(baseMap_->NumGlobalElements64()));
+  Tools::Out("Number of Subdomains: " + toString(sdMap_->NumGlobalElements()));
+  Tools::Out("Number of Local Subdomains: " + toString(NumLocalParts()));
+
+  return 0;
+  }
+
+int GraphPartitioner::GetGroups(int sd, InteriorGroup &interior_group,
+  Teuchos::Array<SeparatorGroup> &separator_groups) const
+  {
+  HYMLS_PROF3(label_,"GetGroups");
+
+  // Copy the nodes, the groups may be modified by the caller
+  GroupNodes nodes = interiorGroups_[sd].nodes();
+  interior_group.nodes().assign(nodes.begin(), nodes.end());
+
+  separator_groups.clear();
+  for (SeparatorGroup const &group: separatorGroups_[sd])
+    {
+    SeparatorGroup separator;
+    separator.set_type(group.type());
+    separator.nodes().assign(group.nodes().begin(), group.nodes().end());
+    separator_groups.append(separator);
+    }
+
+  return 0;
+  }
+
+  }
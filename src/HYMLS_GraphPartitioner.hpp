@@ -0,0 +1,164 @@
+#ifndef HYMLS_GRAPH_PARTITONER_H
+#define HYMLS_GRAPH_PARTITONER_H
+
+#include "HYMLS_BasePartitioner.hpp"
+
+#include "HYMLS_config.h"
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_Array.hpp"
+
+#include "HYMLS_InteriorGroup.hpp"
+#include "HYMLS_SeparatorGroup.hpp"
+
+class Epetra_Comm;
+class Epetra_Map;
+class Epetra_CrsGraph;
+
+namespace Teuchos {
+class ParameterList;
+  }
+
+namespace HYMLS {
+
+/*! Partitioner that works on the graph of the matrix instead of
+  on a Cartesian grid. It can be used for irregular domains, for
+  instance ocean basins where a large part of the grid is masked
+  out by land cells.
+
+  The owned nodes (i.e. all variables of a grid cell, grouped by
+  gid/dof) of each process are split into subdomains by recursive
+  graph bisection, using level structures grown from a pseudo-
+  peripheral node. The nodes are weighted by their number of
+  nonzeros, so that cells with only a diagonal entry (Dirichlet or
+  land cells) hardly count. The number of subdomains follows from
+  the separator lengths (the size a Cartesian subdomain would have)
+  or from the "Number of Subdomains" parameter.
+
+  Separators are found from the connectivity: of every edge between
+  two subdomains one end point becomes a separator node. Pressure
+  and 'Interior' variables are kept in the interior if possible, and
+  one (or "Retained Pressure Nodes") pressure node per subdomain is
+  retained, as in the Cartesian partitioner. Separator nodes are
+  grouped by the subdomain they are in, the set of subdomains they
+  border and their variable type.
+
+  The graph is assumed to be distributed like the map that is
+  partitioned, it is symmetrized internally. No repartitioning is
+  done, each subdomain is local to a process.
+*/
+class GraphPartitioner : public BasePartitioner
+  {
+public:
+
+  //! constructor
+  GraphPartitioner(Teuchos::RCP<const Epetra_Map> map,
+    Teuchos::RCP<const Epetra_CrsGraph> graph,
+    Teuchos::RCP<Teuchos::ParameterList> const &params,
+    Epetra_Comm const &comm, int level=-1);
+
+  //! destructor
+  virtual ~GraphPartitioner();
+
+  //! set parameters for the partitioner like separator length
+  void SetParameters(Teuchos::ParameterList& params);
+
+  //! get a pararmeterlist with the number of subdomains for
+  //! the next level
+  void SetNextLevelParameters(Teuchos::ParameterList& params) const;
+
+  //! get non-overlapping subdomain id of an owned gid
+  int operator()(hymls_gidx gid) const;
+
+  //! partition the graph of the matrix into subdomains. The
+  //! repart argument is ignored, every process partitions its
+  //! own nodes.
+  int Partition(bool repart=false);
+
+  //! Get interior and separator groups of the subdomain sd
+  int GetGroups(int sd, InteriorGroup &interior_group,
+    Teuchos::Array<SeparatorGroup> &separator_groups) const;
+
+  //! is this class fully set up?
+  inline bool Partitioned() const
+    {
+    return sdMap_ != Teuchos::null;
+    }
+
+  //! return the map, which is the same as the input map
+  inline Teuchos::RCP<const Epetra_Map> GetMap() const
+    {
+    return baseMap_;
+    }
+
+  //! return the map with global subdomain IDs
+  inline const Epetra_Map& SubdomainMap() const
+    {
+    return *sdMap_;
+    }
+
+  //! return the number of subdomains in this proc partition
+  int NumLocalParts() const;
+
+  //! return the global number of subdomains
+  int NumGlobalParts(int sx, int sy, int sz) const;
+
+protected:
+
+  //! we do not need nx, ny and nz
+  bool NeedsGridSize() const {return false;}
+
+  //! not available for a graph partitioning
+  int GetSubdomainPosition(int sd, int sx, int sy, int sz, int &x, int &y, int &z) const;
+
+  //! not available for a graph partitioning
+  int GetSubdomainID(int sx, int sy, int sz, int x, int y, int z) const;
+
+  //! get processor on which an owned grid point is located
+  int PID(hymls_gidx gid) const;
+
+  //! create the symmetric graph A+A' of the input graph
+  int CreateSymmetricGraph();
+
+  //! split the local nodes into numLocalSubdomains_ parts
+  int CreateLocalParts(Teuchos::Array<int> &rowNode,
+    Teuchos::Array<int> &nodePart);
+
+  //! determine the separators and build the groups of all
+  //! local subdomains. Only pressure nodes in active rows
+  //! are retained.
+  int CreateGroups(Teuchos::Array<int> const &rowActive);
+
+  //! true if a variable should preferably not be on a separator
+  bool IsInteriorVariable(hymls_gidx gid) const;
+
+  //! label
+  std::string label_;
+
+  //! map that is partitioned
+  Teuchos::RCP<const Epetra_Map> baseMap_;
+
+  //! graph of the matrix, symmetric after Partition()
+  Teuchos::RCP<const Epetra_CrsGraph> graph_;
+
+  //! maps global to local subdomain ID
+  Teuchos::RCP<Epetra_Map> sdMap_;
+
+  //! number of subdomains on this proc
+  int numLocalSubdomains_;
+
+  //! requested global number of subdomains (-1 if determined
+  //! by the separator length)
+  int numGlobalSubdomains_;
+
+  //! global subdomain ID of each owned row
+  Teuchos::Array<int> partition_;
+
+  //! interior nodes of the local subdomains
+  Teuchos::Array<InteriorGroup> interiorGroups_;
+
+  //! separator groups of the local subdomains
+  Teuchos::Array<Teuchos::Array<SeparatorGroup> > separatorGroups_;
+  };
+
+  }
+#endif
@@ -17,6 +17,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <map>
 
 namespace HYMLS {
 
@@ -44,6 +45,7 @@ HierarchicalMap::HierarchicalMap(
   Teuchos::RCP<Teuchos::Array<InteriorGroup> > interior_groups,
   Teuchos::RCP<Teuchos::Array<Teuchos::Array<SeparatorGroup> > > separator_groups,
   Teuchos::RCP<Teuchos::Array<Teuchos::Array<Teuchos::Array<SeparatorGroup> > > > linked_separator_groups,
+  Teuchos::RCP<Teuchos::Array<hymls_gidx> > group_nodes,
   std::string label, int level)
   :
   label_(label),
@@ -53,7 +55,8 @@ HierarchicalMap::HierarchicalMap(
   overlappingMap_(overlappingMap),
   interior_groups_(interior_groups),
   separator_groups_(separator_groups),
-  linked_separator_groups_(linked_separator_groups)
+  linked_separator_groups_(linked_separator_groups),
+  group_nodes_(group_nodes)
   {
   HYMLS_LPROF2(label_,"HierarchicalMap Constructor");
   spawnedObjects_.resize(3); // can currently spawn Interior, Separator and LocalSeparator objects
@@ -66,6 +69,7 @@ HierarchicalMap::HierarchicalMap(
     for (int sd = 0; sd < NumMySubdomains(); sd++)
       spawnedMaps_[i][sd] = Teuchos::null;
     }
+  ComputeLIDs();
   }
 
 HierarchicalMap::~HierarchicalMap()
@@ -245,8 +249,13 @@ int HierarchicalMap::FillComplete()
 
   unique_separator_groups_ = Teuchos::rcp(new Teuchos::Array<Teuchos::Array<SeparatorGroup> >(NumMySubdomains()));
 
-  Teuchos::Array<hymls_gidx> all_gids;
-  Teuchos::Array<hymls_gidx> unique_group_ids;
+  // Store the nodes of all groups in one contiguous array and let the
+  // groups refer to their part of it. This avoids an allocation per
+  // group, and groups that appear in more than one subdomain share
+  // their nodes. The array contains exactly the overlapping map.
+  Teuchos::RCP<Teuchos::Array<hymls_gidx> > all_gids =
+    Teuchos::rcp(new Teuchos::Array<hymls_gidx>());
+  std::map<hymls_gidx, int> unique_group_offsets;
   for (int sd = 0; sd < NumMySubdomains(); sd++)
     {
     // Remove empty separator groups
@@ -256,23 +265,40 @@ int HierarchicalMap::FillComplete()
       (*separator_groups_)[sd].end());
 
     InteriorGroup const &group = GetInteriorGroup(sd);
-    std::copy(group.nodes().begin(), group.nodes().end(), std::back_inserter(all_gids));
+    int offset = all_gids->length();
+    std::copy(group.nodes().begin(), group.nodes().end(), std::back_inserter(*all_gids));
+    (*interior_groups_)[sd] = InteriorGroup(all_gids, offset, group.length(), group.type());
 
-    for (SeparatorGroup const &group: GetSeparatorGroups(sd))
+    for (SeparatorGroup &group: (*separator_groups_)[sd])
       {
       // Only copy unique groups and cache those
-      if (std::find_if(unique_group_ids.begin(), unique_group_ids.end(), [group](
-            hymls_gidx gid) {return gid == group[0];}) == unique_group_ids.end())
+      auto it = unique_group_offsets.find(group[0]);
+      if (it == unique_group_offsets.end())
         {
+        offset = all_gids->length();
+        std::copy(group.nodes().begin(), group.nodes().end(), std::back_inserter(*all_gids));
+        unique_group_offsets[group[0]] = offset;
+        group = SeparatorGroup(all_gids, offset, group.length(), group.type());
         (*unique_separator_groups_)[sd].append(group);
-        unique_group_ids.append(group[0]);
-        std::copy(group.nodes().begin(), group.nodes().end(), std::back_inserter(all_gids));
+        }
+      else
+        {
+        offset = it->second;
+#ifdef HYMLS_TESTING
+        if (offset + group.length() > all_gids->length() ||
+          !std::equal(group.nodes().begin(), group.nodes().end(), all_gids->begin() + offset))
+          Tools::Error("separator groups with the same first node differ", __FILE__, __LINE__);
+#endif
+        group = SeparatorGroup(all_gids, offset, group.length(), group.type());
         }
       }
     }
 
-  overlappingMap_ = Teuchos::rcp(new Epetra_Map((hymls_gidx)(-1), all_gids.length(),
-      all_gids.getRawPtr(), (hymls_gidx)baseMap_->IndexBase64(), Comm()));
+  overlappingMap_ = Teuchos::rcp(new Epetra_Map((hymls_gidx)(-1), all_gids->length(),
+      all_gids->getRawPtr(), (hymls_gidx)baseMap_->IndexBase64(), Comm()));
+
+  group_nodes_ = all_gids;
+  ComputeLIDs();
 
   // Link together separator groups that have the same type, e.g. when they
   // are on the same separator.
@@ -335,6 +361,58 @@ Teuchos::Array<Teuchos::Array<SeparatorGroup> > const &HierarchicalMap::GetLinke
   return (*linked_separator_groups_)[sd];
   }
 
+int HierarchicalMap::ComputeLIDs()
+  {
+  HYMLS_LPROF3(label_, "ComputeLIDs");
+
+  // Look up every node once here so loops over the groups can
+  // use direct indexing instead of Epetra_Map::LID
+  int n = group_nodes_ != Teuchos::null ? group_nodes_->length() : 0;
+  lids_.resize(n);
+  overlapping_lids_.resize(n);
+  for (int i = 0; i < n; i++)
+    {
+    lids_[i] = baseMap_->LID((*group_nodes_)[i]);
+    overlapping_lids_[i] = overlappingMap_->LID((*group_nodes_)[i]);
+    }
+
+  return 0;
+  }
+
+Teuchos::ArrayView<const int> HierarchicalMap::GroupLIDs(
+  Teuchos::Array<int> const &lids, SeparatorGroup const &group) const
+  {
+  int offset = group.offset();
+  if (offset < 0 || offset + group.length() > lids.length())
+    Tools::Error("group is not stored in this object", __FILE__, __LINE__);
+#ifdef HYMLS_TESTING
+  if (group.length() > 0 && &group[0] != group_nodes_->getRawPtr() + offset)
+    Tools::Error("group is not stored in this object", __FILE__, __LINE__);
+#endif
+  return lids.view(offset, group.length());
+  }
+
+Teuchos::ArrayView<const int> HierarchicalMap::LIDs(SeparatorGroup const &group) const
+  {
+  return GroupLIDs(lids_, group);
+  }
+
+Teuchos::ArrayView<const int> HierarchicalMap::OverlappingLIDs(SeparatorGroup const &group) const
+  {
+  return GroupLIDs(overlapping_lids_, group);
+  }
+
+int HierarchicalMap::SubdomainOffset(int sd, SeparatorGroup const &group) const
+  {
+  // The spawned map lists the groups one after the other, so the
+  // local index of the first node is where the group starts. The
+  // map looks it up in a hash table.
+  int lid = group.length() > 0 ? SpawnMap(sd, Separators)->LID(group[0]) : -1;
+  if (lid < 0)
+    Tools::Error("group is not a separator group of this subdomain", __FILE__, __LINE__);
+  return lid;
+  }
+
 //! print domain decomposition to file
 std::ostream& HierarchicalMap::Print(std::ostream& os) const
   {
@@ -460,7 +538,7 @@ HierarchicalMap::SpawnInterior() const
   delete [] myElements;
 
   newObject = Teuchos::rcp(new HierarchicalMap(newMap, newMap,
-      interior_groups_, Teuchos::null, Teuchos::null, "Interior Nodes", myLevel_));
+      interior_groups_, Teuchos::null, Teuchos::null, group_nodes_, "Interior Nodes", myLevel_));
 
   return newObject;
   }
@@ -502,7 +580,7 @@ HierarchicalMap::SpawnSeparators() const
       localGIDs.getRawPtr(), (hymls_gidx)baseMap_->IndexBase64(), Comm()));
 
   newObject = Teuchos::rcp(new HierarchicalMap(newMap, newOverlappingMap,
-      Teuchos::null, separator_groups_, linked_separator_groups_, "Separator Nodes", myLevel_));
+      Teuchos::null, separator_groups_, linked_separator_groups_, group_nodes_, "Separator Nodes", myLevel_));
 
   return newObject;
   }
@@ -536,7 +614,8 @@ HierarchicalMap::SpawnLocalSeparators() const
   LinkSeparators(new_separator_groups, new_linked_separator_groups);
 
   newObject = Teuchos::rcp(new HierarchicalMap(sepObject->GetMap(), sepObject->GetMap(),
-      Teuchos::null, new_separator_groups, new_linked_separator_groups, "Local Separator Nodes", myLevel_));
+      Teuchos::null, new_separator_groups, new_linked_separator_groups, group_nodes_,
+      "Local Separator Nodes", myLevel_));
 
   return newObject;
   }
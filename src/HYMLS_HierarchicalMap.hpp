@@ -86,6 +86,19 @@ public:
 
   //! returns the separator groups for a certain subdomain
   Teuchos::Array<Teuchos::Array<SeparatorGroup> > const &GetLinkedSeparatorGroups(int sd) const;
+
+  //! local indices in Map() of the nodes of a group of this object or
+  //! of an object that shares its groups, -1 for nodes not in Map()
+  Teuchos::ArrayView<const int> LIDs(SeparatorGroup const &group) const;
+
+  //! local indices in OverlappingMap() of the nodes of a group of this
+  //! object or of an object that shares its groups
+  Teuchos::ArrayView<const int> OverlappingLIDs(SeparatorGroup const &group) const;
+
+  //! local index in SpawnMap(sd, Separators) of the first node of a
+  //! separator group of subdomain sd. The nodes of a group are
+  //! consecutive in that map, so node j has index SubdomainOffset() + j.
+  int SubdomainOffset(int sd, SeparatorGroup const &group) const;
   //@}
 
   //! creates a 'next generation' object that retains certain nodes.
@@ -218,6 +231,15 @@ private:
   //! for instance because they are on the same separator.
   Teuchos::RCP<Teuchos::Array<Teuchos::Array<Teuchos::Array<SeparatorGroup> > > > linked_separator_groups_;
 
+  //! nodes of all groups, which refer to a part of it after FillComplete()
+  Teuchos::RCP<Teuchos::Array<hymls_gidx> > group_nodes_;
+
+  //! local indices of group_nodes_ in baseMap_
+  Teuchos::Array<int> lids_;
+
+  //! local indices of group_nodes_ in overlappingMap_
+  Teuchos::Array<int> overlapping_lids_;
+
   //! array of spawned objects (so we avoid building the same thing over and over again)
   mutable Teuchos::Array<Teuchos::RCP<const HierarchicalMap> > spawnedObjects_;
 
@@ -233,6 +255,7 @@ private:
     Teuchos::RCP<Teuchos::Array<InteriorGroup> > interior_groups,
     Teuchos::RCP<Teuchos::Array<Teuchos::Array<SeparatorGroup> > > separator_groups,
     Teuchos::RCP<Teuchos::Array<Teuchos::Array<Teuchos::Array<SeparatorGroup> > > > linked_separator_groups,
+    Teuchos::RCP<Teuchos::Array<hymls_gidx> > group_nodes,
     std::string label, int level);
 
   //! \name private member functions
@@ -242,6 +265,13 @@ private:
     Teuchos::RCP<Teuchos::Array<Teuchos::Array<SeparatorGroup> > > separator_groups,
     Teuchos::RCP<Teuchos::Array<Teuchos::Array<Teuchos::Array<SeparatorGroup> > > > linked_separator_groups) const;
 
+  //! compute the local indices of group_nodes_ in the maps
+  int ComputeLIDs();
+
+  //! part of lids that belongs to group
+  Teuchos::ArrayView<const int> GroupLIDs(Teuchos::Array<int> const &lids,
+    SeparatorGroup const &group) const;
+
   //!
   Teuchos::RCP<const HierarchicalMap> SpawnInterior() const;
   //!
@@ -8,8 +8,12 @@
 
 #include "HYMLS_Macros.hpp"
 
+#include <algorithm>
+
 namespace HYMLS {
 
+const HyperCube* HyperCube::instance_ = NULL;
+
 HyperCube::HyperCube()
   {
   HYMLS_PROF3("HyperCube","HyperCube");
@@ -56,6 +60,9 @@ HyperCube::HyperCube()
     }
   CHECK_ZERO(commWorld_->SumAll(&my_node[0],&all_nodes[0],numNodes_));  
   
+  numProcOnNode_=all_nodes[nodeNumber_];
+  HYMLS_DEBVAR(numProcOnNode_);
+
   maxProcPerNode_=0;
   for (int i=0;i<numNodes_;i++) 
     {
@@ -85,6 +92,14 @@ HyperCube::HyperCube()
   
   reorderedComm_=Teuchos::rcp(new Epetra_MpiComm(NewComm));
 
+  // and one with only the ranks on this node
+  MPI_Comm NodeComm;
+  MPI_Comm_split(commWorld_->Comm(),nodeNumber_,rankOnNode_,&NodeComm);
+
+  nodeComm_=Teuchos::rcp(new Epetra_MpiComm(NodeComm));
+
+  instance_=this;
+
 //#ifdef HYMLS_TESTING  
   for (int i=0;i<reorderedComm_->NumProc();i++)
     {
@@ -102,6 +117,37 @@ HyperCube::HyperCube()
   
 HyperCube::~HyperCube()
   {
+  if (instance_==this) instance_=NULL;
+  }
+
+bool HyperCube::IsCongruent(Epetra_Comm const &comm) const
+  {
+  Epetra_MpiComm const *mpiComm = dynamic_cast<Epetra_MpiComm const *>(&comm);
+  if (mpiComm == NULL) return false;
+
+  MPI_Comm comms[2] = {reorderedComm_->Comm(), commWorld_->Comm()};
+  for (int i = 0; i < 2; i++)
+    {
+    int result;
+    CHECK_ZERO(MPI_Comm_compare(mpiComm->Comm(), comms[i], &result));
+    if (result == MPI_IDENT || result == MPI_CONGRUENT) return true;
+    }
+  return false;
+  }
+
+int HyperCube::NumActiveProcsOnNode(bool active) const
+  {
+  int my_active = active? 1: 0;
+  int num_active = 0;
+  CHECK_ZERO(nodeComm_->SumAll(&my_active,&num_active,1));
+  return num_active;
+  }
+
+int HyperCube::NumThreads(bool active, int threadsPerProc) const
+  {
+  int num_active = NumActiveProcsOnNode(active);
+  if (!active || num_active==0) return 1;
+  return std::max(1,threadsPerProc*numProcOnNode_/num_active);
   }
 
 std::ostream& HyperCube::Print(std::ostream& os) const
@@ -4,6 +4,7 @@
 #include <iostream>
 #include "Teuchos_RCP.hpp"
 
+class Epetra_Comm;
 class Epetra_MpiComm;
 
 namespace HYMLS {
@@ -60,6 +61,29 @@ Teuchos::RCP<Epetra_MpiComm> GetComm() {return reorderedComm_;}
 //!
 std::ostream& Print(std::ostream& os) const;
 
+//! the most recently constructed HyperCube, or NULL if there is none.
+//! This allows the solver to query the processor topology without
+//! passing the object around.
+static const HyperCube* Instance() {return instance_;}
+
+//! true if comm has the same ranks in the same order as Comm() or
+//! MPI_COMM_WORLD (MPI_Comm_compare gives MPI_IDENT or MPI_CONGRUENT),
+//! so that the methods below can be called by all its ranks.
+bool IsCongruent(Epetra_Comm const &comm) const;
+
+//! number of ranks on the node of this rank
+int NumProcOnNode() const {return numProcOnNode_;}
+
+//! number of ranks on the node of this rank for which active is true.
+//! This has to be called by all ranks of commWorld_.
+int NumActiveProcsOnNode(bool active) const;
+
+//! number of threads that an active rank can use if the cores of the
+//! inactive ranks on its node are divided over the active ones and
+//! every rank has threadsPerProc cores of its own. This has to be
+//! called by all ranks of commWorld_. Inactive ranks get one thread.
+int NumThreads(bool active, int threadsPerProc = 1) const;
+
 protected:
 
 //!
@@ -76,6 +100,11 @@ int maxProcPerNode_;
 Teuchos::RCP<Epetra_MpiComm> commWorld_;
 //!
 Teuchos::RCP<Epetra_MpiComm> reorderedComm_;
+//! ranks on the same node as this rank
+Teuchos::RCP<Epetra_MpiComm> nodeComm_;
+
+//!
+static const HyperCube* instance_;
 };
 
 }//namespace
@@ -17,6 +17,12 @@ public:
     SeparatorGroup()
     {}
 
+  InteriorGroup(Teuchos::RCP<Teuchos::Array<hymls_gidx> > const &nodes,
+    int offset, int length, int type)
+    :
+    SeparatorGroup(nodes, offset, length, type)
+    {}
+
   };
 
   }
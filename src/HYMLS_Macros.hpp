@@ -86,16 +86,21 @@
  s1 and s2 are concatenated to form the profiler/timer label.
  s1 may be e.g. an object label and s2 a function name.
  */
-#define HYMLS_PROF(s1,s2) HYMLS::TimerObject \
-Error_You_are_trying_to_start_multiple_timers_in_one_scope \
-(((std::string)(s1))+": "+(((std::string)(s2))),PRINT_TIMING); \
+#define HYMLS_PROF(s1,s2) HYMLS_TIMER_SITE(s1,s2,-1) \
 SCOREP_USER_REGION((std::string(s1)+std::string(s2)).c_str(),SCOREP_USER_REGION_TYPE_FUNCTION)
 
 /*! @def HYMLS_LPROF(s1,s2): like HYMLS_PROF, but for HYMLS' recursively constructed 
 classes. The macro assumes that the calling scope (e.g. the class) has an int variable 
 'myLevel_', which it will append to s1.*/ 
-#define HYMLS_LPROF(s1,s2) HYMLS_PROF(s1+"_L"+Teuchos::toString(myLevel_),s2) \
+#define HYMLS_LPROF(s1,s2) HYMLS_TIMER_SITE(s1,s2,myLevel_) \
 SCOREP_USER_PARAMETER_INT64("level",(int64_t)myLevel_);
+
+// Every timer site looks up its timer ID only once per label and thread, so
+// starting and stopping a timer does not involve any string operations.
+#define HYMLS_TIMER_SITE(s1,s2,level) \
+static thread_local HYMLS::TimerSite HYMLS_timer_site_; \
+HYMLS::TimerObject Error_You_are_trying_to_start_multiple_timers_in_one_scope \
+(HYMLS_timer_site_.ID(s1,s2,level),PRINT_TIMING);
 #else
 #define HYMLS_PROF(s1,s2)
 #define HYMLS_LPROF(s1,s2)
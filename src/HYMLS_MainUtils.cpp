@@ -17,6 +17,7 @@
 
 #include "HYMLS_Tools.hpp"
 #include "HYMLS_Macros.hpp"
+#include "HYMLS_MatrixUtils.hpp"
 #include "HYMLS_CartesianPartitioner.hpp"
 #include "HYMLS_SkewCartesianPartitioner.hpp"
 
@@ -50,6 +51,10 @@ Teuchos::RCP<Epetra_CrsMatrix> read_matrix(std::string datadir,
     {
     suffix="2.mtx";
     }
+  else if (file_format=="Binary")
+    {
+    suffix=".bin";
+    }
   else
     {
     HYMLS::Tools::Error("File format '"+file_format+"' not supported",__FILE__,__LINE__);
@@ -72,6 +77,10 @@ Teuchos::RCP<Epetra_CrsMatrix> read_matrix(std::string datadir,
 #endif
     K=Teuchos::rcp(Kptr, true);
     }
+  else if (file_format=="Binary")
+    {
+    K=HYMLS::MatrixUtils::binread(filename, *map);
+    }
   else
     {
     HYMLS::Tools::Error("File format '"+file_format+"' not supported",__FILE__,__LINE__);
@@ -97,6 +106,10 @@ Teuchos::RCP<Epetra_Vector> read_vector(std::string name,std::string datadir,
     {
     suffix="2.mtx";
     }
+  else if (file_format=="Binary")
+    {
+    suffix=".bin";
+    }
   else
     {
     HYMLS::Tools::Error("File format '"+file_format+"' not supported",__FILE__,__LINE__);
@@ -126,6 +139,11 @@ Teuchos::RCP<Epetra_Vector> read_vector(std::string name,std::string datadir,
     CHECK_ZERO(v->Import(*vptr,import,Insert));
     delete vptr;
     }
+  else if (file_format=="Binary")
+    {
+    v=Teuchos::rcp(new Epetra_Vector(*map));
+    CHECK_ZERO(HYMLS::MatrixUtils::binread(filename, *v));
+    }
   else
     {
     HYMLS::Tools::Error("File format '"+file_format+"' not supported",__FILE__,__LINE__);
@@ -15,6 +15,7 @@
 #include "HYMLS_HierarchicalMap.hpp"
 #include "HYMLS_SparseDirectSolver.hpp"
 #include "HYMLS_InteriorGroup.hpp"
+#include "HYMLS_CacheIO.hpp"
 
 #include "Ifpack_DenseContainer.h"
 #include "Ifpack_Amesos.h"
@@ -25,6 +26,9 @@
 #ifdef HYMLS_USE_MKL
 #include <mkl.h>
 #endif
+#ifdef HYMLS_USE_OPENMP
+#include <omp.h>
+#endif
 
 namespace HYMLS {
 
@@ -39,7 +43,13 @@ MatrixBlock::MatrixBlock(
   colStrategy_(colStrategy),
   label_("MatrixBlock"),
   useTranspose_(false),
-  myLevel_(level)
+  transposeNeeded_(false),
+  autoSolvers_(false),
+  myLevel_(level),
+  denseCrossover_(0),
+  denseFill_(2.0),
+  haveValuePlan_(false),
+  numRefreshValues_(0)
   {
   // First we get the maps belonging to the rows and columns of this
   // block. This will not cause any duplicate work because they are
@@ -50,25 +60,6 @@ MatrixBlock::MatrixBlock(
 
   Teuchos::RCP<const HierarchicalMap> colObject = hid_->Spawn(colStrategy);
   domainMap_ = colObject->GetMap();
-
-  /*
-  int active_ranks=HYMLS::ProcTopo->getNumActive(myLevel_);
-  if (active_ranks==comm_->NumProc())
-    {
-    Tools::out() << "ALL MPI RANKS ACTIVE"<<std::endl;
-    }
-  else
-    {
-    Tools::out() << "NUMBER OF ACTIVE RANKS: "<<active_ranks<<std::endl;
-    }
-  */
-  /*
-  int ranks_on_node=HYMLS::ProcTopo->numActiveProcsOnNode(myLevel_);
-  int total_ranks_on_node=HYMLS::ProcTopo->numActiveProcsOnNode(0);
-  // figure out how many threads we can use here
-  numThreadsSD_=std::max(1,(int)(total_ranks_on_node/ranks_on_node));
-  */
-
   }
 
 int MatrixBlock::Compute(Teuchos::RCP<const Epetra_CrsMatrix> matrix,
@@ -130,81 +121,233 @@ int MatrixBlock::Compute(Teuchos::RCP<const Epetra_CrsMatrix> matrix,
       }
     }
 
+  // Remember where the values of the blocks are in the extended
+  // matrix, so we can refresh them if only the values change
+  haveValuePlan_ = CreateValuePlan(*extendedMatrix, *block_, blockPlan_) == 0;
+  subBlockPlans_.resize(subBlocks_.size());
+  for (int sd = 0; sd < subBlocks_.size() && haveValuePlan_; sd++)
+    haveValuePlan_ = CreateValuePlan(*extendedMatrix, *subBlocks_[sd],
+      subBlockPlans_[sd]) == 0;
+
+  return 0;
+  }
+
+int MatrixBlock::RefreshValues(Epetra_CrsMatrix const &extendedMatrix)
+  {
+  HYMLS_LPROF(label_, "RefreshValues");
+
+  if (!haveValuePlan_)
+    {
+    Tools::Warning("No value plan available, call Compute() instead!", __FILE__, __LINE__);
+    return -1;
+    }
+
+  CHECK_ZERO(ApplyValuePlan(extendedMatrix, blockPlan_, *block_));
+  for (int sd = 0; sd < subBlocks_.size(); sd++)
+    CHECK_ZERO(ApplyValuePlan(extendedMatrix, subBlockPlans_[sd], *subBlocks_[sd]));
+
+  numRefreshValues_++;
+  return 0;
+  }
+
+unsigned long long MatrixBlock::StructureHash(Epetra_CrsMatrix const &A)
+  {
+  unsigned long long hash = cacheHashInit;
+  Teuchos::Array<hymls_gidx> gids = MyGIDs(A.RowMap());
+  if (gids.size() > 0)
+    hash = CacheHash(hash, gids.getRawPtr(), gids.size() * sizeof(hymls_gidx));
+  gids = MyGIDs(A.ColMap());
+  if (gids.size() > 0)
+    hash = CacheHash(hash, gids.getRawPtr(), gids.size() * sizeof(hymls_gidx));
+
+  int len;
+  int *indices;
+  double *values;
+  for (int i = 0; i < A.NumMyRows(); i++)
+    {
+    CHECK_ZERO(A.ExtractMyRowView(i, len, values, indices));
+    hash = CacheHash(hash, &len, sizeof(int));
+    if (len > 0)
+      hash = CacheHash(hash, indices, len * sizeof(int));
+    }
+  return hash;
+  }
+
+int MatrixBlock::CreateValuePlan(Epetra_CrsMatrix const &source,
+  Epetra_CrsMatrix const &target, ValuePlan &plan)
+  {
+  plan.rows.resize(target.NumMyRows());
+  plan.offsets.resize(target.NumMyNonzeros());
+
+  int len, sourceLen;
+  int *indices, *sourceIndices;
+  double *values, *sourceValues;
+  int pos = 0;
+  for (int i = 0; i < target.NumMyRows(); i++)
+    {
+    int row = source.LRID(target.GRID64(i));
+    if (row < 0)
+      return -1;
+    plan.rows[i] = row;
+
+    CHECK_ZERO(target.ExtractMyRowView(i, len, values, indices));
+    CHECK_ZERO(source.ExtractMyRowView(row, sourceLen, sourceValues, sourceIndices));
+
+    // rows are short, so a linear search is fine here
+    for (int j = 0; j < len; j++)
+      {
+      hymls_gidx gcid = target.GCID64(indices[j]);
+      int k = 0;
+      while (k < sourceLen && source.GCID64(sourceIndices[k]) != gcid)
+        k++;
+      if (k == sourceLen)
+        return -1;
+      plan.offsets[pos++] = k;
+      }
+    }
+  return 0;
+  }
+
+int MatrixBlock::ApplyValuePlan(Epetra_CrsMatrix const &source,
+  ValuePlan const &plan, Epetra_CrsMatrix &target)
+  {
+  int len, sourceLen;
+  int *indices, *sourceIndices;
+  double *values, *sourceValues;
+  int pos = 0;
+  for (int i = 0; i < target.NumMyRows(); i++)
+    {
+    CHECK_ZERO(target.ExtractMyRowView(i, len, values, indices));
+    CHECK_ZERO(source.ExtractMyRowView(plan.rows[i], sourceLen, sourceValues, sourceIndices));
+    for (int j = 0; j < len; j++)
+      values[j] = sourceValues[plan.offsets[pos++]];
+    }
   return 0;
   }
 
 int MatrixBlock::InitializeSubdomainSolvers(std::string const &solverType,
-  Teuchos::RCP<Teuchos::ParameterList> sd_list, int numThreads)
+  Teuchos::RCP<Teuchos::ParameterList> sd_list, int numThreads,
+  int denseCrossover, double denseFill)
   {
   HYMLS_LPROF2(label_, "InitializeSubdomainSolvers");
 
   HYMLS_DEBUG("initialize subdomain solvers...");
 
   numThreads_ = numThreads;
+  sdList_ = sd_list;
+  denseCrossover_ = denseCrossover;
+  denseFill_ = denseFill;
+  autoSolvers_ = solverType == "Auto";
 
   subdomainSolvers_.resize(hid_->NumMySubdomains());
 
   for (int sd = 0; sd < hid_->NumMySubdomains(); sd++)
     {
-    InteriorGroup const &group = hid_->GetInteriorGroup(sd);
-    const int nrows = group.length();
-
-    if (solverType == "Dense")
-      {
-      subdomainSolvers_[sd] =
-        Teuchos::rcp(new Ifpack_DenseContainer(nrows));
-      }
-    else if (solverType == "Sparse")
-      {
-      subdomainSolvers_[sd] =
-        Teuchos::rcp(new Ifpack_SparseContainer<SparseDirectSolver>(nrows));
-      }
-    else if (solverType == "Amesos")
-      {
-      subdomainSolvers_[sd] =
-        Teuchos::rcp(new Ifpack_SparseContainer<Ifpack_Amesos>(nrows));
-      }
+    // with "Auto" we need the matrix to choose the solver, so this is
+    // postponed until ComputeSubdomainSolvers
+    if (solverType == "Auto")
+      subdomainSolvers_[sd] = Teuchos::null;
     else
-      {
-      Tools::Error("invalid 'Subdomain Solver Type' in 'Solver' sublist",
-          __FILE__, __LINE__);
-      }
+      CHECK_ZERO(CreateSubdomainSolver(sd, solverType));
+    }
 
-      // copy parameter list
-      Teuchos::ParameterList tmp_sd_list = *sd_list;
+  return 0;
+  }
+
+int MatrixBlock::CreateSubdomainSolver(int sd, std::string const &solverType)
+  {
+  InteriorGroup const &group = hid_->GetInteriorGroup(sd);
+  const int nrows = group.length();
+
+  if (solverType == "Dense")
+    {
+    subdomainSolvers_[sd] =
+      Teuchos::rcp(new Ifpack_DenseContainer(nrows));
+    }
+  else if (solverType == "Sparse")
+    {
+    subdomainSolvers_[sd] =
+      Teuchos::rcp(new Ifpack_SparseContainer<SparseDirectSolver>(nrows));
+    }
+  else if (solverType == "Amesos")
+    {
+    subdomainSolvers_[sd] =
+      Teuchos::rcp(new Ifpack_SparseContainer<Ifpack_Amesos>(nrows));
+    }
+  else
+    {
+    Tools::Error("invalid 'Subdomain Solver Type' in 'Solver' sublist",
+        __FILE__, __LINE__);
+    }
+
+  // copy parameter list
+  Teuchos::ParameterList tmp_sd_list = *sdList_;
 
 #if HYMLS_TIMING_LEVEL>2
-      tmp_sd_list.set("Label", "direct solver (lev "+Teuchos::toString(myLevel_)+", sd "+Teuchos::toString(sd)+")");
+  tmp_sd_list.set("Label", "direct solver (lev "+Teuchos::toString(myLevel_)+", sd "+Teuchos::toString(sd)+")");
 #else
-      tmp_sd_list.set("Label", "direct solver (lev "+Teuchos::toString(myLevel_)+")");
+  tmp_sd_list.set("Label", "direct solver (lev "+Teuchos::toString(myLevel_)+")");
 #endif
-      IFPACK_CHK_ERR(subdomainSolvers_[sd]->SetParameters(tmp_sd_list));
+  IFPACK_CHK_ERR(subdomainSolvers_[sd]->SetParameters(tmp_sd_list));
 
 #ifdef HYMLS_TESTING
-    bool status = true;
-    try {
+  bool status = true;
+  try {
 #endif
-      subdomainSolvers_[sd]->Initialize();
+    subdomainSolvers_[sd]->Initialize();
 #ifdef HYMLS_TESTING
-      } TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, status);
-    if (!status)
-      {
-      Tools::Fatal("Caught an exception in subdomain solver init of sd="+
-        Teuchos::toString(sd)+" on partition "+Teuchos::toString(Comm().MyPID()),
-          __FILE__, __LINE__);
-      }
+    } TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, status);
+  if (!status)
+    {
+    Tools::Fatal("Caught an exception in subdomain solver init of sd="+
+      Teuchos::toString(sd)+" on partition "+Teuchos::toString(Comm().MyPID()),
+        __FILE__, __LINE__);
+    }
 #endif
-    Epetra_Map const &rowMap = hid_->OverlappingMap();
-    // set "global" ID of each partitioner row
-    int j = 0;
-    for (hymls_gidx gid: group.nodes())
+  // set "global" ID of each partitioner row, which is its local
+  // index in the overlapping map
+  Teuchos::ArrayView<const int> lids = hid_->OverlappingLIDs(group);
+  for (int j = 0; j < lids.size(); j++)
+    subdomainSolvers_[sd]->ID(j) = lids[j];
+
+  return 0;
+  }
+
+std::string MatrixBlock::ChooseSubdomainSolver(int sd,
+  Epetra_CrsMatrix const &extendedMatrix, Teuchos::Array<int> &marker) const
+  {
+  if (transposeNeeded_)
+    return "Sparse";
+
+  InteriorGroup const &group = hid_->GetInteriorGroup(sd);
+  const double n = group.length();
+  if (n <= denseCrossover_)
+    return "Dense";
+
+  // count the nonzeros that couple the interior nodes of the
+  // subdomain to each other
+  Epetra_Map const &rowMap = extendedMatrix.RowMap();
+  Epetra_Map const &colMap = extendedMatrix.ColMap();
+  Teuchos::ArrayView<const int> lids = hid_->OverlappingLIDs(group);
+  for (int lid: lids)
+    marker[lid] = sd;
+
+  int len;
+  int *indices;
+  double *values;
+  double nnz = 0.0;
+  for (int lid: lids)
+    {
+    CHECK_ZERO(extendedMatrix.ExtractMyRowView(lid, len, values, indices));
+    for (int j = 0; j < len; j++)
       {
-      const int LRID = rowMap.LID(gid);
-      subdomainSolvers_[sd]->ID(j++) = LRID;
+      const int col = rowMap.LID(colMap.GID64(indices[j]));
+      if (col >= 0 && marker[col] == sd)
+        nnz++;
       }
     }
 
-  return 0;
+  return nnz >= denseFill_ * n * n ? "Dense" : "Sparse";
   }
 
 int MatrixBlock::ComputeSubdomainSolvers(Teuchos::RCP<const Epetra_CrsMatrix> extendedMatrix)
@@ -213,8 +356,29 @@ int MatrixBlock::ComputeSubdomainSolvers(Teuchos::RCP<const Epetra_CrsMatrix> ex
 
   HYMLS_DEBUG("compute subdomain solvers...");
 
+  SetNumThreads();
+
+  Teuchos::Array<int> marker;
   for (int sd = 0; sd < hid_->NumMySubdomains(); sd++)
     {
+    // A border was added after the solvers were chosen
+    if (autoSolvers_ && transposeNeeded_ &&
+      Teuchos::rcp_dynamic_cast<Ifpack_DenseContainer>(
+        subdomainSolvers_[sd]) != Teuchos::null)
+      {
+      subdomainSolvers_[sd] = Teuchos::null;
+      }
+
+    if (subdomainSolvers_[sd] == Teuchos::null)
+      {
+      if (marker.size() == 0)
+        marker.resize(extendedMatrix->NumMyRows(), -1);
+      CHECK_ZERO(CreateSubdomainSolver(sd,
+          ChooseSubdomainSolver(sd, *extendedMatrix, marker)));
+      if (useTranspose_)
+        CHECK_ZERO(SetSubdomainUseTranspose(sd, useTranspose_));
+      }
+
     if (subdomainSolvers_[sd]->NumRows() > 0)
       {
       // Compute the subdomain factorization
@@ -291,6 +455,22 @@ int MatrixBlock::ComputeSubdomainSolvers(Teuchos::RCP<const Epetra_CrsMatrix> ex
   return 0;
   }
 
+void MatrixBlock::SetNumThreads() const
+  {
+  // Force threading for the subdomain solvers when possible. The
+  // number of threads may be different on every level, see the
+  // "Topology-Aware Threads" parameter of the Preconditioner.
+  if (numThreads_ > 0)
+    {
+#ifdef HYMLS_USE_MKL
+    mkl_set_num_threads(numThreads_);
+#endif
+#ifdef HYMLS_USE_OPENMP
+    omp_set_num_threads(numThreads_);
+#endif
+    }
+  }
+
 int MatrixBlock::Apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y)
   {
   HYMLS_LPROF3(label_, "Apply");
@@ -318,18 +498,7 @@ int MatrixBlock::ApplyInverse(const Epetra_MultiVector& B, Epetra_MultiVector& X
 
   HYMLS_LPROF3(label_, "ApplyInverse");
 
-  // Force threading for the subdomain solvers when possible
-  if (numThreads_ > 0)
-    {
-    //TODO - get #threads dynamically from processor topology
-    //      (see ProcTopo sketch above)
-#ifdef HYMLS_USE_MKL
-    mkl_set_num_threads(numThreads_);
-#endif
-#ifdef HYMLS_USE_OPENMP
-    omp_set_num_threads(numThreads_);
-#endif
-    }
+  SetNumThreads();
 
   // assume that all block solvers have the same number of vectors...
   if (subdomainSolvers_.size() > 0)
@@ -394,23 +563,32 @@ int MatrixBlock::SetUseTranspose(bool useTranspose)
     }
 
   // Set transpose for the subdomain solvers
-  Teuchos::RCP<const Ifpack_SparseContainer<SparseDirectSolver> > sparseLU = Teuchos::null;
-
   for (int sd = 0; sd < subdomainSolvers_.size(); sd++)
     {
-    sparseLU = Teuchos::rcp_dynamic_cast
+    // not created yet, see ComputeSubdomainSolvers
+    if (subdomainSolvers_[sd] == Teuchos::null)
+      continue;
+
+    CHECK_ZERO(SetSubdomainUseTranspose(sd, useTranspose));
+    }
+
+  return 0;
+  }
+
+int MatrixBlock::SetSubdomainUseTranspose(int sd, bool useTranspose)
+  {
+  Teuchos::RCP<const Ifpack_SparseContainer<SparseDirectSolver> > sparseLU =
+    Teuchos::rcp_dynamic_cast
       <const Ifpack_SparseContainer<SparseDirectSolver> >(subdomainSolvers_[sd]);
-    if (sparseLU != Teuchos::null)
-      {
-      CHECK_ZERO(Teuchos::rcp_const_cast<SparseDirectSolver>(
-          sparseLU->Inverse())->SetUseTranspose(useTranspose));
-      }
-    else
-      {
-      Tools::Error("Transpose not implemented for dense subdomain solver!",
-        __FILE__, __LINE__);
-      }
-    sparseLU = Teuchos::null;
+  if (sparseLU != Teuchos::null)
+    {
+    CHECK_ZERO(Teuchos::rcp_const_cast<SparseDirectSolver>(
+        sparseLU->Inverse())->SetUseTranspose(useTranspose));
+    }
+  else
+    {
+    Tools::Error("Transpose not implemented for dense subdomain solver!",
+      __FILE__, __LINE__);
     }
 
   return 0;
@@ -490,6 +668,41 @@ double MatrixBlock::ApplyInverseFlops() const
   return total;
   }
 
+void MatrixBlock::SubdomainNonzeros(double &nnzA, double &nnzL, double &nnzU) const
+  {
+  nnzA = 0.0;
+  nnzL = 0.0;
+  nnzU = 0.0;
+  for (int i = 0 ; i < subdomainSolvers_.size(); i++)
+    {
+    Teuchos::RCP<Ifpack_SparseContainer<SparseDirectSolver> > container =
+      Teuchos::rcp_dynamic_cast<Ifpack_SparseContainer<SparseDirectSolver> >(
+        subdomainSolvers_[i]);
+    if (container != Teuchos::null && container->IsComputed())
+      {
+      nnzA += container->Inverse()->NumGlobalNonzerosA();
+      nnzL += container->Inverse()->NumGlobalNonzerosL();
+      nnzU += container->Inverse()->NumGlobalNonzerosU();
+      }
+    }
+  }
+
+void MatrixBlock::SubdomainSolverCounts(int &numDense, int &numSparse) const
+  {
+  numDense = 0;
+  numSparse = 0;
+  for (int i = 0 ; i < subdomainSolvers_.size(); i++)
+    {
+    if (subdomainSolvers_[i] == Teuchos::null)
+      continue;
+    if (Teuchos::rcp_dynamic_cast<Ifpack_DenseContainer>(
+        subdomainSolvers_[i]) != Teuchos::null)
+      numDense++;
+    else
+      numSparse++;
+    }
+  }
+
 double MatrixBlock::ApplyFlops() const
   {
   return applyFlops_;
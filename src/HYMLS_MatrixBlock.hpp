@@ -49,9 +49,31 @@ public:
   int Compute(Teuchos::RCP<const Epetra_CrsMatrix> matrix,
   Teuchos::RCP<const Epetra_CrsMatrix> extendedMatrix);
 
-  //! Initialize the subdomain solvers for the A11 block
+  //! Copy new values from extendedMatrix into the block and the
+  //! subdomain blocks. The structure of extendedMatrix has to be the
+  //! same as in the last call to Compute(). This is a local operation
+  //! that does not create any matrices.
+  int RefreshValues(Epetra_CrsMatrix const &extendedMatrix);
+
+  //! Whether RefreshValues() can be used
+  bool HaveValuePlan() const {return haveValuePlan_;}
+
+  //! Number of calls to RefreshValues()
+  int NumRefreshValues() const {return numRefreshValues_;}
+
+  //! Hash of the structure of the local rows of a matrix (global row
+  //! and column indices, but not the values). If it did not change,
+  //! RefreshValues() can be used instead of Compute().
+  static unsigned long long StructureHash(Epetra_CrsMatrix const &A);
+
+  //! Initialize the subdomain solvers for the A11 block. With
+  //! solverType "Auto" the type of the solver is chosen per subdomain
+  //! in the first call to ComputeSubdomainSolvers(): a dense solver is
+  //! used for subdomains with at most denseCrossover rows or with a
+  //! density nnz/n^2 of at least denseFill, a sparse solver otherwise.
   int InitializeSubdomainSolvers(std::string const &solverType,
-  Teuchos::RCP<Teuchos::ParameterList>, int numThreads);
+  Teuchos::RCP<Teuchos::ParameterList>, int numThreads,
+  int denseCrossover = 0, double denseFill = 2.0);
 
   //! Compute the subdomain solvers for the A11 block
   int ComputeSubdomainSolvers(Teuchos::RCP<const Epetra_CrsMatrix> extendedMatrix);
@@ -65,6 +87,11 @@ public:
   //! Set whether we want to use transpose Apply and ApplyInverse
   int SetUseTranspose(bool useTranspose);
 
+  //! Tell ComputeSubdomainSolvers() that SetUseTranspose() will be used.
+  //! With "Auto" solvers only sparse solvers are chosen then, because
+  //! the dense solver can not apply the transpose.
+  void SetTransposeNeeded(bool transposeNeeded) {transposeNeeded_ = transposeNeeded;}
+
   //! Get the matrix block
   Teuchos::RCP<const Epetra_CrsMatrix> Block() const;
 
@@ -107,6 +134,15 @@ public:
   //! Get the amount of flops from the ApplyInverse method
   double ApplyInverseFlops() const;
 
+  //! Get the number of nonzeros in the subdomain matrices and their
+  //! L and U factors, summed over the local subdomains. Only the
+  //! sparse direct subdomain solvers contribute to this.
+  void SubdomainNonzeros(double &nnzA, double &nnzL, double &nnzU) const;
+
+  //! Get the number of local subdomains that use a dense and a
+  //! sparse solver
+  void SubdomainSolverCounts(int &numDense, int &numSparse) const;
+
 protected:
 
   //! Overlapping partitioner on which the blocks are based
@@ -148,6 +184,12 @@ protected:
   //! Bool to set whether we want to perform transpose operations or not
   bool useTranspose_;
 
+  //! Whether transpose operations will be performed, see SetTransposeNeeded()
+  bool transposeNeeded_;
+
+  //! Whether the subdomain solvers are chosen per subdomain ("Auto")
+  bool autoSolvers_;
+
   //! The amount of flops in Initialization
   double initializeFlops_;
 
@@ -165,6 +207,58 @@ protected:
 
   //! Level only used for debugging and timing
   int myLevel_;
+
+  //! Parameters for the subdomain solvers
+  Teuchos::RCP<Teuchos::ParameterList> sdList_;
+
+  //! Subdomains up to this size get a dense solver with "Auto" solvers
+  int denseCrossover_;
+
+  //! Subdomains with at least this density get a dense solver with
+  //! "Auto" solvers
+  double denseFill_;
+
+  //! Set the number of MKL/OpenMP threads for the subdomain solvers
+  void SetNumThreads() const;
+
+  //! Create and initialize the solver of subdomain sd
+  int CreateSubdomainSolver(int sd, std::string const &solverType);
+
+  //! Set whether the solver of subdomain sd applies the transpose
+  int SetSubdomainUseTranspose(int sd, bool useTranspose);
+
+  //! Choose "Dense" or "Sparse" for subdomain sd based on its size
+  //! and number of nonzeros in extendedMatrix. marker is workspace
+  //! of the size of the row map of extendedMatrix.
+  std::string ChooseSubdomainSolver(int sd,
+    Epetra_CrsMatrix const &extendedMatrix, Teuchos::Array<int> &marker) const;
+
+  //! For every local row of a matrix the local row in the extended
+  //! matrix, and for every nonzero its position in that row. This is
+  //! used to copy new values without communication or graph operations.
+  struct ValuePlan
+    {
+    Teuchos::Array<int> rows;
+    Teuchos::Array<int> offsets;
+    };
+
+  //! Value plans for the block and the subdomain blocks
+  ValuePlan blockPlan_;
+  Teuchos::Array<ValuePlan> subBlockPlans_;
+
+  //! Whether the value plans are valid
+  bool haveValuePlan_;
+
+  //! number of calls to RefreshValues()
+  int numRefreshValues_;
+
+  //! Create a value plan for copying values from source into target
+  static int CreateValuePlan(Epetra_CrsMatrix const &source,
+    Epetra_CrsMatrix const &target, ValuePlan &plan);
+
+  //! Copy the values from source into target using a value plan
+  static int ApplyValuePlan(Epetra_CrsMatrix const &source,
+    ValuePlan const &plan, Epetra_CrsMatrix &target);
   };
   }
 
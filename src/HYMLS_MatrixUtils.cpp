@@ -57,6 +57,16 @@ extern "C" void phist_Dmvec_random(void* v, int* iflag);
 #include "AnasaziEpetraAdapter.hpp"
 
 #include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// for memory mapping binary files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #if TRILINOS_MAJOR_MINOR_VERSION>=121200
 #include "trilinos_amd.h"
@@ -717,6 +727,357 @@ int MatrixUtils::mmread(std::string filename, Epetra_MultiVector& vec)
   return 0;
   }
 
+namespace
+  {
+//! header of the binary files written by MatrixUtils::binwrite
+struct BinaryHeader
+  {
+  char magic[8];
+  int64_t version;
+  int64_t numRows;
+  int64_t numCols;
+  int64_t numEntries;
+  int64_t indexBase;
+  int64_t reserved[2];
+  };
+
+const char binaryMatrixMagic[8] = {'H', 'Y', 'M', 'L', 'S', 'C', 'S', 'R'};
+const char binaryVectorMagic[8] = {'H', 'Y', 'M', 'L', 'S', 'V', 'E', 'C'};
+const int64_t binaryVersion = 1;
+
+//! read-only memory map of a file, which is unmapped on destruction
+class MappedFile
+  {
+public:
+  MappedFile(std::string const &filename)
+    :
+    data_(NULL),
+    size_(0)
+    {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      Tools::Error("could not open file '" + filename + "'", __FILE__, __LINE__);
+
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+      size_ = st.st_size;
+
+    if (size_ > 0)
+      {
+      void *data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+        data_ = (char *)data;
+      }
+    close(fd);
+
+    if (data_ == NULL)
+      Tools::Error("could not map file '" + filename + "'", __FILE__, __LINE__);
+    }
+
+  ~MappedFile()
+    {
+    munmap(data_, size_);
+    }
+
+  char const *Data() const {return data_;}
+
+  size_t Size() const {return size_;}
+
+private:
+  char *data_;
+
+  size_t size_;
+  };
+
+//! check the header and size of a binary file
+BinaryHeader const &CheckBinaryHeader(MappedFile const &file,
+  char const *magic, std::string const &filename)
+  {
+  BinaryHeader const &header = *(BinaryHeader const *)file.Data();
+  if (file.Size() < sizeof(BinaryHeader) ||
+    std::memcmp(header.magic, magic, 8) != 0)
+    {
+    Tools::Error("'" + filename + "' is not a HYMLS binary file of the right type",
+      __FILE__, __LINE__);
+    }
+  if (header.version != binaryVersion)
+    {
+    Tools::Error("'" + filename + "' has an unsupported version "
+      + Teuchos::toString(header.version), __FILE__, __LINE__);
+    }
+  return header;
+  }
+
+//! Writes data of length bytes at offset in a file. The processes take
+//! turns so no two processes write to the file at the same time. The
+//! first process truncates the file and also writes the header.
+void WriteBinaryParts(std::string const &filename, Epetra_Comm const &comm,
+  BinaryHeader const &header,
+  std::vector<std::pair<int64_t, std::string> > const &parts)
+  {
+  for (int pid = 0; pid < comm.NumProc(); pid++)
+    {
+    if (pid == comm.MyPID())
+      {
+      std::ios_base::openmode mode = std::ios::out | std::ios::binary;
+      if (pid > 0)
+        mode |= std::ios::in;
+
+      std::fstream fs(filename.c_str(), mode);
+      if (!fs)
+        Tools::Error("could not open file '" + filename + "'", __FILE__, __LINE__);
+
+      if (pid == 0)
+        fs.write((char const *)&header, sizeof(BinaryHeader));
+
+      for (auto const &part: parts)
+        {
+        fs.seekp(part.first);
+        fs.write(part.second.data(), part.second.size());
+        }
+
+      if (!fs)
+        Tools::Error("error writing file '" + filename + "'", __FILE__, __LINE__);
+      }
+    comm.Barrier();
+    }
+  }
+
+//! check that the GIDs of a map are 0..n-1 plus the index base
+void CheckConsecutiveGIDs(Epetra_BlockMap const &map)
+  {
+  if (map.MaxAllGID64() - map.MinAllGID64() + 1 != map.NumGlobalElements64())
+    {
+    Tools::Error("binary files can only be written for consecutive GIDs",
+      __FILE__, __LINE__);
+    }
+  }
+
+//! position of the first row of this process in a linear map
+long long FirstRow(Epetra_BlockMap const &linearMap)
+  {
+  long long numMyRows = linearMap.NumMyElements();
+  long long firstRow = 0;
+  CHECK_ZERO(linearMap.Comm().ScanSum(&numMyRows, &firstRow, 1));
+  return firstRow - numMyRows;
+  }
+
+template<typename T>
+std::string ToBytes(std::vector<T> const &v)
+  {
+  return std::string((char const *)v.data(), v.size() * sizeof(T));
+  }
+
+  }
+
+// Binary output of CrsMatrix.
+int MatrixUtils::binwrite(std::string filename, const Epetra_CrsMatrix& A)
+  {
+  HYMLS_PROF2(Label(), "binwrite (matrix)");
+
+  const Epetra_Map& map = A.RowMap();
+  CheckConsecutiveGIDs(map);
+
+  // Move the rows to a linear map so every process writes a
+  // contiguous block of rows (see also mmwrite)
+  hymls_gidx base = map.MinAllGID64();
+  Epetra_Map linearMap((hymls_gidx)map.NumGlobalElements64(), map.NumMyElements(),
+    base, A.Comm());
+  Epetra_Import import(linearMap, map);
+  Epetra_CrsMatrix linearA(Copy, linearMap, 0);
+  CHECK_ZERO(linearA.Import(A, import, Insert));
+  CHECK_ZERO(linearA.FillComplete(A.DomainMap(), A.RangeMap()));
+
+  long long myEntries = linearA.NumMyNonzeros();
+  long long entryOffset = 0;
+  long long numEntries = 0;
+  CHECK_ZERO(A.Comm().ScanSum(&myEntries, &entryOffset, 1));
+  CHECK_ZERO(A.Comm().SumAll(&myEntries, &numEntries, 1));
+  entryOffset -= myEntries;
+
+  int numMyRows = linearA.NumMyRows();
+  std::vector<int64_t> rowPointers;
+  std::vector<int64_t> cols;
+  std::vector<double> values;
+  rowPointers.reserve(numMyRows + 1);
+  cols.reserve(myEntries);
+  values.reserve(myEntries);
+
+  for (int i = 0; i < numMyRows; i++)
+    {
+    rowPointers.push_back(entryOffset + cols.size());
+
+    int len;
+    int *indices;
+    double *rowValues;
+    CHECK_ZERO(linearA.ExtractMyRowView(i, len, rowValues, indices));
+    for (int j = 0; j < len; j++)
+      {
+      cols.push_back(linearA.ColMap().GID64(indices[j]) - base);
+      values.push_back(rowValues[j]);
+      }
+    }
+
+  BinaryHeader header;
+  std::memcpy(header.magic, binaryMatrixMagic, 8);
+  header.version = binaryVersion;
+  header.numRows = map.NumGlobalElements64();
+  header.numCols = A.DomainMap().NumGlobalElements64();
+  header.numEntries = numEntries;
+  header.indexBase = base;
+  header.reserved[0] = 0;
+  header.reserved[1] = 0;
+
+  // the last process also writes the end of the last row
+  if (A.Comm().MyPID() == A.Comm().NumProc() - 1)
+    rowPointers.push_back(numEntries);
+
+  long long firstRow = FirstRow(linearMap);
+  int64_t rowPointerStart = sizeof(BinaryHeader);
+  int64_t colStart = rowPointerStart + (header.numRows + 1) * sizeof(int64_t);
+  int64_t valueStart = colStart + numEntries * sizeof(int64_t);
+
+  std::vector<std::pair<int64_t, std::string> > parts;
+  parts.push_back(std::make_pair(rowPointerStart + firstRow * (int64_t)sizeof(int64_t),
+      ToBytes(rowPointers)));
+  parts.push_back(std::make_pair(colStart + entryOffset * (int64_t)sizeof(int64_t),
+      ToBytes(cols)));
+  parts.push_back(std::make_pair(valueStart + entryOffset * (int64_t)sizeof(double),
+      ToBytes(values)));
+
+  WriteBinaryParts(filename, A.Comm(), header, parts);
+
+  return 0;
+  }
+
+// Binary input of CrsMatrix.
+Teuchos::RCP<Epetra_CrsMatrix> MatrixUtils::binread(std::string filename,
+  const Epetra_Map& map)
+  {
+  HYMLS_PROF2(Label(), "binread (matrix)");
+
+  MappedFile file(filename);
+  BinaryHeader const &header = CheckBinaryHeader(file, binaryMatrixMagic, filename);
+
+  int64_t numRows = header.numRows;
+  int64_t numEntries = header.numEntries;
+  if (numRows != map.NumGlobalElements64() || header.numCols != numRows)
+    {
+    Tools::Error("matrix in '" + filename + "' does not fit the map",
+      __FILE__, __LINE__);
+    }
+
+  int64_t const *rowPointers = (int64_t const *)(file.Data() + sizeof(BinaryHeader));
+  int64_t const *cols = rowPointers + numRows + 1;
+  double const *values = (double const *)(cols + numEntries);
+  if ((char const *)(values + numEntries) > file.Data() + file.Size())
+    {
+    Tools::Error("'" + filename + "' is truncated", __FILE__, __LINE__);
+    }
+
+  hymls_gidx base = map.MinAllGID64();
+
+  // Only the pages containing our own rows are actually read
+  int numMyRows = map.NumMyElements();
+  std::vector<int> numEntriesPerRow(numMyRows);
+  for (int i = 0; i < numMyRows; i++)
+    {
+    int64_t row = map.GID64(i) - base;
+    numEntriesPerRow[i] = rowPointers[row + 1] - rowPointers[row];
+    }
+
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(new Epetra_CrsMatrix(Copy, map,
+      numEntriesPerRow.data(), true));
+
+  std::vector<hymls_gidx> indices;
+  for (int i = 0; i < numMyRows; i++)
+    {
+    hymls_gidx gid = map.GID64(i);
+    int64_t begin = rowPointers[gid - base];
+    int len = numEntriesPerRow[i];
+
+    indices.resize(len);
+    for (int j = 0; j < len; j++)
+      indices[j] = (hymls_gidx)(cols[begin + j] + base);
+
+    CHECK_ZERO(A->InsertGlobalValues(gid, len, values + begin, indices.data()));
+    }
+  CHECK_ZERO(A->FillComplete());
+
+  return A;
+  }
+
+// Binary output of MultiVector.
+int MatrixUtils::binwrite(std::string filename, const Epetra_MultiVector& vec)
+  {
+  HYMLS_PROF2(Label(), "binwrite (vector)");
+
+  const Epetra_BlockMap& map = vec.Map();
+  CheckConsecutiveGIDs(map);
+
+  hymls_gidx base = map.MinAllGID64();
+  Epetra_Map linearMap((hymls_gidx)map.NumGlobalElements64(), map.NumMyElements(),
+    base, vec.Comm());
+  Epetra_Import import(linearMap, map);
+  Epetra_MultiVector linearVec(linearMap, vec.NumVectors());
+  CHECK_ZERO(linearVec.Import(vec, import, Insert));
+
+  BinaryHeader header;
+  std::memcpy(header.magic, binaryVectorMagic, 8);
+  header.version = binaryVersion;
+  header.numRows = map.NumGlobalElements64();
+  header.numCols = vec.NumVectors();
+  header.numEntries = header.numRows * header.numCols;
+  header.indexBase = base;
+  header.reserved[0] = 0;
+  header.reserved[1] = 0;
+
+  long long firstRow = FirstRow(linearMap);
+
+  // the vectors are stored one after the other
+  std::vector<std::pair<int64_t, std::string> > parts;
+  for (int k = 0; k < vec.NumVectors(); k++)
+    {
+    std::vector<double> values(linearVec[k], linearVec[k] + linearVec.MyLength());
+    parts.push_back(std::make_pair(sizeof(BinaryHeader) +
+        (k * header.numRows + firstRow) * (int64_t)sizeof(double), ToBytes(values)));
+    }
+
+  WriteBinaryParts(filename, vec.Comm(), header, parts);
+
+  return 0;
+  }
+
+// Binary input of MultiVector.
+int MatrixUtils::binread(std::string filename, Epetra_MultiVector& vec)
+  {
+  HYMLS_PROF2(Label(), "binread (vector)");
+
+  MappedFile file(filename);
+  BinaryHeader const &header = CheckBinaryHeader(file, binaryVectorMagic, filename);
+
+  const Epetra_BlockMap& map = vec.Map();
+  int64_t numRows = header.numRows;
+  if (numRows != map.NumGlobalElements64() || header.numCols != vec.NumVectors())
+    {
+    Tools::Error("vector in '" + filename + "' does not fit the map",
+      __FILE__, __LINE__);
+    }
+
+  double const *values = (double const *)(file.Data() + sizeof(BinaryHeader));
+  if ((char const *)(values + numRows * header.numCols) > file.Data() + file.Size())
+    {
+    Tools::Error("'" + filename + "' is truncated", __FILE__, __LINE__);
+    }
+
+  hymls_gidx base = map.MinAllGID64();
+  for (int k = 0; k < vec.NumVectors(); k++)
+    for (int i = 0; i < vec.MyLength(); i++)
+      vec[k][i] = values[k * numRows + map.GID64(i) - base];
+
+  return 0;
+  }
+
 void MatrixUtils::DumpHDF(const Epetra_MultiVector& x,
   const std::string& filename,
   const std::string& groupname,
@@ -810,7 +1171,8 @@ Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > MatrixUtils::E
   Teuchos::RCP<const Epetra_Operator> A,
   Teuchos::RCP<const Epetra_Operator> B,
   int howMany,
-  double tol)
+  double tol,
+  Teuchos::RCP<const Epetra_MultiVector> initVec)
   {
   HYMLS_PROF2(Label(), "Eigs");
 
@@ -875,10 +1237,22 @@ Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > MatrixUtils::E
 
   // Create an Epetra_MultiVector for an initial vector to start the solver.
   // Note:  This needs to have the same number of columns as the blocksize.
-  HYMLS_DEBUG("create random starting vector for Anasazi");
   Teuchos::RCP<Epetra_MultiVector> ivec =
     Teuchos::rcp( new Epetra_MultiVector(A->OperatorRangeMap(), blockSize) );
-  MatrixUtils::Random(*ivec);
+  if (!Teuchos::is_null(initVec) && initVec->NumVectors() > 0)
+    {
+    // Start from a combination of the given vectors, which are for
+    // instance eigenvectors of a previous, slightly different problem
+    HYMLS_DEBUG("create starting vector for Anasazi from initVec");
+    for (int j = 0; j < initVec->NumVectors(); j++)
+      for (int k = 0; k < blockSize; k++)
+        CHECK_ZERO((*ivec)(k)->Update(1.0, *(*initVec)(j), 1.0));
+    }
+  else
+    {
+    HYMLS_DEBUG("create random starting vector for Anasazi");
+    MatrixUtils::Random(*ivec);
+    }
 
   Epetra_MultiVector tmp = *ivec;
   if (!Teuchos::is_null(B))
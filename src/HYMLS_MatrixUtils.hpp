@@ -170,6 +170,26 @@ class MatrixUtils
     //! MatrixMarket input of MultiVector.
     static int mmread(std::string filename, Epetra_MultiVector& vec);
 
+    //! Binary output of a CrsMatrix. The file contains a header, the    
+    //! row pointers, the global column indices and the values of all    
+    //! rows in order of ascending GID, as 64 bit integers and doubles   
+    //! in the byte order of the machine. This requires the row GIDs to  
+    //! be consecutive. All processes write their own rows to the file.  
+    static int binwrite(std::string filename, const Epetra_CrsMatrix& A);
+
+    //! Binary input of a CrsMatrix written by binwrite. The file is      
+    //! memory mapped by every process, which only reads the rows in map. 
+    //! The matrix is returned with map as its row, domain and range map. 
+    static Teuchos::RCP<Epetra_CrsMatrix> binread(std::string filename,
+      const Epetra_Map& map);
+
+    //! Binary output of a MultiVector, see the CrsMatrix version.
+    static int binwrite(std::string filename, const Epetra_MultiVector& vec);
+
+    //! Binary input of a MultiVector written by binwrite. Only the       
+    //! entries in the map of vec are read.                               
+    static int binread(std::string filename, Epetra_MultiVector& vec);
+
     //! compute a number of eigenvalues and eigenvectors of the sparse
     //! matrix pencil [A,B]. The most dominant eigs are found, so if  
     //! you want e.g. those of smallest magnitude, you have to supply 
@@ -185,11 +205,15 @@ class MatrixUtils
     //!                                                               
     //! The eigenvectors returned are the right eigenvectors of [A,B].
     //!                                                               
+    //! If initVec is given, the sum of its columns is used as the    
+    //! starting vector instead of a random vector.                   
+    //!                                                               
     static Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > Eigs(
                 Teuchos::RCP<const Epetra_Operator> A, 
                 Teuchos::RCP<const Epetra_Operator> B, 
                 int howMany=6,
-                double tol=1.0e-6);
+                double tol=1.0e-6,
+                Teuchos::RCP<const Epetra_MultiVector> initVec=Teuchos::null);
 
     //! this is for creating consistent random vectors. Normally, if you change the number 
     //! of procs and use the same seed in a v.Random() call, the vector is different. 
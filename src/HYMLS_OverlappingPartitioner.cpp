@@ -5,22 +5,45 @@
 #include "HYMLS_Tools.hpp"
 #include "HYMLS_BasePartitioner.hpp"
 #include "HYMLS_Macros.hpp"
+#include "HYMLS_CacheIO.hpp"
 
 #include "HYMLS_InteriorGroup.hpp"
 #include "HYMLS_SeparatorGroup.hpp"
 #include "HYMLS_CartesianPartitioner.hpp"
 #include "HYMLS_SkewCartesianPartitioner.hpp"
+#include "HYMLS_GraphPartitioner.hpp"
+
+#include "Epetra_Comm.h"
+#include "Epetra_Map.h"
+#include "Epetra_Vector.h"
+#include "Epetra_Import.h"
+#include "Epetra_FECrsGraph.h"
 
 #include "Teuchos_ParameterList.hpp"
 #include "Teuchos_Array.hpp"
 #include "Teuchos_toString.hpp"
 
 #include <algorithm>
-
-class Epetra_Map;
+#include <fstream>
+#include <sstream>
 
 namespace HYMLS {
 
+namespace {
+
+void CacheWrite(std::ostream &os, GroupNodes const &nodes)
+  {
+  long long n = nodes.size();
+  HYMLS::CacheWrite(os, n);
+  if (n > 0)
+    os.write(reinterpret_cast<const char *>(nodes.begin()), n * sizeof(hymls_gidx));
+  }
+
+const char cacheMagic[8] = {'H', 'Y', 'M', 'L', 'S', 'H', 'I', 'D'};
+const int cacheVersion = 1;
+
+  }
+
 //constructor
 
 // we call the base class constructor with a lot of null-pointers and create the
@@ -31,15 +54,39 @@ namespace HYMLS {
 OverlappingPartitioner::OverlappingPartitioner(
   Teuchos::RCP<const Epetra_Map> map,
   Teuchos::RCP<Teuchos::ParameterList> params, int level,
-  Teuchos::RCP<const Epetra_Map> overlappingMap)
+  Teuchos::RCP<const Epetra_Map> overlappingMap,
+  Teuchos::RCP<const Epetra_CrsGraph> graph,
+  Teuchos::RCP<const Epetra_Vector> weights)
   :
   HierarchicalMap(map, overlappingMap, 0, "OverlappingPartitioner", level),
-  PLA("Problem")
+  PLA("Problem"),
+  graph_(graph),
+  weights_(weights),
+  cacheRead_(false)
   {
   HYMLS_PROF2(Label(),"Constructor");
 
   setParameterList(params);
 
+  if (weights_ == Teuchos::null && weightingMethod_ != "None")
+    weights_ = CreateWeights();
+
+  // The partitioning only depends on the input, so if it was
+  // stored before we can skip it entirely.
+  unsigned long long cacheKey = 0;
+  if (!cacheFile_.empty())
+    {
+    cacheKey = CacheKey();
+    if (ReadCache(cacheKey) == 0)
+      {
+      cacheRead_ = true;
+      Tools::Out("Partitioning of level " + Teuchos::toString(myLevel_) +
+        " read from " + cacheFile_);
+      HYMLS_DEBVAR(*this);
+      return;
+      }
+    }
+
   Teuchos::RCP<const BasePartitioner> partitioner = Partition();
 
   // Set the parameters for the next level
@@ -73,6 +120,10 @@ OverlappingPartitioner::OverlappingPartitioner(
   Reset(partitioner->NumLocalParts());
 
   CHECK_ZERO(DetectSeparators(partitioner));
+
+  if (!cacheFile_.empty())
+    CHECK_ZERO(WriteCache(cacheKey));
+
   HYMLS_DEBVAR(*this);
   return;
   }
@@ -91,11 +142,29 @@ void OverlappingPartitioner::setParameterList(
 
   partitioningMethod_ = PL("Preconditioner").get(
       "Partitioner", "Cartesian");
+
+  weightingMethod_ = PL("Preconditioner").get(
+      "Partitioner Weights", "None");
+
+  cacheFile_ = PL("Preconditioner").get(
+      "Partition Cache", "");
   }
 
 Teuchos::RCP<const BasePartitioner> OverlappingPartitioner::Partition()
   {
   HYMLS_PROF2(Label(), "Partition");
+
+  Teuchos::RCP<BasePartitioner> partitioner = CreatePartitioner();
+
+  partitioner->SetWeights(weights_);
+
+  CHECK_ZERO(partitioner->Partition(false));
+
+  return partitioner;
+  }
+
+Teuchos::RCP<BasePartitioner> OverlappingPartitioner::CreatePartitioner()
+  {
   Teuchos::RCP<BasePartitioner> partitioner = Teuchos::null;
   if (partitioningMethod_ == "Cartesian")
     {
@@ -107,14 +176,17 @@ Teuchos::RCP<const BasePartitioner> OverlappingPartitioner::Partition()
     partitioner = Teuchos::rcp(new
       SkewCartesianPartitioner(GetMap(), getMyNonconstParamList(), Comm(), myLevel_));
     }
+  else if (partitioningMethod_ == "Graph")
+    {
+    partitioner = Teuchos::rcp(new
+      GraphPartitioner(GetMap(), graph_, getMyNonconstParamList(), Comm(), myLevel_));
+    }
   else
     {
-    Tools::Error("Up to now we only support Cartesian partitioning",
+    Tools::Error("Partitioner '" + partitioningMethod_ + "' not recognized",
       __FILE__, __LINE__);
     }
 
-  CHECK_ZERO(partitioner->Partition(false));
-
   return partitioner;
   }
 
@@ -152,11 +224,344 @@ Teuchos::RCP<const OverlappingPartitioner> OverlappingPartitioner::SpawnNextLeve
   {
   HYMLS_PROF2(Label(), "SpawnNextLevel");
 
+  Teuchos::RCP<const Epetra_CrsGraph> graph = Teuchos::null;
+  if (partitioningMethod_ == "Graph")
+    graph = CreateNextLevelGraph(map, overlappingMap);
+
+  // The nodes of the next level keep the cost they have on this level
+  Teuchos::RCP<Epetra_Vector> weights = Teuchos::null;
+  if (weights_ != Teuchos::null)
+    {
+    weights = Teuchos::rcp(new Epetra_Vector(*map));
+    Epetra_Import import(*map, weights_->Map());
+    CHECK_ZERO(weights->Import(*weights_, import, Insert));
+    }
+
   Teuchos::RCP<const OverlappingPartitioner> newLevel;
   newLevel = Teuchos::rcp(new OverlappingPartitioner(
-      map, nextLevelParams_, Level()+1, overlappingMap));
+      map, nextLevelParams_, Level()+1, overlappingMap, graph, weights));
   return newLevel;
   }
 
+Teuchos::RCP<const OverlappingPartitioner> OverlappingPartitioner::SpawnRestrictedNextLevel(
+  Teuchos::RCP<const Epetra_Map> map,
+  Teuchos::RCP<const Epetra_Map> restrictedMap) const
+  {
+  HYMLS_PROF2(Label(), "SpawnRestrictedNextLevel");
+
+  if (partitioningMethod_ == "Graph")
+    Tools::Error("the Graph partitioner does not support agglomeration",
+      __FILE__, __LINE__);
+
+  // The weights are imported on the full communicator
+  Teuchos::RCP<Epetra_Vector> weights = Teuchos::null;
+  if (weights_ != Teuchos::null)
+    {
+    weights = Teuchos::rcp(new Epetra_Vector(*map));
+    Epetra_Import import(*map, weights_->Map());
+    CHECK_ZERO(weights->Import(*weights_, import, Insert));
+    }
+
+  if (restrictedMap == Teuchos::null)
+    return Teuchos::null;
+
+  Teuchos::RCP<Epetra_Vector> restrictedWeights = Teuchos::null;
+  if (weights != Teuchos::null)
+    restrictedWeights = Teuchos::rcp(new Epetra_Vector(Copy, *restrictedMap,
+        weights->Values()));
+
+  Teuchos::RCP<const OverlappingPartitioner> newLevel;
+  newLevel = Teuchos::rcp(new OverlappingPartitioner(
+      restrictedMap, nextLevelParams_, Level()+1, Teuchos::null,
+      Teuchos::null, restrictedWeights));
+  return newLevel;
+  }
+
+Teuchos::RCP<const Epetra_Vector> OverlappingPartitioner::CreateWeights() const
+  {
+  HYMLS_PROF2(Label(), "CreateWeights");
+
+  if (graph_ == Teuchos::null)
+    {
+    Tools::Warning("Partitioner Weights require the graph of the matrix, "
+      "they are ignored", __FILE__, __LINE__);
+    return Teuchos::null;
+    }
+
+  Teuchos::RCP<Epetra_Vector> weights = Teuchos::rcp(
+    new Epetra_Vector(graph_->RowMap()));
+  for (int lid = 0; lid < graph_->NumMyRows(); lid++)
+    {
+    int len = graph_->NumMyIndices(lid);
+    if (weightingMethod_ == "Nonzeros")
+      (*weights)[lid] = len;
+    else if (weightingMethod_ == "Active")
+      // rows with only a diagonal entry are inactive (e.g. land cells)
+      (*weights)[lid] = len > 1 ? 1.0 : 0.0;
+    else
+      Tools::Error("Partitioner Weights '" + weightingMethod_ + "' not recognized",
+        __FILE__, __LINE__);
+    }
+  return weights;
+  }
+
+Teuchos::RCP<const Epetra_CrsGraph> OverlappingPartitioner::CreateNextLevelGraph(
+  Teuchos::RCP<const Epetra_Map> map,
+  Teuchos::RCP<const Epetra_Map> overlappingMap) const
+  {
+  HYMLS_PROF2(Label(), "CreateNextLevelGraph");
+
+  if (overlappingMap == Teuchos::null)
+    overlappingMap = map;
+
+  // The reduced Schur complement couples all retained separator
+  // nodes around a subdomain
+  Teuchos::RCP<Epetra_FECrsGraph> graph = Teuchos::rcp(
+    new Epetra_FECrsGraph(Copy, *map, 0));
+
+  for (int sd = 0; sd < NumMySubdomains(); sd++)
+    {
+    Teuchos::Array<hymls_gidx> gids;
+    for (SeparatorGroup const &group: GetSeparatorGroups(sd))
+      for (hymls_gidx gid: group.nodes())
+        if (overlappingMap->MyGID(gid))
+          gids.append(gid);
+
+    for (hymls_gidx gid: gids)
+      CHECK_NONNEG(graph->InsertGlobalIndices(1, &gid, gids.size(), gids.getRawPtr()));
+    }
+
+  CHECK_ZERO(graph->GlobalAssemble());
+
+  return graph;
+  }
+
+std::string OverlappingPartitioner::CacheFileName() const
+  {
+  return cacheFile_ + "." + Teuchos::toString(myLevel_) + "." +
+    Teuchos::toString(Comm().MyPID()) + ".partition.bin";
+  }
+
+unsigned long long OverlappingPartitioner::CacheKey() const
+  {
+  HYMLS_PROF3(Label(), "CacheKey");
+
+  unsigned long long key = cacheHashInit;
+
+  int header[4] = {myLevel_, Comm().NumProc(), Comm().MyPID(),
+                   (int)sizeof(hymls_gidx)};
+  key = CacheHash(key, header, sizeof(header));
+
+  // All parameters, without the used/default flags that change
+  // when they are accessed
+  std::ostringstream ss;
+  getMyParamList()->print(ss, Teuchos::ParameterList::PrintOptions().showFlags(false));
+  std::string str = ss.str();
+  key = CacheHash(key, str.c_str(), str.size());
+
+  Teuchos::Array<hymls_gidx> gids = MyGIDs(*baseMap_);
+  key = CacheHash(key, gids.getRawPtr(), gids.size() * sizeof(hymls_gidx));
+
+  if (baseOverlappingMap_ != Teuchos::null)
+    {
+    gids = MyGIDs(*baseOverlappingMap_);
+    key = CacheHash(key, gids.getRawPtr(), gids.size() * sizeof(hymls_gidx));
+    }
+
+  // The graph partitioner and the weights depend on the sparsity
+  // pattern, and the weights may also be given directly (e.g. a land
+  // mask)
+  if (graph_ != Teuchos::null)
+    key = CacheHash(key, *graph_);
+
+  if (weights_ != Teuchos::null)
+    {
+    gids = MyGIDs(weights_->Map());
+    key = CacheHash(key, gids.getRawPtr(), gids.size() * sizeof(hymls_gidx));
+    if (weights_->MyLength() > 0)
+      key = CacheHash(key, weights_->Values(), weights_->MyLength() * sizeof(double));
+    }
+
+  return key;
+  }
+
+int OverlappingPartitioner::ReadCache(unsigned long long key)
+  {
+  HYMLS_PROF2(Label(), "ReadCache");
+
+  Teuchos::Array<hymls_gidx> mapGIDs;
+  Teuchos::Array<hymls_gidx> overlappingMapGIDs;
+  int hasOverlappingMap = 0;
+  Teuchos::Array<InteriorGroup> interior_groups;
+  Teuchos::Array<Teuchos::Array<SeparatorGroup> > separator_groups;
+  Teuchos::Array<std::string> paramNames;
+  Teuchos::Array<int> paramValues;
+
+  std::ifstream is(CacheFileName().c_str(), std::ios::binary);
+
+  bool success = is.good();
+
+  char magic[8];
+  int version;
+  unsigned long long fileKey;
+  success = success && CacheRead(is, magic) &&
+    std::equal(magic, magic + 8, cacheMagic) &&
+    CacheRead(is, version) && version == cacheVersion &&
+    CacheRead(is, fileKey) && fileKey == key;
+
+  success = success && CacheRead(is, mapGIDs) &&
+    CacheRead(is, hasOverlappingMap) && CacheRead(is, overlappingMapGIDs);
+
+  int numSubdomains = 0;
+  success = success && CacheRead(is, numSubdomains) && numSubdomains >= 0;
+  if (success)
+    {
+    interior_groups.resize(numSubdomains);
+    separator_groups.resize(numSubdomains);
+    }
+  for (int sd = 0; success && sd < numSubdomains; sd++)
+    {
+    // groups share their nodes when copied, so we need new ones
+    InteriorGroup interior_group;
+    int numGroups = 0;
+    success = CacheRead(is, interior_group.nodes()) &&
+      CacheRead(is, numGroups) && numGroups >= 0;
+    interior_groups[sd] = interior_group;
+    for (int i = 0; success && i < numGroups; i++)
+      {
+      int type;
+      SeparatorGroup group;
+      success = CacheRead(is, type) && CacheRead(is, group.nodes());
+      group.set_type(type);
+      separator_groups[sd].append(group);
+      }
+    }
+
+  int numParams = 0;
+  success = success && CacheRead(is, numParams) && numParams >= 0;
+  for (int i = 0; success && i < numParams; i++)
+    {
+    std::string name;
+    int value;
+    success = CacheRead(is, name) && CacheRead(is, value);
+    paramNames.append(name);
+    paramValues.append(value);
+    }
+
+  // Everyone has to be able to read the cache, otherwise we
+  // partition as usual.
+  int mySuccess = success;
+  int allSuccess = 0;
+  CHECK_ZERO(Comm().MinAll(&mySuccess, &allSuccess, 1));
+  if (!allSuccess)
+    {
+    Tools::Out("No valid partitioning cache for level " + Teuchos::toString(myLevel_));
+    return 1;
+    }
+
+  // The partitioner sets default values in the parameter list that
+  // are used later on, so we still have to create it, but we do
+  // not need to partition.
+  CreatePartitioner();
+
+  nextLevelParams_ = Teuchos::rcp(new Teuchos::ParameterList(*getMyParamList()));
+  for (int i = 0; i < paramNames.size(); i++)
+    nextLevelParams_->sublist("Preconditioner").set(paramNames[i], paramValues[i]);
+
+  HYMLS_DEBVAR(*nextLevelParams_);
+
+  baseMap_ = Teuchos::rcp(new Epetra_Map((hymls_gidx)(-1), mapGIDs.size(),
+      mapGIDs.getRawPtr(), (hymls_gidx)baseMap_->IndexBase64(), Comm()));
+
+  baseOverlappingMap_ = Teuchos::null;
+  if (hasOverlappingMap)
+    baseOverlappingMap_ = Teuchos::rcp(new Epetra_Map((hymls_gidx)(-1),
+        overlappingMapGIDs.size(), overlappingMapGIDs.getRawPtr(),
+        (hymls_gidx)baseMap_->IndexBase64(), Comm()));
+
+  Reset(numSubdomains);
+
+  for (int sd = 0; sd < numSubdomains; sd++)
+    {
+    AddInteriorGroup(sd, interior_groups[sd]);
+    for (SeparatorGroup const &group: separator_groups[sd])
+      AddSeparatorGroup(sd, group);
+    }
+
+  CHECK_ZERO(FillComplete());
+
+  return 0;
+  }
+
+int OverlappingPartitioner::WriteCache(unsigned long long key) const
+  {
+  HYMLS_PROF2(Label(), "WriteCache");
+
+  std::ofstream os(CacheFileName().c_str(), std::ios::binary | std::ios::trunc);
+  if (!os.good())
+    {
+    Tools::Warning("Could not open " + CacheFileName() + " for writing",
+      __FILE__, __LINE__);
+    return 0;
+    }
+
+  CacheWrite(os, cacheMagic);
+  CacheWrite(os, cacheVersion);
+  CacheWrite(os, key);
+
+  CacheWrite(os, MyGIDs(*baseMap_));
+
+  int hasOverlappingMap = baseOverlappingMap_ != Teuchos::null;
+  CacheWrite(os, hasOverlappingMap);
+  CacheWrite(os, hasOverlappingMap ? MyGIDs(*baseOverlappingMap_)
+    : Teuchos::Array<hymls_gidx>());
+
+  int numSubdomains = NumMySubdomains();
+  CacheWrite(os, numSubdomains);
+  for (int sd = 0; sd < numSubdomains; sd++)
+    {
+    CacheWrite(os, GetInteriorGroup(sd).nodes());
+    int numGroups = NumSeparatorGroups(sd);
+    CacheWrite(os, numGroups);
+    for (SeparatorGroup const &group: GetSeparatorGroups(sd))
+      {
+      CacheWrite(os, group.type());
+      CacheWrite(os, group.nodes());
+      }
+    }
+
+  // The partitioner only changes integer parameters for the next
+  // level, like the separator length, so we store those
+  Teuchos::ParameterList const &precList = PL("Preconditioner");
+  Teuchos::ParameterList const &nextPrecList = nextLevelParams_->sublist("Preconditioner");
+  Teuchos::Array<std::string> paramNames;
+  Teuchos::Array<int> paramValues;
+  for (auto it = nextPrecList.begin(); it != nextPrecList.end(); ++it)
+    {
+    std::string const &name = nextPrecList.name(it);
+    if (!nextPrecList.isType<int>(name))
+      continue;
+    int value = nextPrecList.get<int>(name);
+    if (!precList.isType<int>(name) || precList.get<int>(name) != value)
+      {
+      paramNames.append(name);
+      paramValues.append(value);
+      }
+    }
+
+  int numParams = paramNames.size();
+  CacheWrite(os, numParams);
+  for (int i = 0; i < numParams; i++)
+    {
+    CacheWrite(os, paramNames[i]);
+    CacheWrite(os, paramValues[i]);
+    }
+
+  if (!os.good())
+    Tools::Warning("Failed to write " + CacheFileName(), __FILE__, __LINE__);
+
+  return 0;
+  }
+
 }//namespace
 
@@ -17,6 +17,8 @@ template <typename T> class Array;
   }
 
 class Epetra_Map;
+class Epetra_CrsGraph;
+class Epetra_Vector;
 
 namespace HYMLS {
 class BasePartitioner;
@@ -40,11 +42,16 @@ class OverlappingPartitioner: public HierarchicalMap,
 
 public:
 
-  //! constructor
+  //! constructor. The graph of the matrix is only needed
+  //! for the "Graph" partitioner and for computing the
+  //! "Partitioner Weights". The weights can also be given
+  //! directly, which is what happens on coarser levels.
   OverlappingPartitioner(
     Teuchos::RCP<const Epetra_Map> map,
     Teuchos::RCP<Teuchos::ParameterList> params, int level=1,
-    Teuchos::RCP<const Epetra_Map> overlappingMap=Teuchos::null);
+    Teuchos::RCP<const Epetra_Map> overlappingMap=Teuchos::null,
+    Teuchos::RCP<const Epetra_CrsGraph> graph=Teuchos::null,
+    Teuchos::RCP<const Epetra_Vector> weights=Teuchos::null);
 
   //! destructor
   virtual ~OverlappingPartitioner();
@@ -66,6 +73,20 @@ public:
     Teuchos::RCP<const Epetra_Map> map,
     Teuchos::RCP<const Epetra_Map> overlappingMap) const;
 
+  //! Like SpawnNextLevel(), but the next level lives on the
+  //! communicator of restrictedMap, which has the same local nodes
+  //! as map on the processors that are in it and is null on the
+  //! others (see AgglomeratedSolver). Returns null on the processors
+  //! that are not in the communicator. Not supported by the "Graph"
+  //! partitioner.
+  Teuchos::RCP<const OverlappingPartitioner> SpawnRestrictedNextLevel(
+    Teuchos::RCP<const Epetra_Map> map,
+    Teuchos::RCP<const Epetra_Map> restrictedMap) const;
+
+  //! true if the partitioning was read from the "Partition Cache"
+  //! instead of computed
+  bool ReadFromCache() const {return cacheRead_;}
+
   //! from the PLA base class
   void setParameterList(const Teuchos::RCP<Teuchos::ParameterList>& params);
 
@@ -74,13 +95,57 @@ protected:
   //! partitioning strategy
   std::string partitioningMethod_;
 
+  //! graph of the matrix (for graph partitioning)
+  Teuchos::RCP<const Epetra_CrsGraph> graph_;
+
+  //! how to weight the nodes for load balancing
+  //! ("None", "Nonzeros" or "Active")
+  std::string weightingMethod_;
+
+  //! cost of every node for load balancing (may be null)
+  Teuchos::RCP<const Epetra_Vector> weights_;
+
+  //! prefix of the files in which the partitioning is cached
+  //! (empty if no cache is used)
+  std::string cacheFile_;
+
+  //! true if the partitioning was read from the cache
+  bool cacheRead_;
+
 private:
 
+  //! create the partitioner object selected by "Partitioner"
+  Teuchos::RCP<BasePartitioner> CreatePartitioner();
+
   //! Step 2: construct overlapping maps after partitioning
   //! the result is a HierarchicalMap with three groups per
   //! subdomain: interior, separator and retained.
   int DetectSeparators(Teuchos::RCP<const BasePartitioner> partitioner);
 
+  //! compute the cost of every node from the graph
+  Teuchos::RCP<const Epetra_Vector> CreateWeights() const;
+
+  //! create the graph for the next level from the separators
+  //! around each subdomain (for graph partitioning)
+  Teuchos::RCP<const Epetra_CrsGraph> CreateNextLevelGraph(
+    Teuchos::RCP<const Epetra_Map> map,
+    Teuchos::RCP<const Epetra_Map> overlappingMap) const;
+
+  //! name of the cache file of this level and processor
+  std::string CacheFileName() const;
+
+  //! checksum of everything the partitioning depends on, which
+  //! has to match the one in the cache file
+  unsigned long long CacheKey() const;
+
+  //! read the partitioning of this level from the cache file
+  //! instead of computing it. Returns nonzero (on all processors)
+  //! if the cache does not exist or does not match on one of them.
+  int ReadCache(unsigned long long key);
+
+  //! write the partitioning of this level to the cache file
+  int WriteCache(unsigned long long key) const;
+
   int RemoveBoundarySeparators(Teuchos::Array<hymls_gidx> &interior_nodes,
     Teuchos::Array<Teuchos::Array<hymls_gidx> > &separator_nodes) const;
 
@@ -0,0 +1,216 @@
+#include "HYMLS_PerformanceReport.hpp"
+
+#include "HYMLS_config.h"
+
+#include "HYMLS_Tools.hpp"
+#include "HYMLS_Macros.hpp"
+
+#include "Epetra_Comm.h"
+#include "Epetra_Import.h"
+#include "Ifpack_Preconditioner.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace HYMLS {
+
+PerformanceReport::PerformanceReport(Teuchos::RCP<const Epetra_Comm> comm)
+  :
+  comm_(comm)
+  {}
+
+void PerformanceReport::Add(int level, std::string const &phase,
+  std::string const &metric, double value)
+  {
+  values_[Key(level, phase, metric)] += value;
+  }
+
+void PerformanceReport::AddOperator(int level, Ifpack_Preconditioner const &op,
+  Ifpack_Preconditioner const *exclude)
+  {
+  Add(level, "Initialize", "calls", op.NumInitialize());
+  Add(level, "Compute", "calls", op.NumCompute());
+  Add(level, "ApplyInverse", "calls", op.NumApplyInverse());
+
+  Add(level, "Initialize", "time", op.InitializeTime());
+  Add(level, "Compute", "time", op.ComputeTime());
+  Add(level, "ApplyInverse", "time", op.ApplyInverseTime());
+
+  Add(level, "Initialize", "flops", op.InitializeFlops());
+  Add(level, "Compute", "flops", op.ComputeFlops());
+  Add(level, "ApplyInverse", "flops", op.ApplyInverseFlops());
+
+  if (exclude)
+    {
+    Add(level, "Initialize", "time", -exclude->InitializeTime());
+    Add(level, "Compute", "time", -exclude->ComputeTime());
+    Add(level, "ApplyInverse", "time", -exclude->ApplyInverseTime());
+
+    Add(level, "Initialize", "flops", -exclude->InitializeFlops());
+    Add(level, "Compute", "flops", -exclude->ComputeFlops());
+    Add(level, "ApplyInverse", "flops", -exclude->ApplyInverseFlops());
+    }
+  }
+
+std::vector<PerformanceReport::Key> PerformanceReport::BroadcastKeys(
+  std::map<Key, double> const &values, int root) const
+  {
+  // Send the keys of the root to everyone, one field per line
+  std::string keys;
+  if (comm_->MyPID() == root)
+    {
+    std::ostringstream ss;
+    for (auto const &entry: values)
+      ss << std::get<0>(entry.first) << std::endl
+         << std::get<1>(entry.first) << std::endl
+         << std::get<2>(entry.first) << std::endl;
+    keys = ss.str();
+    }
+
+  int length = keys.length();
+  CHECK_ZERO(comm_->Broadcast(&length, 1, root));
+  std::vector<char> buffer(keys.begin(), keys.end());
+  buffer.resize(length + 1, '\0');
+  if (length > 0)
+    CHECK_ZERO(comm_->Broadcast(&buffer[0], length, root));
+
+  std::vector<Key> result;
+  std::istringstream ss(std::string(&buffer[0], length));
+  std::string level, phase, metric;
+  while (std::getline(ss, level) && std::getline(ss, phase) &&
+    std::getline(ss, metric))
+    {
+    result.push_back(Key(std::stoi(level), phase, metric));
+    }
+  return result;
+  }
+
+void PerformanceReport::Merge(PerformanceReport const *other, int root)
+  {
+  HYMLS_PROF3("PerformanceReport", "Merge");
+
+  std::vector<Key> keys = BroadcastKeys(other ? other->values_ : values_, root);
+  for (Key const &key: keys)
+    {
+    double value = 0.0;
+    if (other)
+      {
+      auto it = other->values_.find(key);
+      if (it != other->values_.end())
+        value = it->second;
+      }
+    values_[key] += value;
+    }
+  }
+
+double PerformanceReport::Bytes(Epetra_Import const &import, int numVectors,
+  bool reverse)
+  {
+  int n = reverse ? import.NumRemoteIDs() : import.NumExportIDs();
+  return (double)n * numVectors * sizeof(double);
+  }
+
+int PerformanceReport::Write(std::ostream &os) const
+  {
+  HYMLS_PROF3("PerformanceReport", "Write");
+
+  // Look up the metrics of the first process by key, since the
+  // other processes may have added them in a different order
+  std::vector<Key> keys = BroadcastKeys(values_, 0);
+  int n = keys.size();
+
+  int numFound = 0;
+  std::vector<double> values(n, 0.0);
+  for (int i = 0; i < n; i++)
+    {
+    auto it = values_.find(keys[i]);
+    if (it != values_.end())
+      {
+      values[i] = it->second;
+      numFound++;
+      }
+    }
+
+  int missing = (numFound != n || numFound != (int)values_.size()) ? 1 : 0;
+  int anyMissing = missing;
+  CHECK_ZERO(comm_->MaxAll(&missing, &anyMissing, 1));
+  if (anyMissing)
+    {
+    Tools::Warning("not all processes report the same metrics, only the "
+      "ones of the first process are written", __FILE__, __LINE__);
+    }
+
+  std::vector<double> minValues(values), maxValues(values), sumValues(values);
+  if (n > 0)
+    {
+    CHECK_ZERO(comm_->MinAll(&values[0], &minValues[0], n));
+    CHECK_ZERO(comm_->MaxAll(&values[0], &maxValues[0], n));
+    CHECK_ZERO(comm_->SumAll(&values[0], &sumValues[0], n));
+    }
+
+  if (comm_->MyPID() != 0)
+    return 0;
+
+  int numProc = comm_->NumProc();
+
+  os << std::setprecision(10);
+  os << "{" << std::endl;
+  os << "  \"processes\": " << numProc << "," << std::endl;
+  os << "  \"levels\": [";
+
+  int i = 0;
+  int level = -1;
+  std::string phase;
+  for (Key const &key: keys)
+    {
+    int entryLevel = std::get<0>(key);
+    std::string const &entryPhase = std::get<1>(key);
+    std::string const &metric = std::get<2>(key);
+
+    if (entryLevel != level)
+      {
+      if (i > 0)
+        os << std::endl << "        }" << std::endl << "      }" << std::endl << "    },";
+      os << std::endl << "    {" << std::endl;
+      os << "      \"level\": " << entryLevel << "," << std::endl;
+      os << "      \"phases\": {" << std::endl;
+      os << "        \"" << entryPhase << "\": {" << std::endl;
+      }
+    else if (entryPhase != phase)
+      {
+      os << std::endl << "        }," << std::endl;
+      os << "        \"" << entryPhase << "\": {" << std::endl;
+      }
+    else
+      {
+      os << "," << std::endl;
+      }
+    level = entryLevel;
+    phase = entryPhase;
+
+    os << "          \"" << metric << "\": {"
+       << "\"min\": " << minValues[i] << ", "
+       << "\"max\": " << maxValues[i] << ", "
+       << "\"mean\": " << sumValues[i] / numProc << "}";
+    i++;
+    }
+
+  if (i > 0)
+    os << std::endl << "        }" << std::endl << "      }" << std::endl << "    }";
+  os << std::endl << "  ]" << std::endl;
+  os << "}" << std::endl;
+
+  return 0;
+  }
+
+int PerformanceReport::Write(std::string const &filename) const
+  {
+  std::ofstream ofs;
+  if (comm_->MyPID() == 0)
+    ofs.open(filename.c_str());
+  return Write(ofs);
+  }
+
+  }
@@ -0,0 +1,86 @@
+#ifndef HYMLS_PERFORMANCE_REPORT_H
+#define HYMLS_PERFORMANCE_REPORT_H
+
+#include "Teuchos_RCP.hpp"
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class Epetra_Comm;
+class Epetra_Import;
+class Ifpack_Preconditioner;
+
+namespace HYMLS {
+
+/*! Collects performance data of the solver per level and phase
+  (e.g. the time, flops and fill of the Compute() phase on level 2)
+  and writes them as JSON, together with the minimum, maximum and
+  mean over all processes. Level 0 is the outer iterative solver,
+  level 1 the first (finest) level of the preconditioner.
+
+  The report is filled by calling AddToReport() on the solver and
+  the preconditioner. The metrics of the first process are written;
+  processes that did not add one of them count as zero.
+*/
+class PerformanceReport
+  {
+public:
+
+  //! constructor
+  PerformanceReport(Teuchos::RCP<const Epetra_Comm> comm);
+
+  //! add a value to a metric of a phase on some level. Adding to
+  //! the same metric more than once sums the values.
+  void Add(int level, std::string const &phase,
+    std::string const &metric, double value);
+
+  //! add the number of calls, time and flops of the Initialize(),
+  //! Compute() and ApplyInverse() phases of an operator. The time and
+  //! flops of the operator exclude, if given, are subtracted. It can
+  //! be used to leave out the levels below, which are reported
+  //! separately.
+  void AddOperator(int level, Ifpack_Preconditioner const &op,
+    Ifpack_Preconditioner const *exclude = NULL);
+
+  //! add all metrics of another report, which may only exist on some
+  //! of the processes, e.g. for a level that is solved on a sub-
+  //! communicator. The metrics are taken from the report on process
+  //! root, which must exist. Processes where other is NULL add zeros.
+  //! This has to be called by all processes.
+  void Merge(PerformanceReport const *other, int root = 0);
+
+  //! number of bytes that this process sends in an Import() with
+  //! the given importer, or in an Export() if reverse is true
+  static double Bytes(Epetra_Import const &import, int numVectors,
+    bool reverse = false);
+
+  //! write the report. This has to be called by all processes,
+  //! only the first one writes to the stream.
+  int Write(std::ostream &os) const;
+
+  //! write the report to a file. This has to be called by all
+  //! processes.
+  int Write(std::string const &filename) const;
+
+protected:
+
+  //! level, phase and metric
+  typedef std::tuple<int, std::string, std::string> Key;
+
+  //! communicator
+  Teuchos::RCP<const Epetra_Comm> comm_;
+
+  //! local values
+  std::map<Key, double> values_;
+
+  //! send the keys of values on process root to all processes, in
+  //! the order of the map. values is only used on process root.
+  std::vector<Key> BroadcastKeys(std::map<Key, double> const &values, int root) const;
+  };
+
+  }
+
+#endif
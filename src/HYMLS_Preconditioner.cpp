@@ -13,9 +13,13 @@
 #include "HYMLS_SchurPreconditioner.hpp"
 #include "HYMLS_MatrixBlock.hpp"
 #include "HYMLS_CoarseSolver.hpp"
+#include "HYMLS_PerformanceReport.hpp"
+#include "HYMLS_CacheIO.hpp"
+#include "HYMLS_HyperCube.hpp"
 
 #include "Epetra_Comm.h"
 #include "Epetra_SerialComm.h"
+#include "Epetra_MpiComm.h"
 #include "Epetra_Map.h"
 #include "Epetra_RowMatrix.h"
 #include "Epetra_Import.h"
@@ -24,6 +28,7 @@
 #include "Epetra_MultiVector.h"
 #include "Epetra_Vector.h"
 #include "Epetra_CrsMatrix.h"
+#include "Epetra_CrsGraph.h"
 #include "Epetra_FECrsMatrix.h"
 
 #include "EpetraExt_MatrixMatrix.h"
@@ -37,7 +42,14 @@
 #include "Teuchos_ParameterList.hpp"
 #include "Teuchos_StandardParameterEntryValidators.hpp"
 #include "Teuchos_Utils.hpp"
+#include "Teuchos_StandardCatchMacros.hpp"
 
+#include "BelosTypes.hpp"
+#include "BelosLinearProblem.hpp"
+#include "BelosEpetraAdapter.hpp"
+#include "BelosBlockGmresSolMgr.hpp"
+
+#include <algorithm>
 #include <fstream>
 
 namespace HYMLS {
@@ -50,14 +62,20 @@ Preconditioner::Preconditioner(Teuchos::RCP<const Epetra_RowMatrix> K,
   : PLA("Preconditioner"),
     comm_(Teuchos::rcp(K->Comm().Clone())), matrix_(K),
     rangeMap_(Teuchos::rcp(new Epetra_Map(K->RowMatrixRowMap()))),
-    hid_(hid), myLevel_(myLevel), testVector_(testVector),
+    hid_(hid), myLevel_(myLevel), matrixStructure_(0),
+    testVector_(testVector),
     useTranspose_(false), normInf_(-1.0),
     label_("Preconditioner"),
     initialized_(false), computed_(false),
     numInitialize_(0), numCompute_(0), numApplyInverse_(0),
     flopsInitialize_(0.0), flopsCompute_(0.0), flopsApplyInverse_(0.0),
     timeInitialize_(0.0), timeCompute_(0.0), timeApplyInverse_(0.0),
-    numThreadsSD_(-1), bgridTransform_(false)
+    bytesApplyInverse_(0.0), numSchurIterations_(0.0),
+    numThreadsSD_(-1), topologyThreads_(false), levelThreads_(-1), threadBudget_(-1),
+    denseCrossover_(100), denseFill_(0.3),
+    bgridTransform_(false),
+    schurIterations_(0), schurTolerance_(1e-3),
+    lowRankBorder_(false)
   {
   HYMLS_LPROF3(label_,"Constructor");
   serialComm_=Teuchos::rcp(new Epetra_SerialComm());
@@ -102,8 +120,14 @@ int Preconditioner::SetParameters(Teuchos::ParameterList& List)
 
   sdSolverType_ = PL().get("Subdomain Solver Type", "Sparse");
   numThreadsSD_ = PL().get("Subdomain Solver Num Threads", numThreadsSD_);
+  topologyThreads_ = PL().get("Topology-Aware Threads", topologyThreads_);
+  denseCrossover_ = PL().get("Dense Solver Crossover", denseCrossover_);
+  denseFill_ = PL().get("Dense Solver Fill", denseFill_);
   bgridTransform_ = PL().get("B-Grid Transform", false);
   maxLevel_ = PL().get("Number of Levels", 1);
+  schurIterations_ = PL().get("Schur Complement Iterations", 0);
+  schurTolerance_ = PL().get("Schur Complement Tolerance", 1e-3);
+  lowRankBorder_ = PL().get("Low-Rank Border Update", false);
 
   if (schurPrec_!=Teuchos::null)
     {
@@ -143,12 +167,40 @@ Preconditioner::getValidParameters() const
   Teuchos::RCP<Teuchos::StringToIntegralParameterEntryValidator<int> >
     partValidator = Teuchos::rcp(
       new Teuchos::StringToIntegralParameterEntryValidator<int>(
-        Teuchos::tuple<std::string>("Cartesian", "Skew Cartesian"),"Partitioner"));
+        Teuchos::tuple<std::string>("Cartesian", "Skew Cartesian", "Graph"),"Partitioner"));
 
   VPL().set("Partitioner", "Cartesian",
     "Type of partitioner to be used to define the subdomains",
     partValidator);
 
+  Teuchos::RCP<Teuchos::StringToIntegralParameterEntryValidator<int> >
+    weightValidator = Teuchos::rcp(
+      new Teuchos::StringToIntegralParameterEntryValidator<int>(
+        Teuchos::tuple<std::string>("None", "Nonzeros", "Active"),"Partitioner Weights"));
+
+  VPL().set("Partitioner Weights", "None",
+    "Cost of a node used to distribute the subdomains over the processors: "
+    "the number of nonzeros in its row, or 1 for active rows and 0 for rows "
+    "that only have a diagonal entry (e.g. land points). With the Graph "
+    "partitioner this is also the weight of a node in the bisection, which "
+    "is its number of nonzeros by default.",
+    weightValidator);
+
+  VPL().set("Partition Cache", "",
+    "Prefix of binary files <prefix>.<level>.<pid>.partition.bin in which the "
+    "partitioning is stored. If the files exist and were created for the "
+    "same problem, parameters and number of processors, the partitioning "
+    "is read from them instead of computed.");
+
+  VPL().set("Schur Complement Cache", "",
+    "Prefix of binary files <prefix>.<level>.<pid>.schur.bin in which the "
+    "assembled and transformed Schur complements are stored. If the files "
+    "exist and were created for the same matrix, parameters and number of "
+    "processors, the Schur complements are read from them instead of "
+    "assembled. This only saves the assembly: the subdomain LU "
+    "factorizations, the separator block factorizations and the coarse "
+    "factorization are still recomputed, so a restart is not nearly free.");
+
   VPL().set("Fix Pressure Level", true,
     "Put a Dirichlet condition on a single P-node on the coarsest grid");
 
@@ -183,6 +235,19 @@ Preconditioner::getValidParameters() const
   VPL().set("Coarsening Factor (y)", sepx, doc2);
   VPL().set("Coarsening Factor (z)", 1, doc2);
 
+  VPL().set("Number of Subdomains", -1,
+    "Number of subdomains for graph partitioning. By default it is "
+    "determined from the separator length");
+
+  VPL().set("Agglomeration Threshold", 0,
+    "Minimum number of unknowns per processor on the levels below the first. "
+    "A level with fewer unknowns per processor is moved to max(1, n / threshold) "
+    "processors and solved on a sub-communicator (MPI_Comm_split) that only "
+    "contains those, so its collectives do not involve the other processors. "
+    "0 uses all processors on every level. Not used with the Graph partitioner "
+    "or on the coarsest level, which is always restricted to the processors "
+    "that have unknowns.");
+
   Teuchos::RCP<Teuchos::StringToIntegralParameterEntryValidator<int> >
     varValidator = Teuchos::rcp(new Teuchos::StringToIntegralParameterEntryValidator<int>(
         Teuchos::tuple<std::string>(
@@ -216,18 +281,41 @@ Preconditioner::getValidParameters() const
   Teuchos::RCP<Teuchos::StringToIntegralParameterEntryValidator<int> >
     solverTypeValidator = Teuchos::rcp(
       new Teuchos::StringToIntegralParameterEntryValidator<int>(
-        Teuchos::tuple<std::string>("Sparse", "Dense", "Amesos"),"Subdomain Solver Type"));
+        Teuchos::tuple<std::string>("Sparse", "Dense", "Amesos", "Auto"),"Subdomain Solver Type"));
 
   VPL().set("Subdomain Solver Type", "Sparse",
-    "Sparse or dense subdomain solver?", solverTypeValidator);
+    "Sparse or dense subdomain solver? 'Auto' chooses per subdomain, see\n"
+    "'Dense Solver Crossover' and 'Dense Solver Fill'", solverTypeValidator);
+
+  VPL().set("Dense Solver Crossover", 100,
+    "With 'Auto' subdomain solvers, use a dense solver for subdomains with at most\n"
+    "this many rows. The default is an untuned guess that has not been measured\n"
+    "on any machine. Calibrate it by timing the subdomain factorizations of\n"
+    "hymls_benchmark with 'Dense' and 'Sparse' solvers");
+
+  VPL().set("Dense Solver Fill", 0.3,
+    "With 'Auto' subdomain solvers, also use a dense solver for larger subdomains\n"
+    "with at least this fraction of nonzeros. Like 'Dense Solver Crossover', the\n"
+    "default is an untuned guess");
 
   VPL().set("Dense Solvers on Level", 99,
-    "Switch to dense subdomain solver on levels larger than this value");
+    "Switch to dense subdomain solver on levels larger than this value. This is\n"
+    "ignored if the 'Subdomain Solver Type' is 'Auto'");
 
   VPL().set("Subdomain Solver Num Threads", -1,
     "Set number of OMP/MKL threads before calling subdomain solver, -1: don't "
     "(default)");
 
+  VPL().set("Topology-Aware Threads", false,
+    "Give the cores of the ranks on a node that have no subdomains on a level to\n"
+    "the ranks on the same node that do. The number of threads per rank is then\n"
+    "'Subdomain Solver Num Threads' (at least 1) times the number of ranks on the\n"
+    "node divided by the number of active ranks on the node. This requires that a\n"
+    "HYMLS::HyperCube object exists and that the communicator of the matrix is\n"
+    "congruent to its communicator or to MPI_COMM_WORLD. On agglomerated levels\n"
+    "(see 'Agglomeration Threshold') the processors that are not in the\n"
+    "sub-communicator count as inactive");
+
   // this typically doesn't need parameters, it's just lapack on small dense
   // matrices.
   VPL().sublist("Dense Solver", false,
@@ -254,6 +342,25 @@ Preconditioner::getValidParameters() const
     "'Domain Decomposition' - one sparse block per processor",
     variantValidator);
 
+  VPL().set("Schur Complement Iterations", 0,
+    "Maximum number of inner GMRES iterations on the exact Schur complement, "
+    "which is applied without assembling it, preconditioned by the approximate "
+    "Schur complement. By default (0) the approximation is applied only once. "
+    "This is only done on the first level and not if a border was added. With inner iterations the "
+    "preconditioner is not a fixed linear operator, so the outer Krylov method "
+    "must be flexible GMRES with right preconditioning. HYMLS::Solver selects "
+    "this automatically and warns if it is not possible.");
+
+  VPL().set("Schur Complement Tolerance", 1e-3,
+    "Relative residual tolerance of the inner GMRES iterations on the "
+    "Schur complement (see \"Schur Complement Iterations\")");
+
+  VPL().set("Low-Rank Border Update", false,
+    "Keep all factorizations when SetBorder is called after Compute. The border\n"
+    "is then handled on the coarsest level with a small dense capacitance matrix\n"
+    "(Sherman-Morrison-Woodbury), so the coarsest matrix without the border has\n"
+    "to be nonsingular");
+
   VPL().set("Apply Dropping", true, "Whether dropping is applied in the Schur complement");
 
   VPL().set("Apply Orthogonal Transformation", true, "Whether or not to apply the orthogonal transformation before dropping. In practice this should only be set to false in case \"Apply Dropping\" is set to false, in which case that is the default.");
@@ -287,9 +394,18 @@ int Preconditioner::Initialize()
     // - partition domain into small subdomains
     // - find separators
     // - group them according to the needs of our algorithm
+    // the graph partitioner and the partitioner weights need the
+    // graph of the matrix, we keep the matrix alive as long as the
+    // graph is used.
+    Teuchos::RCP<const Epetra_CrsGraph> graph = Teuchos::null;
+    Teuchos::RCP<const Epetra_CrsMatrix> crsMatrix =
+      Teuchos::rcp_dynamic_cast<const Epetra_CrsMatrix>(matrix_);
+    if (crsMatrix != Teuchos::null)
+      graph = Teuchos::rcpWithEmbeddedObj(&crsMatrix->Graph(), crsMatrix, false);
+
     hid_ = Teuchos::rcp(new
       HYMLS::OverlappingPartitioner(rangeMap_,
-        getMyNonconstParamList(), myLevel_));
+        getMyNonconstParamList(), myLevel_, Teuchos::null, graph));
     }
 
   HYMLS_TEST(Label()+Teuchos::toString(myLevel_),
@@ -304,22 +420,29 @@ int Preconditioner::Initialize()
   // the Compute() phase.
 #endif
 
-  // this is an idea to make the "HyperCube" object
-  // statically available and using it to query things
-  // like "idle CPU cores on node" dynamically
-
-  /*
-    if (HYMLS::ProcTopo==Teuchos::null)
+  // On coarser levels some ranks have no subdomains, so the ranks
+  // on the same node that do can use their cores. This does not
+  // change the process layout.
+  levelThreads_ = numThreadsSD_;
+  if (topologyThreads_)
     {
-    HYMLS::Tools::Error("static object HYMLS::ProcTopo not constructed!");
+    HyperCube const *topology = HyperCube::Instance();
+    if (threadBudget_ > 0)
+      {
+      levelThreads_ = hid_->NumMySubdomains() > 0 ?
+        threadBudget_ * std::max(numThreadsSD_, 1) : 1;
+      }
+    else if (topology == NULL || !topology->IsCongruent(Comm()))
+      {
+      Tools::Warning("'Topology-Aware Threads' requires a HyperCube on the same "
+        "processes, using 'Subdomain Solver Num Threads'", __FILE__, __LINE__);
+      }
+    else
+      {
+      levelThreads_ = topology->NumThreads(hid_->NumMySubdomains() > 0,
+        std::max(numThreadsSD_, 1));
+      }
     }
-    int active = num_sd>0 ? 1:0;
-    // this is just for figuring
-    // out how many threads we can
-    // use locally, it does not *change*
-    // the process layout
-    ProcTopo->setActive(myLevel_,active);
-  */
 
   // Obtain a map with overlap between processors from the overlapping
   // partitioner which we need for the A12/A21 subdomain blocks
@@ -336,6 +459,9 @@ int Preconditioner::Initialize()
   importer_=Teuchos::rcp(new Epetra_Import(*rowMap_,*rangeMap_));
 
   // Construct the matrix blocks we need for the Schur complement
+  // the blocks are recreated, so we also need a new reordered matrix
+  reorderedMatrix_ = Teuchos::null;
+
   A11_ = Teuchos::rcp(new MatrixBlock(hid_,
       HierarchicalMap::Interior, HierarchicalMap::Interior, myLevel_));
   A12_ = Teuchos::rcp(new MatrixBlock(hid_,
@@ -345,11 +471,22 @@ int Preconditioner::Initialize()
   A22_ = Teuchos::rcp(new MatrixBlock(hid_,
       HierarchicalMap::Separators, HierarchicalMap::Separators, myLevel_));
 
+  // Concatenate the interior and separator maps so that ApplyInverse
+  // needs only one import and one export
+  Teuchos::Array<hymls_gidx> blockGIDs = MyGIDs(A12_->RowMap());
+  Teuchos::Array<hymls_gidx> separatorGIDs = MyGIDs(A21_->RowMap());
+  blockGIDs.insert(blockGIDs.end(), separatorGIDs.begin(), separatorGIDs.end());
+  blockMap_ = Teuchos::rcp(new Epetra_Map((hymls_gidx)(-1),
+      blockGIDs.size(), blockGIDs.getRawPtr(),
+      (hymls_gidx)rangeMap_->IndexBase64(), Comm()));
+  blockImporter_ = Teuchos::rcp(new Epetra_Import(*blockMap_, *rangeMap_));
+
   Teuchos::RCP<Teuchos::ParameterList> sd_list = Teuchos::rcp(new
     Teuchos::ParameterList(PL().sublist("Sparse Solver")));
 
   // Initialize the subdomain solvers for the A11 block
-  CHECK_ZERO(A11_->InitializeSubdomainSolvers(sdSolverType_, sd_list, numThreadsSD_));
+  CHECK_ZERO(A11_->InitializeSubdomainSolvers(sdSolverType_, sd_list, levelThreads_,
+      denseCrossover_, denseFill_));
 
   HYMLS_DEBUG("Create Schur-complement");
 
@@ -367,6 +504,16 @@ int Preconditioner::Initialize()
     {
     Tools::out() << "*** USING DENSE SUBDOMAIN SOLVERS ***"<<std::endl;
     }
+  else if (sdSolverType_=="Auto")
+    {
+    Tools::out() << "*** CHOOSING SUBDOMAIN SOLVERS AUTOMATICALLY ***"<<std::endl;
+    }
+  if (topologyThreads_)
+    {
+    int maxThreads;
+    CHECK_ZERO(Comm().MaxAll(&levelThreads_, &maxThreads, 1));
+    Tools::out() << "MAX. THREADS PER RANK: "<< maxThreads<<std::endl;
+    }
 
   Tools::out() << "=============================="<<std::endl;
 
@@ -376,6 +523,7 @@ int Preconditioner::Initialize()
     Teuchos::RCP<Epetra_Vector> testVector = CreateTestVector();
     schurPrec_ = Teuchos::rcp(new SchurPreconditioner(Schur_,hid_,
         getMyNonconstParamList(), myLevel_, testVector));
+    schurPrec_->SetThreadBudget(threadBudget_);
 
     CHECK_ZERO(schurPrec_->Initialize());
     }
@@ -424,17 +572,49 @@ int Preconditioner::Compute()
       Tools::Error("Currently requires an Epetra_CrsMatrix!",__FILE__,__LINE__);
       }
 
-    HYMLS_DEBUG("Reorder global matrix");
-    Teuchos::RCP<Epetra_CrsMatrix> reorderedMatrix =
-      Teuchos::rcp(new Epetra_CrsMatrix(Copy, *rowMap_, MaxNumEntriesPerRow));
+    // the cached Schur complement can only be used for the same matrix
+    Teuchos::RCP<SchurPreconditioner> schurPrec =
+      Teuchos::rcp_dynamic_cast<SchurPreconditioner>(schurPrec_);
+    if (schurPrec != Teuchos::null &&
+      PL().get("Schur Complement Cache", "") != "")
+      {
+      schurPrec->SetCacheKey(CacheHash(cacheHashInit, *Acrs));
+      }
 
-    CHECK_ZERO(reorderedMatrix->Import(*Acrs, *importer_, Insert));
-    CHECK_ZERO(reorderedMatrix->FillComplete());
+    // If only the values of the matrix changed, we copy them into the
+    // existing reordered matrix and matrix blocks. This needs one
+    // Import and no new matrices.
+    unsigned long long structure = MatrixBlock::StructureHash(*Acrs);
+    int refresh = reorderedMatrix_ != Teuchos::null && structure == matrixStructure_
+      && A12_->HaveValuePlan() && A21_->HaveValuePlan() && A22_->HaveValuePlan();
+    int allRefresh = refresh;
+    CHECK_ZERO(comm_->MinAll(&refresh, &allRefresh, 1));
 
-    // Compute the A12, A21, A22 blocks
-    CHECK_ZERO(A12_->Compute(Acrs, reorderedMatrix));
-    CHECK_ZERO(A21_->Compute(Acrs, reorderedMatrix));
-    CHECK_ZERO(A22_->Compute(Acrs, reorderedMatrix));
+    if (allRefresh)
+      {
+      HYMLS_DEBUG("Refresh values of the reordered matrix");
+      CHECK_ZERO(reorderedMatrix_->PutScalar(0.0));
+      CHECK_ZERO(reorderedMatrix_->Import(*Acrs, *importer_, Insert));
+
+      CHECK_ZERO(A12_->RefreshValues(*reorderedMatrix_));
+      CHECK_ZERO(A21_->RefreshValues(*reorderedMatrix_));
+      CHECK_ZERO(A22_->RefreshValues(*reorderedMatrix_));
+      }
+    else
+      {
+      HYMLS_DEBUG("Reorder global matrix");
+      reorderedMatrix_ =
+        Teuchos::rcp(new Epetra_CrsMatrix(Copy, *rowMap_, MaxNumEntriesPerRow));
+
+      CHECK_ZERO(reorderedMatrix_->Import(*Acrs, *importer_, Insert));
+      CHECK_ZERO(reorderedMatrix_->FillComplete());
+      matrixStructure_ = structure;
+
+      // Compute the A12, A21, A22 blocks
+      CHECK_ZERO(A12_->Compute(Acrs, reorderedMatrix_));
+      CHECK_ZERO(A21_->Compute(Acrs, reorderedMatrix_));
+      CHECK_ZERO(A22_->Compute(Acrs, reorderedMatrix_));
+      }
 
 #ifdef HYMLS_STORE_MATRICES
     MatrixUtils::Dump(A12_->Block()->RowMap(), "Precond"+Teuchos::toString(myLevel_)+"_Map1.txt");
@@ -446,12 +626,24 @@ int Preconditioner::Compute()
 
     // note: the Compute and ComputeSubdomainSolvers functions both extract the matrix block,
     // so normally we don't need to call Compute() for A11
-    CHECK_ZERO(A11_->Compute(Acrs, reorderedMatrix));
+    CHECK_ZERO(A11_->Compute(Acrs, reorderedMatrix_));
     MatrixUtils::Dump(*A11_->Block(), "Precond"+Teuchos::toString(myLevel_)+"_A11.txt");
 
 #endif
 
-    CHECK_ZERO(A11_->ComputeSubdomainSolvers(reorderedMatrix));
+    // ComputeBorder() applies the transpose of A11
+    A11_->SetTransposeNeeded(HaveBorder() || lowRankBorder_);
+    CHECK_ZERO(A11_->ComputeSubdomainSolvers(reorderedMatrix_));
+
+    if (sdSolverType_ == "Auto" && numCompute_ == 0)
+      {
+      int counts[2], globalCounts[2];
+      A11_->SubdomainSolverCounts(counts[0], counts[1]);
+      CHECK_ZERO(Comm().SumAll(counts, globalCounts, 2));
+      Tools::out() << "LEVEL " << myLevel_ << ": " << globalCounts[0]
+                   << " dense and " << globalCounts[1]
+                   << " sparse subdomain solvers" << std::endl;
+      }
 
 #ifdef HYMLS_TESTING
     Tools::out() << "Preconditioner level " << myLevel_ << ", doFmatTests=" << Tester::doFmatTests_ << std::endl;
@@ -680,6 +872,41 @@ double Preconditioner::ApplyInverseFlops() const
   }
 
 
+void Preconditioner::AddToReport(PerformanceReport &report) const
+  {
+  HYMLS_LPROF3(label_, "AddToReport");
+
+  // The levels below are reported separately
+  Teuchos::RCP<const SchurPreconditioner> schurPrec =
+    Teuchos::rcp_dynamic_cast<const SchurPreconditioner>(schurPrec_);
+  Teuchos::RCP<const Ifpack_Preconditioner> nextLevel;
+  if (schurPrec != Teuchos::null)
+    nextLevel = schurPrec->NextLevel();
+
+  report.AddOperator(myLevel_, *this, nextLevel.get());
+  report.Add(myLevel_, "ApplyInverse", "bytes", bytesApplyInverse_);
+  if (schurIterations_ > 0)
+    report.Add(myLevel_, "ApplyInverse", "Schur iterations", numSchurIterations_);
+
+  double nnzA = 0.0, nnzL = 0.0, nnzU = 0.0;
+  if (A11_ != Teuchos::null)
+    A11_->SubdomainNonzeros(nnzA, nnzL, nnzU);
+  report.Add(myLevel_, "Compute", "nonzeros A", nnzA);
+  report.Add(myLevel_, "Compute", "nonzeros L", nnzL);
+  report.Add(myLevel_, "Compute", "nonzeros U", nnzU);
+
+  int numDense = 0, numSparse = 0;
+  if (A11_ != Teuchos::null)
+    A11_->SubdomainSolverCounts(numDense, numSparse);
+  report.Add(myLevel_, "Compute", "dense subdomains", numDense);
+  report.Add(myLevel_, "Compute", "sparse subdomains", numSparse);
+  if (topologyThreads_)
+    report.Add(myLevel_, "ApplyInverse", "threads", levelThreads_);
+
+  if (schurPrec != Teuchos::null)
+    schurPrec->AddToReport(report);
+  }
+
 // Computes the condition number estimate, returns its value.
 double Preconditioner::Condest(const Ifpack_CondestType CT,
   const int MaxIters,
@@ -872,7 +1099,9 @@ int Preconditioner::SetBorder(
     CHECK_ZERO(borderedPrec->SetBorder(borderSchurV_, borderSchurW_, borderSchurC_));
 
     // Compute has to be called after setting the border, so make sure this happens.
-    computed_ = false;
+    // This is not needed if the coarsest level did not factor the border.
+    if (!lowRankBorder_)
+      computed_ = false;
 
     return 0;
     }
@@ -911,8 +1140,15 @@ int Preconditioner::SetBorder(
       __FILE__, __LINE__);
     }
 
-    // Compute has to be called after setting the border, so make sure this happens.
-    computed_ = false;
+  // With a low-rank border update we keep all factorizations and
+  // only recompute the border, which costs O(m) subdomain solves
+  if (lowRankBorder_ && IsComputed())
+    {
+    return ComputeBorder();
+    }
+
+  // Compute has to be called after setting the border, so make sure this happens.
+  computed_ = false;
 
   return 0;
   }
@@ -926,6 +1162,49 @@ int Preconditioner::Apply(const Epetra_MultiVector& X, const Epetra_SerialDenseM
   return -99;
   }
 
+// solve S*X = B with GMRES, where S is applied without assembling it
+// and the Schur preconditioner is used as right preconditioner
+int Preconditioner::SolveSchurComplement(const Epetra_MultiVector& B,
+  Epetra_MultiVector& X) const
+  {
+  HYMLS_LPROF2(label_, "SolveSchurComplement");
+
+  typedef Belos::LinearProblem<double, Epetra_MultiVector, Epetra_Operator> BelosProblemType;
+  typedef Belos::BlockGmresSolMgr<double, Epetra_MultiVector, Epetra_Operator> BelosGmresType;
+
+  Teuchos::RCP<Teuchos::ParameterList> belosList = Teuchos::rcp(new Teuchos::ParameterList());
+  belosList->set("Maximum Iterations", schurIterations_);
+  belosList->set("Num Blocks", schurIterations_);
+  belosList->set("Block Size", B.NumVectors());
+  belosList->set("Convergence Tolerance", schurTolerance_);
+  belosList->set("Verbosity", ::Belos::Errors + ::Belos::Warnings);
+
+  CHECK_ZERO(X.PutScalar(0.0));
+
+  Teuchos::RCP<BelosProblemType> problem = Teuchos::rcp(new BelosProblemType(
+      Schur_, Teuchos::rcp(&X, false), Teuchos::rcp(&B, false)));
+  problem->setRightPrec(Teuchos::rcp(new ::Belos::EpetraPrecOp(schurPrec_)));
+  CHECK_TRUE(problem->setProblem());
+
+  BelosGmresType solver(problem, belosList);
+
+  bool status = true;
+  try {
+    solver.solve();
+    } TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, status);
+  if (!status)
+    {
+    Tools::Warning("caught an exception", __FILE__, __LINE__);
+    return -1;
+    }
+
+  // Not converging within the maximum number of iterations is fine,
+  // we are only a preconditioner.
+  numSchurIterations_ += solver.getNumIters();
+
+  return 0;
+  }
+
 // if a border has been added, apply [X S]' = [K V; W' O]\[Y T]'
 int Preconditioner::ApplyInverse(const Epetra_MultiVector& B, const Epetra_SerialDenseMatrix& T,
   Epetra_MultiVector& X,       Epetra_SerialDenseMatrix& S) const
@@ -947,21 +1226,27 @@ int Preconditioner::ApplyInverse(const Epetra_MultiVector& B, const Epetra_Seria
 
   int numvec = X.NumVectors();
 
-  Epetra_Import const &import1 = A12_->Importer();
-  Epetra_Import const &import2 = A21_->Importer();
-
   Epetra_Map const &map1 = A12_->RowMap();
   Epetra_Map const &map2 = A21_->RowMap();
 
-  Epetra_MultiVector x1(map1, numvec);
-  Epetra_MultiVector x2(map2, numvec);
+  // x1, x2 and b1, b2 are views of the first and second part of
+  // vectors in blockMap_, so both parts are communicated at once
+  Epetra_MultiVector x(*blockMap_, numvec);
+  Epetra_MultiVector b(*blockMap_, numvec);
+  const int n1 = map1.NumMyElements();
+
+  Epetra_MultiVector x1(View, map1, x.Values(), x.MyLength(), numvec);
+  Epetra_MultiVector x2(View, map2, x.Values() + n1, x.MyLength(), numvec);
 
-  Epetra_MultiVector b1(map1, numvec);
-  Epetra_MultiVector b2(map2, numvec);
+  Epetra_MultiVector b1(View, map1, b.Values(), b.MyLength(), numvec);
+  Epetra_MultiVector b2(View, map2, b.Values() + n1, b.MyLength(), numvec);
 
   Epetra_MultiVector y1(map1, numvec);
   Epetra_MultiVector y2(map2, numvec);
 
+  bytesApplyInverse_ += PerformanceReport::Bytes(*blockImporter_, numvec)
+    + PerformanceReport::Bytes(*blockImporter_, numvec, true);
+
   // We first import B into the parts of B belonging to their blocks
   if (T_ != Teuchos::null)
     {
@@ -970,13 +1255,11 @@ int Preconditioner::ApplyInverse(const Epetra_MultiVector& B, const Epetra_Seria
     CHECK_ZERO(T_->Multiply(true, B, BT));
     Tools::StopTiming("TransformMatix: MV transform 1");
 
-    CHECK_ZERO(b1.Import(BT, import1, Insert));
-    CHECK_ZERO(b2.Import(BT, import2, Insert));
+    CHECK_ZERO(b.Import(BT, *blockImporter_, Insert));
     }
   else
     {
-    CHECK_ZERO(b1.Import(B, import1, Insert));
-    CHECK_ZERO(b2.Import(B, import2, Insert));
+    CHECK_ZERO(b.Import(B, *blockImporter_, Insert));
     }
 
   // We want to compute
@@ -1018,7 +1301,14 @@ int Preconditioner::ApplyInverse(const Epetra_MultiVector& B, const Epetra_Seria
     HYMLS::Tools::Error("No bordered interface specified for the Schur complement solver", __FILE__, __LINE__);
     }
 
-  CHECK_ZERO(borderedPrec->ApplyInverse(*schurRhs_, q, *schurSol_, S));
+  if (schurIterations_ > 0 && W_ == Teuchos::null)
+    {
+    CHECK_ZERO(SolveSchurComplement(*schurRhs_, *schurSol_));
+    }
+  else
+    {
+    CHECK_ZERO(borderedPrec->ApplyInverse(*schurRhs_, q, *schurSol_, S));
+    }
 
   x2 = *schurSol_;
 
@@ -1048,8 +1338,7 @@ int Preconditioner::ApplyInverse(const Epetra_MultiVector& B, const Epetra_Seria
   // the other subdomains, so we need to zero out X
   // and 'Add' instead.
   CHECK_ZERO(X.PutScalar(0.0));
-  CHECK_ZERO(X.Export(x1, import1, Add));
-  CHECK_ZERO(X.Export(x2, import2, Add));
+  CHECK_ZERO(X.Export(x, *blockImporter_, Add));
   if (T_ != Teuchos::null)
     {
     Tools::StartTiming("TransformMatix: MV transform 2");
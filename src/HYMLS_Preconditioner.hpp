@@ -33,6 +33,7 @@ class SchurComplement;
 class Epetra_Time;
 class MatrixBlock;
 class OverlappingPartitioner;
+class PerformanceReport;
 
 /*! This class
   - sets parameters for the problem
@@ -86,6 +87,17 @@ public:
   //! destructor
   virtual ~Preconditioner();
 
+  //! true if ApplyInverse() does inner iterations ("Schur Complement
+  //! Iterations" > 0), so that it is not a fixed linear operator. The
+  //! outer Krylov method then has to be flexible GMRES.
+  bool IsVariable() const {return schurIterations_ > 0;}
+
+  //! With "Topology-Aware Threads", give every thread of "Subdomain Solver
+  //! Num Threads" coresPerThread cores instead of asking the HyperCube.
+  //! This is used by the AgglomeratedSolver, because the HyperCube cannot
+  //! be queried on its sub-communicator. It is passed to the next levels.
+  void SetThreadBudget(int coresPerThread) {threadBudget_ = coresPerThread;}
+
   //! write solver data (like domain decomposition, separators ...)
   //! to an m-file so that it can be imported to MATLAB.
   void Visualize(std::string mfilename, bool no_recurse=false) const;
@@ -159,6 +171,10 @@ public:
   //! Prints basic information on iostream. This function is used by operator<<.
   std::ostream& Print(std::ostream& os) const;
 
+  //! Add the performance data of this level and the levels below
+  //! to a report.
+  void AddToReport(PerformanceReport &report) const;
+
   int SetUseTranspose(bool UseTranspose)
     {
     useTranspose_=false; // not implemented.
@@ -276,6 +292,13 @@ protected:
   //! importer from range to row map
   Teuchos::RCP<Epetra_Import> importer_;
 
+  //! map with the local interior variables of A12_ followed by the
+  //! local separator variables of A21_, and an importer from the range
+  //! map into it. With this we import and export both parts of a
+  //! vector in a single communication step in ApplyInverse.
+  Teuchos::RCP<const Epetra_Map> blockMap_;
+  Teuchos::RCP<Epetra_Import> blockImporter_;
+
   //! our own minimally overlapped and reordered partitioning:
   Teuchos::RCP<const OverlappingPartitioner> hid_;
 
@@ -292,6 +315,13 @@ protected:
   mutable Teuchos::RCP<SchurComplement> Schur_;
 
 
+  //! the matrix imported into rowMap_, kept to refresh its values
+  //! when only the values of the matrix change
+  Teuchos::RCP<Epetra_CrsMatrix> reorderedMatrix_;
+
+  //! hash of the structure of the matrix used to build reorderedMatrix_
+  unsigned long long matrixStructure_;
+
   //! A11, A12, A21 and A22-part of matrix
   //! 1: associated with interior variables
   //! 2: associated with separator variables, but non-overlapping
@@ -376,6 +406,12 @@ protected:
   //! time during ApplyInverse()
   mutable double timeApplyInverse_;
 
+  //! bytes sent to other processes during ApplyInverse()
+  mutable double bytesApplyInverse_;
+
+  //! total number of inner iterations on the Schur complement
+  mutable double numSchurIterations_;
+
   //!@}
 
   mutable bool dumpVectors_;
@@ -383,9 +419,35 @@ protected:
   //! max num threads to use for subdomain solve
   int numThreadsSD_;
 
+  //! divide the cores of the ranks on a node without subdomains on this
+  //! level over the ranks that have subdomains (see HyperCube)
+  bool topologyThreads_;
+
+  //! number of threads used by the subdomain solvers on this level
+  int levelThreads_;
+
+  //! cores per subdomain solver thread set by SetThreadBudget(), or -1
+  int threadBudget_;
+
+  //! subdomains up to this size get a dense solver if sdSolverType_ is "Auto"
+  int denseCrossover_;
+
+  //! subdomains with at least this density get a dense solver if
+  //! sdSolverType_ is "Auto"
+  double denseFill_;
+
   //! Transform B-grid type matrix into an F-matrix
   bool bgridTransform_;
 
+  //! maximum number of inner GMRES iterations on the Schur complement
+  int schurIterations_;
+
+  //! tolerance of the inner GMRES iterations on the Schur complement
+  double schurTolerance_;
+
+  //! keep the factorizations if the border changes
+  bool lowRankBorder_;
+
 #ifdef HYMLS_DEBUGGING
 public:
 #else
@@ -408,6 +470,12 @@ private:
   //! Actually compute the next level border during the Compute phase.
   int ComputeBorder();
 
+  //! Solve the Schur complement system with GMRES, applying the
+  //! Schur complement matrix-free and preconditioning it with the
+  //! approximate Schur complement.
+  int SolveSchurComplement(const Epetra_MultiVector& B,
+    Epetra_MultiVector& X) const;
+
   };
 
 
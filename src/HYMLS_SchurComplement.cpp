@@ -29,10 +29,10 @@ namespace HYMLS {
 // of the SC or the whole thing as sparse or dense matrix.
 
 SchurComplement::SchurComplement(
-  Teuchos::RCP<const MatrixBlock> A11,
-  Teuchos::RCP<const MatrixBlock> A12,
-  Teuchos::RCP<const MatrixBlock> A21,
-  Teuchos::RCP<const MatrixBlock> A22,
+  Teuchos::RCP<MatrixBlock> A11,
+  Teuchos::RCP<MatrixBlock> A12,
+  Teuchos::RCP<MatrixBlock> A21,
+  Teuchos::RCP<MatrixBlock> A22,
   int lev)
   : A11_(A11), A12_(A12), A21_(A21), A22_(A22),
     myLevel_(lev),
@@ -53,8 +53,33 @@ SchurComplement::~SchurComplement()
 int SchurComplement::Apply(const Epetra_MultiVector &X,
   Epetra_MultiVector &Y) const
   {
-  Tools::Warning("Apply() not available!", __FILE__, __LINE__);
-  return -1;
+  HYMLS_LPROF2(label_, "Apply");
+
+  int numvec = X.NumVectors();
+  if (Y.NumVectors() != numvec)
+    {
+    Tools::Warning("X and Y have a different number of vectors!", __FILE__, __LINE__);
+    return -1;
+    }
+
+  Epetra_MultiVector x1(A12_->RowMap(), numvec);
+  Epetra_MultiVector y1(A11_->RowMap(), numvec);
+  Epetra_MultiVector y2(A21_->RowMap(), numvec);
+  Epetra_MultiVector z2(A22_->RowMap(), numvec);
+
+  // y2 = A21*A11\A12*X
+  CHECK_ZERO(A12_->Apply(X, x1));
+  CHECK_ZERO(A11_->ApplyInverse(x1, y1));
+  CHECK_ZERO(A21_->Apply(y1, y2));
+
+  // Y = A22*X - y2. We only write Y at the end because
+  // X and Y may be the same vector.
+  CHECK_ZERO(A22_->Apply(X, z2));
+  CHECK_ZERO(Y.Update(1.0, z2, -1.0, y2, 0.0));
+
+  flopsApply_ += 2.0 * numvec * Y.GlobalLength64();
+
+  return 0;
   }
 
 // Apply inverse operator - not implemented.
@@ -186,12 +211,24 @@ int SchurComplement::Construct11(int sd, Epetra_SerialDenseMatrix &Sk,
   double *values;
   int int_elems = hid.NumInteriorElements(sd);
 
+  // The column map of A12 is usually the spawned separator map that
+  // is also the row map of A21, in which case the column indices are
+  // the positions in inds
+  const bool sameMap = A12.ColMap().SameAs(A21.RowMap());
+
   // Loop over all interior elements
   for (int i = 0; i < int_elems; i++)
     {
     // Get a view of the matrix row (with all separator couplings)
     CHECK_ZERO(A12.ExtractMyRowView(i, len, values, indices));
 
+    if (sameMap)
+      {
+      for (int k = 0 ; k < len; k++)
+        A11.RHS(i, indices[k]) = values[k];
+      continue;
+      }
+
     // A11 ID stores local indices of the original matrix
     // loop over the matrix row and look for matching entries
     for (int k = 0 ; k < len; k++)
@@ -285,10 +322,20 @@ int SchurComplement::Construct22(int sd, Epetra_SerialDenseMatrix &Sk,
   int *indices;
   double *values;
 
+  // The column map is usually the same as the row map, in which case
+  // the column indices are the positions in inds
+  const bool sameMap = A22.ColMap().SameAs(A22.RowMap());
+
   for (int i = 0; i < nrows; i++)
     {
     // A22 part
     CHECK_ZERO(A22.ExtractMyRowView(i, len, values, indices));
+    if (sameMap)
+      {
+      for (int k = 0; k < len; k++)
+        Sk(i, indices[k]) = values[k];
+      continue;
+      }
     for (int k = 0; k < len; k++)
       {
       const hymls_gidx gcid = A22.GCID64(indices[k]);
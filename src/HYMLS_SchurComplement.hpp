@@ -42,10 +42,10 @@ public:
   //! label right, the mother defines A11, A12, A21 and A22
   //! so that this class represents A22 - A21 A11\A12
   SchurComplement(
-    Teuchos::RCP<const MatrixBlock> A11,
-    Teuchos::RCP<const MatrixBlock> A12,
-    Teuchos::RCP<const MatrixBlock> A21,
-    Teuchos::RCP<const MatrixBlock> A22,
+    Teuchos::RCP<MatrixBlock> A11,
+    Teuchos::RCP<MatrixBlock> A12,
+    Teuchos::RCP<MatrixBlock> A21,
+    Teuchos::RCP<MatrixBlock> A22,
     int lev = 0);
 
   //! destructor
@@ -55,7 +55,8 @@ public:
 
   //@{
 
-  //! Applies the operator
+  //! Applies the operator Y = (A22 - A21*A11\A12) X without
+  //! constructing it. This requires the subdomain solvers of A11.
   int Apply(const Epetra_MultiVector & X,
     Epetra_MultiVector &Y) const;
 
@@ -109,8 +110,9 @@ public:
 
 protected:
 
-  //! Matrix blocks of the original matrix
-  Teuchos::RCP<const MatrixBlock> A11_, A12_, A21_, A22_;
+  //! Matrix blocks of the original matrix. These are not const
+  //! because applying them updates their flop counters.
+  Teuchos::RCP<MatrixBlock> A11_, A12_, A21_, A22_;
 
   //!
   int myLevel_;
@@ -6,6 +6,7 @@
 
 #include "HYMLS_Macros.hpp"
 #include "HYMLS_Tools.hpp"
+#include "HYMLS_CacheIO.hpp"
 #include "HYMLS_DenseUtils.hpp"
 #include "HYMLS_MatrixUtils.hpp"
 #include "HYMLS_OverlappingPartitioner.hpp"
@@ -15,6 +16,8 @@
 #include "HYMLS_RestrictedOT.hpp"
 #include "HYMLS_SeparatorGroup.hpp"
 #include "HYMLS_CoarseSolver.hpp"
+#include "HYMLS_AgglomeratedSolver.hpp"
+#include "HYMLS_PerformanceReport.hpp"
 
 #include "Epetra_Comm.h"
 #include "Epetra_Map.h"
@@ -37,6 +40,7 @@
 #include "Teuchos_RCP.hpp"
 #include "Teuchos_ParameterList.hpp"
 #include "Teuchos_StandardCatchMacros.hpp"
+#include "Teuchos_toString.hpp"
 
 #include "Ifpack_Container.h"
 #include "Ifpack_DenseContainer.h"
@@ -55,10 +59,17 @@
 #include <fstream>
 #include <algorithm>
 #include <iostream>
+#include <sstream>
 
 namespace HYMLS
   {
 
+namespace {
+
+const char cacheMagic[8] = {'H', 'Y', 'M', 'L', 'S', 'S', 'C', 'H'};
+const int cacheVersion = 1;
+
+  }
 
 // private constructor
 SchurPreconditioner::SchurPreconditioner(
@@ -79,12 +90,15 @@ SchurPreconditioner::SchurPreconditioner(
     sparseMatrixOT_(Teuchos::null),
     matrix_(Teuchos::null),
     nextLevelHID_(Teuchos::null),
-    useTranspose_(false), haveBorder_(false), normInf_(-1.0),
-    label_("SchurPreconditioner"),
+    useTranspose_(false), haveBorder_(false), lowRankBorder_(false),
+    agglomerationThreshold_(0), threadBudget_(-1),
+    normInf_(-1.0), label_("SchurPreconditioner"),
     initialized_(false), computed_(false),
     numInitialize_(0), numCompute_(0), numApplyInverse_(0),
     flopsInitialize_(0.0), flopsCompute_(0.0), flopsApplyInverse_(0.0),
-    timeInitialize_(0.0), timeCompute_(0.0), timeApplyInverse_(0.0)
+    timeInitialize_(0.0), timeCompute_(0.0), timeApplyInverse_(0.0),
+    bytesApplyInverse_(0.0),
+    matrixKey_(0), cacheRead_(false)
   {
   HYMLS_LPROF3(label_, "Constructor (1)");
   time_ = Teuchos::rcp(new Epetra_Time(*comm_));
@@ -150,6 +164,9 @@ int SchurPreconditioner::SetParameters(Teuchos::ParameterList &List)
   denseSwitch_ = PL().get("Dense Solvers on Level", denseSwitch_);
   applyDropping_ = PL().get("Apply Dropping", true);
   applyOT_ = PL().get("Apply Orthogonal Transformation", applyDropping_);
+  cacheFile_ = PL().get("Schur Complement Cache", "");
+  lowRankBorder_ = PL().get("Low-Rank Border Update", lowRankBorder_);
+  agglomerationThreshold_ = PL().get("Agglomeration Threshold", agglomerationThreshold_);
 
   if (reducedSchurSolver_ != Teuchos::null)
     {
@@ -188,6 +205,7 @@ int SchurPreconditioner::Initialize()
   sparseMatrixOT_ = Teuchos::null;
   matrix_ = Teuchos::null;
   reducedSchurSolver_ = Teuchos::null;
+  agglomeratedSolver_ = Teuchos::null;
   blockSolver_.resize(0);
 
   CHECK_ZERO(InitializeOT());
@@ -214,7 +232,29 @@ int SchurPreconditioner::Initialize()
     bool status = true;
     try
       {
-      nextLevelHID_ = hid_->SpawnNextLevel(vsumMap_, overlappingVsumMap_);
+      // If the next level is small, solve it on fewer processors
+      int numProc = AgglomeratedSolver::NumAgglomeratedProcs(
+        *vsumMap_, agglomerationThreshold_);
+      if (numProc < comm_->NumProc() &&
+        PL().get("Partitioner", "Cartesian") == "Graph")
+        {
+        Tools::Warning("'Agglomeration Threshold' is ignored with the 'Graph' "
+          "partitioner", __FILE__, __LINE__);
+        numProc = comm_->NumProc();
+        }
+      if (numProc < comm_->NumProc())
+        {
+        Tools::Out("Agglomerate level " + Teuchos::toString(myLevel_ + 1) +
+          " with " + Teuchos::toString(vsumMap_->NumGlobalElements64()) +
+          " unknowns on " + Teuchos::toString(numProc) + " processors");
+        agglomeratedSolver_ = Teuchos::rcp(new AgglomeratedSolver(
+            vsumMap_, hid_, numProc, myLevel_ + 1));
+        nextLevelHID_ = Teuchos::null;
+        }
+      else
+        {
+        nextLevelHID_ = hid_->SpawnNextLevel(vsumMap_, overlappingVsumMap_);
+        }
       } TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, status);
     if (!status) Tools::Fatal("Failed to create next level ordering", __FILE__, __LINE__);
     }
@@ -266,15 +306,31 @@ int SchurPreconditioner::Compute()
       __FILE__, __LINE__);
     }
 
-  if (!applyDropping_)
+  // Assembling the Schur complement is the most expensive part,
+  // so if it was stored before for the same matrix we skip it.
+  int cacheRead = -1;
+  unsigned long long cacheKey = 0;
+  if (!cacheFile_.empty())
     {
-    CHECK_ZERO(Assemble());
+    cacheKey = CacheKey();
+    cacheRead = ReadCache(cacheKey);
+    if (cacheRead == 0)
+      {
+      Tools::Out("Schur complement of level " + Teuchos::toString(myLevel_) +
+        " read from " + cacheFile_);
+      }
     }
-  else
+
+  if (cacheRead != 0)
     {
-    CHECK_ZERO(AssembleTransformAndDrop());
+    CHECK_ZERO(AssembleMatrix());
     }
 
+  if (!cacheFile_.empty() && cacheRead != 0)
+    CHECK_ZERO(WriteCache(cacheKey));
+
+  cacheRead_ = (cacheRead == 0);
+
   CHECK_ZERO(ComputeNextLevel());
 
 #ifdef HYMLS_STORE_MATRICES
@@ -326,14 +382,17 @@ int SchurPreconditioner::InitializeBlocks()
       CHECK_ZERO(blockSolver_.back()->SetParameters(PL().sublist("Dense Solver")));
       CHECK_ZERO(blockSolver_.back()->Initialize());
 
+      // map_ is the Map() of the sepObject
       int k = 0;
       for (SeparatorGroup const &group : linked_groups)
+        {
+        Teuchos::ArrayView<const int> lids = sepObject->LIDs(group);
         for (int j = 1; j < group.length(); j++)
           {
           // skip first element, which is a Vsum
-          int LRID = map_->LID(group[j]);
-          blockSolver_.back()->ID(k++) = LRID;
+          blockSolver_.back()->ID(k++) = lids[j];
           }
+        }
       }
     }
   return 0;
@@ -371,11 +430,9 @@ int SchurPreconditioner::InitializeSingleBlock()
     for (SeparatorGroup const &group : sepObject->GetSeparatorGroups(sd))
       {
       // skip first element, which is a Vsum
+      Teuchos::ArrayView<const int> lids = sepObject->LIDs(group);
       for (int j = 1; j < group.length(); j++)
-        {
-        int LRID = map_->LID(group[j]);
-        blockSolver_[0]->ID(pos++) = LRID;
-        }
+        blockSolver_[0]->ID(pos++) = lids[j];
       }
     }
   return 0;
@@ -432,12 +489,13 @@ int SchurPreconditioner::InitializeOT()
           }
 
         int pos = 0;
-        for (hymls_gidx gid : group.nodes())
+        Teuchos::ArrayView<const int> lids = sepObject->LIDs(group);
+        for (int j = 0; j < len; j++)
           {
-          int lid = sepMap.LID(gid);
+          int lid = lids[j];
           if (lid != -1)
             {
-            inds[pos] = gid;
+            inds[pos] = group[j];
             vec[pos++] = localTestVector[lid];
             }
           }
@@ -575,9 +633,14 @@ int SchurPreconditioner::ComputeNextLevel()
       // create another level of HYMLS::Preconditioner
       Teuchos::RCP<Teuchos::ParameterList> nextLevelParams =
         Teuchos::rcp(new Teuchos::ParameterList(*getMyParamList()));
-      if (myLevel_ >= denseSwitch_ - 1)
+      Teuchos::ParameterList &nextPrecList = nextLevelParams->sublist("Preconditioner");
+      // Inner iterations are only done on the first level. On the next levels
+      // they would make the preconditioner of the inner GMRES variable.
+      nextPrecList.set("Schur Complement Iterations", 0);
+      if (myLevel_ >= denseSwitch_ - 1 &&
+        nextPrecList.get("Subdomain Solver Type", "Sparse") != "Auto")
         {
-        nextLevelParams->sublist("Preconditioner").set("Subdomain Solver Type", "Dense");
+        nextPrecList.set("Subdomain Solver Type", "Dense");
         }
 
       //TODO: move the direct solver thing to the Preconditioner class and rename
@@ -586,9 +649,24 @@ int SchurPreconditioner::ComputeNextLevel()
       //      object for the reduced problem (this is partially done, but we still
       //      also call the direct solver here since this is probably faster, but
       //      this has to be checked).
-      reducedSchurSolver_ = Teuchos::rcp(new
-        Preconditioner(reducedSchur, nextLevelParams,
-          nextTestVector, myLevel_ + 1, nextLevelHID_));
+      if (agglomeratedSolver_ != Teuchos::null)
+        {
+        CHECK_ZERO(agglomeratedSolver_->SetMatrix(reducedSchur,
+            nextLevelParams, nextTestVector));
+        reducedSchurSolver_ = agglomeratedSolver_;
+        }
+      else
+        {
+        Teuchos::RCP<Preconditioner> prec = Teuchos::rcp(new
+          Preconditioner(reducedSchur, nextLevelParams,
+            nextTestVector, myLevel_ + 1, nextLevelHID_));
+        prec->SetThreadBudget(threadBudget_);
+        reducedSchurSolver_ = prec;
+        }
+      }
+    else if (agglomeratedSolver_ != Teuchos::null)
+      {
+      CHECK_ZERO(agglomeratedSolver_->SetMatrix(reducedSchur));
       }
     else
       {
@@ -663,6 +741,15 @@ int SchurPreconditioner::ComputeBorder()
   return 0;
   }
 
+int SchurPreconditioner::AssembleMatrix()
+  {
+  if (!applyDropping_)
+    {
+    return Assemble();
+    }
+  return AssembleTransformAndDrop();
+  }
+
 int SchurPreconditioner::Assemble()
   {
   HYMLS_LPROF2(label_, "Assemble");
@@ -874,6 +961,163 @@ int SchurPreconditioner::AssembleTransformAndDrop()
   return 0;
   }
 
+std::string SchurPreconditioner::CacheFileName() const
+  {
+  return cacheFile_ + "." + Teuchos::toString(myLevel_) + "." +
+    Teuchos::toString(comm_->MyPID()) + ".schur.bin";
+  }
+
+unsigned long long SchurPreconditioner::CacheKey() const
+  {
+  HYMLS_LPROF3(label_, "CacheKey");
+
+  unsigned long long key = cacheHashInit;
+
+  int header[5] = {myLevel_, comm_->NumProc(), comm_->MyPID(),
+                   (int)sizeof(hymls_gidx), applyDropping_};
+  key = CacheHash(key, header, sizeof(header));
+  key = CacheHash(key, &matrixKey_, sizeof(matrixKey_));
+
+  // All parameters, without the used/default flags that change
+  // when they are accessed
+  std::ostringstream ss;
+  getMyParamList()->print(ss, Teuchos::ParameterList::PrintOptions().showFlags(false));
+  std::string str = ss.str();
+  key = CacheHash(key, str.c_str(), str.size());
+
+  Teuchos::Array<hymls_gidx> gids = MyGIDs(*map_);
+  key = CacheHash(key, gids.getRawPtr(), gids.size() * sizeof(hymls_gidx));
+
+  // the orthogonal transformation depends on the test vector
+  if (testVector_ != Teuchos::null && testVector_->MyLength() > 0)
+    key = CacheHash(key, testVector_->Values(), testVector_->MyLength() * sizeof(double));
+
+  return key;
+  }
+
+int SchurPreconditioner::ReadCache(unsigned long long key)
+  {
+  HYMLS_LPROF2(label_, "ReadCache");
+
+  Teuchos::Array<hymls_gidx> rowGIDs;
+  Teuchos::Array<hymls_gidx> colGIDs;
+  Teuchos::Array<int> rowPtr;
+  Teuchos::Array<int> colInds;
+  Teuchos::Array<double> values;
+
+  std::ifstream is(CacheFileName().c_str(), std::ios::binary);
+
+  bool success = is.good();
+
+  char magic[8];
+  int version;
+  unsigned long long fileKey;
+  success = success && CacheRead(is, magic) &&
+    std::equal(magic, magic + 8, cacheMagic) &&
+    CacheRead(is, version) && version == cacheVersion &&
+    CacheRead(is, fileKey) && fileKey == key;
+
+  success = success && CacheRead(is, rowGIDs) && CacheRead(is, colGIDs) &&
+    CacheRead(is, rowPtr) && CacheRead(is, colInds) && CacheRead(is, values);
+
+  // check the consistency, so we can safely insert the values below
+  success = success && rowGIDs == MyGIDs(*map_) &&
+    rowPtr.size() == rowGIDs.size() + 1 && rowPtr[0] == 0 &&
+    rowPtr.back() == colInds.size() && colInds.size() == values.size();
+  for (int i = 0; success && i < rowGIDs.size(); i++)
+    success = rowPtr[i] <= rowPtr[i+1];
+  for (int j = 0; success && j < colInds.size(); j++)
+    success = colInds[j] >= 0 && colInds[j] < colGIDs.size();
+
+  // Everyone has to be able to read the cache, otherwise we
+  // assemble as usual.
+  int mySuccess = success;
+  int allSuccess = 0;
+  CHECK_ZERO(comm_->MinAll(&mySuccess, &allSuccess, 1));
+  if (!allSuccess)
+    {
+    Tools::Out("No valid Schur complement cache for level " + Teuchos::toString(myLevel_));
+    return 1;
+    }
+
+  Epetra_Map colMap((hymls_gidx)(-1), colGIDs.size(), colGIDs.getRawPtr(),
+    (hymls_gidx)map_->IndexBase64(), *comm_);
+
+  Teuchos::Array<int> rowLengths(rowGIDs.size());
+  for (int i = 0; i < rowGIDs.size(); i++)
+    rowLengths[i] = rowPtr[i+1] - rowPtr[i];
+
+  // AssembleTransformAndDrop() reuses the pattern of an FECrsMatrix
+  // in the next Compute(), Assemble() does not.
+  Teuchos::RCP<Epetra_CrsMatrix> matrix;
+  if (applyDropping_)
+    matrix = Teuchos::rcp(new Epetra_FECrsMatrix(Copy, *map_, colMap,
+        rowLengths.getRawPtr()));
+  else
+    matrix = Teuchos::rcp(new Epetra_CrsMatrix(Copy, *map_, colMap,
+        rowLengths.getRawPtr(), true));
+
+  for (int i = 0; i < rowGIDs.size(); i++)
+    {
+    if (rowLengths[i] == 0)
+      continue;
+    CHECK_ZERO(matrix->InsertMyValues(i, rowLengths[i],
+        &values[rowPtr[i]], &colInds[rowPtr[i]]));
+    }
+  CHECK_ZERO(matrix->FillComplete(*map_, *map_));
+
+  matrix_ = matrix;
+
+  return 0;
+  }
+
+int SchurPreconditioner::WriteCache(unsigned long long key) const
+  {
+  HYMLS_LPROF2(label_, "WriteCache");
+
+  std::ofstream os(CacheFileName().c_str(), std::ios::binary | std::ios::trunc);
+  if (!os.good())
+    {
+    Tools::Warning("Could not open " + CacheFileName() + " for writing",
+      __FILE__, __LINE__);
+    return 0;
+    }
+
+  Teuchos::Array<int> rowPtr(matrix_->NumMyRows() + 1, 0);
+  Teuchos::Array<int> colInds;
+  Teuchos::Array<double> values;
+  colInds.reserve(matrix_->NumMyNonzeros());
+  values.reserve(matrix_->NumMyNonzeros());
+
+  int len;
+  int *indices;
+  double *rowValues;
+  for (int i = 0; i < matrix_->NumMyRows(); i++)
+    {
+    CHECK_ZERO(matrix_->ExtractMyRowView(i, len, rowValues, indices));
+    colInds.insert(colInds.end(), indices, indices + len);
+    values.insert(values.end(), rowValues, rowValues + len);
+    rowPtr[i+1] = rowPtr[i] + len;
+    }
+
+  CacheWrite(os, cacheMagic);
+  CacheWrite(os, cacheVersion);
+  CacheWrite(os, key);
+
+  CacheWrite(os, MyGIDs(matrix_->RowMap()));
+  CacheWrite(os, MyGIDs(matrix_->ColMap()));
+  CacheWrite(os, rowPtr);
+  CacheWrite(os, colInds);
+  CacheWrite(os, values);
+
+  if (!os.good())
+    {
+    Tools::Warning("Could not write " + CacheFileName(), __FILE__, __LINE__);
+    }
+
+  return 0;
+  }
+
 int SchurPreconditioner::ConstructSCPart(int sd, Epetra_Vector const &localTestVector,
   Epetra_SerialDenseMatrix &Sk,
 #ifdef HYMLS_LONG_LONG
@@ -892,11 +1136,21 @@ int SchurPreconditioner::ConstructSCPart(int sd, Epetra_Vector const &localTestV
   Epetra_SerialDenseVector v;
 
   // Get the part of the testvector that belongs to the
-  // separators
-  const Epetra_BlockMap &sepMap = localTestVector.Map();
+  // separators. The indices are the separator nodes of the
+  // subdomain group by group, and the testvector is in the
+  // OverlappingMap() of the separator object.
+  Teuchos::RCP<const HierarchicalMap> sepObject
+    = hid_->Spawn(HierarchicalMap::Separators);
   v.Resize(indices.Length());
-  for (int i = 0; i < indices.Length(); i++)
-    v[i] = localTestVector[sepMap.LID(indices[i])];
+  int k = 0;
+  for (SeparatorGroup const &group : hid_->GetSeparatorGroups(sd))
+    for (int lid : sepObject->OverlappingLIDs(group))
+      v[k++] = localTestVector[lid];
+
+#ifdef HYMLS_TESTING
+  if (k != indices.Length())
+    Tools::Error("separator nodes do not match the indices", __FILE__, __LINE__);
+#endif
 
   const int numVSums = hid_->NumSeparatorGroups(sd);
 
@@ -910,6 +1164,8 @@ int SchurPreconditioner::ConstructSCPart(int sd, Epetra_Vector const &localTestV
   Epetra_IntSerialDenseVector &VSumIndices = *indicesArray.back();
 #endif
 
+  Teuchos::Array<int> VSumLIDs(numVSums);
+
   int i = 0, j = 0, pos = 0;
   // Loop over all separators of the subdomain sd
   for (SeparatorGroup const &group : hid_->GetSeparatorGroups(sd))
@@ -922,30 +1178,24 @@ int SchurPreconditioner::ConstructSCPart(int sd, Epetra_Vector const &localTestV
     // separately
     RestrictedOT::Apply(Sk, pos, *OT_, vView);
 
+    // Index of the Vsum in Sk, which is based on the spawned
+    // separator map of the subdomain
+    VSumLIDs[i] = hid_->SubdomainOffset(sd, group);
+
     VSumIndices[i++] = indices[pos];
 
     pos += len;
     }
 
-  Teuchos::RCP<const Epetra_Map> map = hid_->SpawnMap(sd, HierarchicalMap::Separators);
-
   // Only add Vsum-Vsum couplings and non-Vsums. This is way faster than
   // than trying to add all the values and letting SumIntoGlobalValues
   // decide which ones to drop.
-  i = 0;
-  for (SeparatorGroup const &group1 : hid_->GetSeparatorGroups(sd))
-    {
-    HYMLS_LPROF3(label_, "Compute non-dropped Vsum part");
-
-    j = 0;
-    const int lid1 = map->LID(group1[0]);
-    for (SeparatorGroup const &group2 : hid_->GetSeparatorGroups(sd))
-      {
-      const int lid2 = map->LID(group2[0]);
-      VSumSk(i, j++) = Sk(lid1, lid2);
-      }
-    i++;
-    }
+  {
+  HYMLS_LPROF3(label_, "Compute non-dropped Vsum part");
+  for (i = 0; i < numVSums; i++)
+    for (j = 0; j < numVSums; j++)
+      VSumSk(i, j) = Sk(VSumLIDs[i], VSumLIDs[j]);
+  }
 
   for (auto const &linked_groups : hid_->GetLinkedSeparatorGroups(sd))
     {
@@ -968,14 +1218,17 @@ int SchurPreconditioner::ConstructSCPart(int sd, Epetra_Vector const &localTestV
 
     int i = 0;
     for (SeparatorGroup const &group : linked_groups)
+      {
+      const int offset = hid_->SubdomainOffset(sd, group);
       for (int j = 1; j < group.length(); j++)
         {
         hymls_gidx gid = group[j];
-        HYMLS_DEBUG(i << " " << j << " " << gid << " " << map->LID(gid));
+        HYMLS_DEBUG(i << " " << j << " " << gid << " " << offset + j);
         globalIndices[i] = gid;
-        localIndices[i] = map->LID(gid);
+        localIndices[i] = offset + j;
         i++;
         }
+      }
 
     for (int i = 0; i < len; i++)
       for (int j = 0; j < len; j++)
@@ -1074,8 +1327,10 @@ int SchurPreconditioner::ApplyInverse(const Epetra_MultiVector &X,
     }
 
   CHECK_ZERO(vsumRhs_->Import(Y, *vsumImporter_, Insert));
+  bytesApplyInverse_ += PerformanceReport::Bytes(*vsumImporter_, Y.NumVectors());
   CHECK_ZERO(reducedSchurSolver_->ApplyInverse(*vsumRhs_, *vsumSol_));
   CHECK_ZERO(Y.Export(*vsumSol_, *vsumImporter_, Insert));
+  bytesApplyInverse_ += PerformanceReport::Bytes(*vsumImporter_, Y.NumVectors(), true);
 
   // transform back
   CHECK_ZERO(ApplyOT(false, Y, &flopsApplyInverse_));
@@ -1155,6 +1410,22 @@ double SchurPreconditioner::ApplyInverseFlops() const
   }
 
 
+void SchurPreconditioner::AddToReport(PerformanceReport &report) const
+  {
+  HYMLS_LPROF3(label_, "AddToReport");
+
+  report.Add(myLevel_, "ApplyInverse", "bytes", bytesApplyInverse_);
+
+  Teuchos::RCP<const Preconditioner> prec =
+    Teuchos::rcp_dynamic_cast<const Preconditioner>(reducedSchurSolver_);
+  if (agglomeratedSolver_ != Teuchos::null)
+    agglomeratedSolver_->AddToReport(report);
+  else if (prec != Teuchos::null)
+    prec->AddToReport(report);
+  else if (reducedSchurSolver_ != Teuchos::null)
+    report.AddOperator(myLevel_ + 1, *reducedSchurSolver_);
+  }
+
 // Computes the condition number estimate, returns its value.
 double SchurPreconditioner::Condest(const Ifpack_CondestType CT,
   const int MaxIters,
@@ -1468,7 +1739,9 @@ int SchurPreconditioner::UpdateVsumRhs(const Epetra_MultiVector &B, Epetra_Multi
 // | W1  W2   C |. We already have M11 and M22 facored, but
 // we need to add a border to M22 and factor it again on the
 // coarsest level. On intermediate levelswe just need to compute
-// the border for M22 and pass it to the next level. M12 and M21
+// the border for M22 and pass it to the next level. With a low-rank
+// border update the factorizations are kept and the coarsest level
+// only factors a small capacitance matrix. M12 and M21
 // are currently assumed to be zero (block diagonal preconditioner)
 //
 int SchurPreconditioner::SetBorder(Teuchos::RCP<const Epetra_MultiVector> V,
@@ -1501,6 +1774,13 @@ int SchurPreconditioner::SetBorder(Teuchos::RCP<const Epetra_MultiVector> V,
   C_ = C;
 
   haveBorder_ = true;
+
+  // only transform the border and pass it on to the next level
+  if (lowRankBorder_ && IsComputed() && !isEmpty_)
+    {
+    return ComputeBorder();
+    }
+
   computed_ = false;
 
   return 0;
@@ -1586,6 +1866,7 @@ int SchurPreconditioner::ApplyInverse(const Epetra_MultiVector &X,
     }
 
   CHECK_ZERO(vsumRhs_->Import(B, *vsumImporter_, Insert));
+  bytesApplyInverse_ += PerformanceReport::Bytes(*vsumImporter_, B.NumVectors());
 
   // compute W1'(M11\F1). note zeros in X2
   Epetra_SerialDenseMatrix Tcopy(T);
@@ -1601,6 +1882,7 @@ int SchurPreconditioner::ApplyInverse(const Epetra_MultiVector &X,
 
   // copy into Y
   CHECK_ZERO(Y.Export(*vsumSol_, *vsumImporter_, Insert));
+  bytesApplyInverse_ += PerformanceReport::Bytes(*vsumImporter_, Y.NumVectors(), true);
 
   // transform back
   CHECK_ZERO(ApplyOT(false, Y, &flopsApplyInverse_));
@@ -1647,6 +1929,8 @@ void SchurPreconditioner::Visualize(std::string mfilename, bool recurse) const
       Teuchos::RCP<const HYMLS::Preconditioner> hymls =
         Teuchos::rcp_dynamic_cast<const HYMLS::Preconditioner>(reducedSchurSolver_);
       if (!Teuchos::is_null(hymls)) hymls->Visualize(mfilename);
+      else if (!Teuchos::is_null(agglomeratedSolver_))
+        agglomeratedSolver_->Visualize(mfilename);
       }
     }
   }
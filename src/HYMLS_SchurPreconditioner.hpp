@@ -41,10 +41,12 @@ class ParameterList;
 namespace HYMLS
   {
 
+class AgglomeratedSolver;
 class Epetra_Time;
 class HierarchicalMap;
 class OrthogonalTransform;
 class OverlappingPartitioner;
+class PerformanceReport;
 class SchurComplement;
 
 //! Approximation of the Schur-complement
@@ -90,6 +92,19 @@ public:
   //! write matlab data for visualization
   void Visualize(std::string filename, bool recurse = true) const;
 
+  //! set the checksum of the matrix from which the Schur complement
+  //! is computed. This is used to decide if the assembled Schur
+  //! complement in the "Schur Complement Cache" can be used.
+  void SetCacheKey(unsigned long long key) {matrixKey_ = key;}
+
+  //! true if the assembled Schur complement was read from the
+  //! "Schur Complement Cache" in the last call to Compute()
+  bool ReadFromCache() const {return cacheRead_;}
+
+  //! Passed on to the Preconditioner of the next level,
+  //! see Preconditioner::SetThreadBudget()
+  void SetThreadBudget(int coresPerThread) {threadBudget_ = coresPerThread;}
+
   //!\name Ifpack_Preconditioner interface
 
   //@{
@@ -170,6 +185,18 @@ public:
   //! Prints basic information on iostream. This function is used by operator<<.
   std::ostream &Print(std::ostream &os) const;
 
+  //! solver for the next level, which is either a Preconditioner,
+  //! an AgglomeratedSolver or a CoarseSolver
+  Teuchos::RCP<const Ifpack_Preconditioner> NextLevel() const
+    {
+    return reducedSchurSolver_;
+    }
+
+  //! Add the performance data of the levels below to a report.
+  //! The data of this object is part of the level of the
+  //! Preconditioner that created it.
+  void AddToReport(PerformanceReport &report) const;
+
   int SetUseTranspose(bool UseTranspose)
     {
     useTranspose_ = false; // not implemented.
@@ -242,6 +269,12 @@ public:
 
 protected:
 
+  //! Assemble the Schur complement and apply the orthogonal
+  //! transformation and dropping. This is the part of Compute()
+  //! that does not factor the blocks or compute the next level,
+  //! and is protected so it can be timed on its own.
+  int AssembleMatrix();
+
   //! communicator
   Teuchos::RCP<const Epetra_Comm> comm_;
 
@@ -302,9 +335,13 @@ protected:
   //! importer for Vsum nodes
   Teuchos::RCP<Epetra_Import> vsumImporter_;
 
-  //! partitioner for the next level
+  //! partitioner for the next level (null if it is agglomerated)
   Teuchos::RCP<const OverlappingPartitioner> nextLevelHID_;
 
+  //! solver for the next level on fewer processors, see
+  //! "Agglomeration Threshold" (null if not agglomerated)
+  Teuchos::RCP<AgglomeratedSolver> agglomeratedSolver_;
+
   //! right-hand side and solution for the reduced SC (based on linear map)
   mutable Teuchos::RCP<Epetra_MultiVector> vsumRhs_, vsumSol_;
 
@@ -319,6 +356,17 @@ protected:
   //! true if addBorder() has been called with non-null args
   bool haveBorder_;
 
+  //! keep the factorizations if the border changes, see
+  //! "Low-Rank Border Update"
+  bool lowRankBorder_;
+
+  //! minimum number of nodes per processor on the next level,
+  //! see "Agglomeration Threshold"
+  int agglomerationThreshold_;
+
+  //! see SetThreadBudget(), -1 if not set
+  int threadBudget_;
+
   //! infinity norm
   double normInf_;
 
@@ -365,8 +413,21 @@ protected:
   //! time during ApplyInverse()
   mutable double timeApplyInverse_;
 
+  //! bytes sent to other processes during ApplyInverse()
+  mutable double bytesApplyInverse_;
+
   mutable bool dumpVectors_;
 
+  //! prefix of the files in which the assembled Schur complement
+  //! is cached (empty if no cache is used)
+  std::string cacheFile_;
+
+  //! checksum of the matrix from which the Schur complement is computed
+  unsigned long long matrixKey_;
+
+  //! true if the last Compute() read the Schur complement from the cache
+  bool cacheRead_;
+
   //! \name data structures for bordering
 
   //! border split up and transformed by Householder
@@ -379,6 +440,21 @@ private:
   //! Initialize orthogonal transform
   int InitializeOT();
 
+  //! name of the cache file of this level and processor
+  std::string CacheFileName() const;
+
+  //! checksum of everything the assembled Schur complement depends
+  //! on, which has to match the one in the cache file
+  unsigned long long CacheKey() const;
+
+  //! read the assembled Schur complement from the cache file instead
+  //! of computing it. Returns nonzero (on all processors) if the
+  //! cache does not exist or does not match on one of them.
+  int ReadCache(unsigned long long key);
+
+  //! write the assembled Schur complement to the cache file
+  int WriteCache(unsigned long long key) const;
+
   //! Assemble the Schur complement of the Preconditioner
   //! object creating this SchurPreconditioner.
   int Assemble();
@@ -1,42 +1,84 @@
 #include "HYMLS_SeparatorGroup.hpp"
 
+#include <algorithm>
+#include <iostream>
+
 namespace HYMLS
   {
 
+std::ostream &operator<<(std::ostream &os, GroupNodes const &nodes)
+  {
+  os << "{";
+  for (int i = 0; i < nodes.size(); i++)
+    os << (i ? ", " : "") << nodes[i];
+  os << "}";
+  return os;
+  }
+
 SeparatorGroup::SeparatorGroup()
   :
     nodes_(new Teuchos::Array<hymls_gidx>()),
+    offset_(0),
+    length_(-1),
     type_(-1)
   {}
 
+SeparatorGroup::SeparatorGroup(
+  Teuchos::RCP<Teuchos::Array<hymls_gidx> > const &nodes,
+  int offset, int length, int type)
+  :
+    nodes_(nodes),
+    offset_(offset),
+    length_(length),
+    type_(type)
+  {}
+
+hymls_gidx const *SeparatorGroup::data() const
+  {
+  return nodes_->getRawPtr() + offset_;
+  }
+
 hymls_gidx const &SeparatorGroup::operator[](int i) const
   {
-  return (*nodes_)[i];
+  return data()[i];
   }
 
 Teuchos::Array<hymls_gidx> &SeparatorGroup::nodes()
   {
+  if (length_ >= 0)
+    {
+    // Don't modify the array we share with other groups
+    nodes_ = Teuchos::rcp(new Teuchos::Array<hymls_gidx>(
+        data(), data() + length_));
+    offset_ = 0;
+    length_ = -1;
+    }
   return *nodes_;
   }
 
-Teuchos::Array<hymls_gidx> const &SeparatorGroup::nodes() const
+GroupNodes SeparatorGroup::nodes() const
   {
-  return *nodes_;
+  return GroupNodes(data(), data() + length());
   }
 
 int SeparatorGroup::length() const
   {
-  return nodes_->length();
+  return length_ >= 0 ? length_ : nodes_->length();
+  }
+
+int SeparatorGroup::offset() const
+  {
+  return length_ >= 0 ? offset_ : -1;
   }
 
 Teuchos::Array<hymls_gidx> &SeparatorGroup::append(hymls_gidx gid)
   {
-  return nodes_->append(gid);
+  return nodes().append(gid);
   }
 
 void SeparatorGroup::sort()
   {
-  std::sort(nodes_->begin(), nodes_->end());
+  std::sort(nodes().begin(), nodes().end());
   }
 
 int SeparatorGroup::type() const
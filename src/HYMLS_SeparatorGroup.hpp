@@ -6,26 +6,83 @@
 
 #include "HYMLS_config.h"
 
+#include <iosfwd>
+
 namespace HYMLS
   {
 
+//! Read-only view of the nodes of a group. It can be used like
+//! a constant Teuchos::Array in range based for loops and STL
+//! algorithms, but does not own any memory.
+class GroupNodes
+  {
+  hymls_gidx const *begin_;
+
+  hymls_gidx const *end_;
+
+public:
+  typedef hymls_gidx value_type;
+  typedef hymls_gidx const *const_iterator;
+  typedef int size_type;
+
+  GroupNodes(hymls_gidx const *begin, hymls_gidx const *end)
+    :
+    begin_(begin), end_(end)
+    {}
+
+  hymls_gidx const *begin() const {return begin_;}
+
+  hymls_gidx const *end() const {return end_;}
+
+  int size() const {return end_ - begin_;}
+
+  bool empty() const {return begin_ == end_;}
+
+  hymls_gidx const &operator[](int i) const {return begin_[i];}
+  };
+
+std::ostream &operator<<(std::ostream &os, GroupNodes const &nodes);
+
+//! A group of nodes of a subdomain. The nodes are either stored in
+//! an array of the group itself, which is shared between copies of
+//! the group, or in a part of a larger array that is shared by many
+//! groups. The HierarchicalMap stores all its groups in the latter
+//! way to avoid an allocation for every group. Such a group gets its
+//! own array as soon as it is modified.
 class SeparatorGroup
   {
   Teuchos::RCP<Teuchos::Array<hymls_gidx> > nodes_;
 
+  //! offset and length of the nodes in nodes_. length_ is -1 if
+  //! the group owns all of nodes_
+  int offset_;
+
+  int length_;
+
   int type_;
 
+  hymls_gidx const *data() const;
+
 public:
   SeparatorGroup();
 
+  //! group that refers to length nodes in an array shared with
+  //! other groups, starting at offset
+  SeparatorGroup(Teuchos::RCP<Teuchos::Array<hymls_gidx> > const &nodes,
+    int offset, int length, int type);
+
   hymls_gidx const &operator[](int i) const;
 
   Teuchos::Array<hymls_gidx> &nodes();
 
-  Teuchos::Array<hymls_gidx> const &nodes() const;
+  GroupNodes nodes() const;
 
   int length() const;
 
+  //! offset of the nodes in the array that is shared with other
+  //! groups, -1 if the group has an array of its own
+  int offset() const;
+
   Teuchos::Array<hymls_gidx> &append(hymls_gidx gid);
 
   void sort();
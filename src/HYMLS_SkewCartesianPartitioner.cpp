@@ -319,7 +319,9 @@ int SkewCartesianPartitioner::Partition(bool repart)
 
   CHECK_ZERO(CreatePIDMap());
 
-  if (nprocs_ < comm_->NumProc())
+  // with weights the processor partitioning differs from the
+  // one of the input map
+  if (nprocs_ < comm_->NumProc() || weights_ != Teuchos::null)
     repart = true;
 
   if (comm_->MyPID() >= nprocs_)
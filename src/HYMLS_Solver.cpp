@@ -201,6 +201,11 @@ int Solver::getNumIter() const
   return solver_->getNumIter();
   }
 
+void Solver::AddToReport(PerformanceReport &report) const
+  {
+  solver_->AddToReport(report);
+  }
+
 int Solver::SetBorder(Teuchos::RCP<const Epetra_MultiVector> const &V,
   Teuchos::RCP<const Epetra_MultiVector> const &W,
   Teuchos::RCP<const Epetra_SerialDenseMatrix> const &C)
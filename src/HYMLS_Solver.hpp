@@ -23,6 +23,7 @@ class ParameterList;
 namespace HYMLS {
 
 class BaseSolver;
+class PerformanceReport;
 
 /*! iterative solver class, basically
   an Epetra wrapper for Belos extended with
@@ -108,6 +109,9 @@ public:
   //! get number of iterations performed in last ApplyInverse() call
   int getNumIter() const;
 
+  //! Add the number of solves and iterations to a report (level 0)
+  void AddToReport(PerformanceReport &report) const;
+
   //! For singular problems with a known null space, add the null space
   //! as a border so that in fact the linear system
   //!
@@ -19,7 +19,13 @@
 #include "Teuchos_StrUtils.hpp"
 #include <cstdarg>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #ifdef HAVE_PARDISO
@@ -29,6 +35,7 @@ extern "C" {
 
 #ifdef HAVE_SUITESPARSE
 #include "umfpack.h"
+#include "cholmod.h"
 #include "klu.h"
 #define T_KLU(xxx) xxx
 #define DO_KLU(function) klu_ ## function
@@ -52,8 +59,19 @@ extern "C" {
     T_KLU(klu_common) *Common_;
     };
 
+#ifdef HAVE_SUITESPARSE
+  class CholmodWrapper
+    {
+  public:
+
+    cholmod_factor *Factor_;
+    cholmod_common *Common_;
+    };
+#endif
+
   static std::ostream* output_stream;
   static int firstTime=true;
+  static std::atomic<bool> firstNotDefinite(true);
 
   int my_printf(const char* fmt, ...)
     {
@@ -82,10 +100,21 @@ SparseDirectSolver::SparseDirectSolver(Epetra_RowMatrix* Matrix_in) :
   IsComputed_(false),
   UseTranspose_(false),
   Condest_(-1.0),
+  NumInitialize_(0),
+  NumCompute_(0),
+  NumApplyInverse_(0),
+  InitializeTime_(0.0),
+  ComputeTime_(0.0),
+  ApplyInverseTime_(0.0),
+  InitializeFlops_(0.0),
+  ComputeFlops_(0.0),
+  ApplyInverseFlops_(0.0),
   serialMatrix_(Teuchos::null),
   serialImport_(Teuchos::null),
   ownOrdering_(false), ownScaling_(false),
-  pardiso_initialized_(false)
+  pardiso_initialized_(false),
+  cholmod_(NULL), cholmodSign_(1.0),
+  haveCRSPattern_(false)
   {
   HYMLS_PROF3(label_,"Constructor");
 
@@ -138,6 +167,16 @@ SparseDirectSolver::~SparseDirectSolver()
     delete klu_->Common_;
     }
 #ifdef HAVE_SUITESPARSE
+  if (cholmod_)
+    {
+    if (cholmod_->Factor_)
+      {
+      cholmod_free_factor(&cholmod_->Factor_, cholmod_->Common_);
+      }
+    cholmod_finish(cholmod_->Common_);
+    delete cholmod_->Common_;
+    delete cholmod_;
+    }
   if (umf_Symbolic_)
     {
     umfpack_di_free_symbolic (&umf_Symbolic_) ;
@@ -184,6 +223,11 @@ int SparseDirectSolver::SetParameters(Teuchos::ParameterList& params)
     method_=UMFPACK;
     label2="Umfpack";
     }
+  else if (choice=="CHOLMOD"||choice=="AMESOS_CHOLMOD")
+    {
+    method_=CHOLMOD;
+    label2="Cholmod";
+    }
   else
 #endif
 #ifdef HAVE_PARDISO
@@ -211,14 +255,24 @@ int SparseDirectSolver::SetParameters(Teuchos::ParameterList& params)
     DO_KLU(defaults)(klu_->Common_);
     }
 #ifdef HAVE_SUITESPARSE
-  else if (method_==UMFPACK)
+  else if (method_==UMFPACK||method_==CHOLMOD)
     {
+    // CHOLMOD may have to switch to UMFPACK
     int prl = params.get("OutputLevel",0);
     umf_Info_.resize(UMFPACK_INFO);
     umf_Control_.resize(UMFPACK_CONTROL);
     umfpack_di_defaults( &umf_Control_[0] ) ;
     umf_Control_[UMFPACK_PRL]=prl;
     }
+  if (method_==CHOLMOD && cholmod_==NULL)
+    {
+    cholmod_=new CholmodWrapper();
+    cholmod_->Factor_=NULL;
+    cholmod_->Common_=new cholmod_common();
+    cholmod_start(cholmod_->Common_);
+    cholmod_->Common_->supernodal=CHOLMOD_SUPERNODAL;
+    cholmod_->Common_->print=params.get("OutputLevel",0);
+    }
 #endif
 #ifdef HAVE_PARDISO
   if (method_==PARDISO)
@@ -238,6 +292,15 @@ int SparseDirectSolver::SetParameters(Teuchos::ParameterList& params)
   ownOrdering_ = params.get("Custom Ordering", true);
   ownScaling_ = params.get("Custom Scaling", true);
 
+  // The custom ordering and scaling are not symmetric. CHOLMOD
+  // does not pivot, so it uses its own fill-reducing ordering and
+  // no scaling.
+  if (method_==CHOLMOD)
+    {
+    ownOrdering_ = false;
+    ownScaling_ = false;
+    }
+
   if (ownOrdering_)
     {
 //  double pivtol=100*HYMLS_SMALL_ENTRY;
@@ -300,8 +363,10 @@ int SparseDirectSolver::SetParameters(Teuchos::ParameterList& params)
 int SparseDirectSolver::Initialize()
   {
   HYMLS_PROF3(label_,"Initialize");
+  Epetra_Time Time(Comm());
   IsEmpty_ = false;
   IsInitialized_ = false;
+  haveCRSPattern_ = false;
   IsComputed_ = false;
 
   if (Matrix_ == Teuchos::null)
@@ -338,6 +403,10 @@ int SparseDirectSolver::Initialize()
     {
     CHECK_ZERO(this->UmfpackSymbolic());
     }
+  else if (method_==CHOLMOD)
+    {
+    CHECK_ZERO(this->CholmodSymbolic());
+    }
 #endif
 #ifdef HAVE_PARDISO
   else if (method_==PARDISO)
@@ -351,6 +420,8 @@ int SparseDirectSolver::Initialize()
     return -99;
     }
   IsInitialized_ = true;
+  NumInitialize_++;
+  InitializeTime_ += Time.ElapsedTime();
   return(0);
   }
 
@@ -361,6 +432,8 @@ int SparseDirectSolver::Compute()
   if (!IsInitialized())
     CHECK_ZERO(Initialize());
 
+  Epetra_Time Time(Comm());
+
   if (IsEmpty_) {
     IsComputed_ = true;
     return(0);
@@ -401,6 +474,10 @@ int SparseDirectSolver::Compute()
     {
     CHECK_ZERO(this->UmfpackNumeric());
     }
+  else if (method_==CHOLMOD)
+    {
+    CHECK_ZERO(this->CholmodNumeric());
+    }
 #endif
 #ifdef HAVE_PARDISO
   else if (method_==PARDISO)
@@ -414,6 +491,8 @@ int SparseDirectSolver::Compute()
     }
 
   IsComputed_ = true;
+  NumCompute_++;
+  ComputeTime_ += Time.ElapsedTime();
   return(0);
   }
 
@@ -448,6 +527,8 @@ ApplyInverse(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
   if (X.NumVectors() != Y.NumVectors())
     {return -2;}
 
+  Epetra_Time Time(Comm());
+
   // AztecOO gives X and Y pointing to the same memory location,
   // need to create an auxiliary vector, Xcopy
   Teuchos::RCP<const Epetra_MultiVector> Xcopy;
@@ -469,6 +550,10 @@ ApplyInverse(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
     {
     CHECK_ZERO(this->UmfpackSolve(*Xcopy,Y));
     }
+  else if (method_==CHOLMOD)
+    {
+    CHECK_ZERO(this->CholmodSolve(*Xcopy,Y));
+    }
 #endif
 #ifdef HAVE_PARDISO
   else if (method_==PARDISO)
@@ -481,6 +566,11 @@ ApplyInverse(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
     return -99; // not implemented
     }
 
+  // a forward and backward substitution for every vector
+  NumApplyInverse_++;
+  ApplyInverseFlops_ += 2.0 * NumGlobalNonzerosLU() * X.NumVectors();
+  ApplyInverseTime_ += Time.ElapsedTime();
+
 #ifdef HYMLS_TESTING
   Epetra_MultiVector R(X);
   CHECK_ZERO(Matrix_->Multiply(UseTranspose_,Y,R));
@@ -576,37 +666,35 @@ double SparseDirectSolver::Condest(const Ifpack_CondestType CT,
 //==============================================================================
 std::ostream& SparseDirectSolver::Print(std::ostream& os) const
   {
-#if 0
   if (!Comm().MyPID()) {
-    os << endl;
-    os << "================================================================================" << endl;
-    os << "SparseDirectSolver: " << Label () << endl << endl;
-    os << "Condition number estimate = " << Condest() << endl;
-    os << "Global number of rows            = " << Matrix_->NumGlobalRows() << endl;
-    os << endl;
-    os << "Phase           # calls   Total Time (s)       Total MFlops     MFlops/s" << endl;
-    os << "-----           -------   --------------       ------------     --------" << endl;
+    os << std::endl;
+    os << "================================================================================" << std::endl;
+    os << "SparseDirectSolver: " << Label () << std::endl << std::endl;
+    os << "Condition number estimate = " << Condest() << std::endl;
+    os << "Global number of rows            = " << Matrix_->NumGlobalRows() << std::endl;
+    os << std::endl;
+    os << "Phase           # calls   Total Time (s)       Total MFlops     MFlops/s" << std::endl;
+    os << "-----           -------   --------------       ------------     --------" << std::endl;
     os << "Initialize()    "   << std::setw(5) << NumInitialize_
        << "  " << std::setw(15) << InitializeTime_
-       << "              0.0              0.0" << endl;
+       << "              0.0              0.0" << std::endl;
     os << "Compute()       "   << std::setw(5) << NumCompute_
        << "  " << std::setw(15) << ComputeTime_
        << "  " << std::setw(15) << 1.0e-6 * ComputeFlops_;
     if (ComputeTime_ != 0.0)
-      os << "  " << std::setw(15) << 1.0e-6 * ComputeFlops_ / ComputeTime_ << endl;
+      os << "  " << std::setw(15) << 1.0e-6 * ComputeFlops_ / ComputeTime_ << std::endl;
     else
-      os << "  " << std::setw(15) << 0.0 << endl;
+      os << "  " << std::setw(15) << 0.0 << std::endl;
     os << "ApplyInverse()  "   << std::setw(5) << NumApplyInverse_
        << "  " << std::setw(15) << ApplyInverseTime_
        << "  " << std::setw(15) << 1.0e-6 * ApplyInverseFlops_;
     if (ApplyInverseTime_ != 0.0)
-      os << "  " << std::setw(15) << 1.0e-6 * ApplyInverseFlops_ / ApplyInverseTime_ << endl;
+      os << "  " << std::setw(15) << 1.0e-6 * ApplyInverseFlops_ / ApplyInverseTime_ << std::endl;
     else
-      os << "  " << std::setw(15) << 0.0 << endl;
-    os << "================================================================================" << endl;
-    os << endl;
+      os << "  " << std::setw(15) << 0.0 << std::endl;
+    os << "================================================================================" << std::endl;
+    os << std::endl;
     }
-#endif
   return(os);
   }
 
@@ -694,18 +782,27 @@ int SparseDirectSolver::ConvertToCRS()
 
   // we do the reordering step here already
 
-  if (MyPID_ == 0)
+  if (MyPID_ != 0) return 0;
+
+  int N = serialMatrix_->NumMyRows();
+  int nnz= serialMatrix_->NumMyNonzeros();
+  int NumEntries = serialMatrix_->MaxNumEntries();
+  int len;
+
+  Teuchos::Array<int> rowIndices(NumEntries);
+  Teuchos::Array<double> rowValues(NumEntries);
+
+  if (!haveCRSPattern_ || Aperm_.size() != nnz || Ap_.size() != N+1)
     {
-    int N = serialMatrix_->NumMyRows();
-    int nnz= serialMatrix_->NumMyNonzeros();
+    // Compute the permuted pattern and remember for every entry where
+    // it comes from, so later calls only have to copy the values
     Ap_.resize(N+1);
     Ai_.resize(nnz);
-    Aval_.resize(nnz);
+    Aperm_.resize(nnz);
 
-    int NumEntries = serialMatrix_->MaxNumEntries();
     Teuchos::Array<int> invperm(N);
     for (int i=0;i<N;i++) invperm[col_perm_[i]]=i;
-    int len;
+    std::vector<std::pair<int, int> > entries(NumEntries);
     int Ai_index = 0;
     for (int i = 0 ; i < N; i++)
       {
@@ -713,17 +810,56 @@ int SparseDirectSolver::ConvertToCRS()
       int MyRow = row_perm_[i];
       Ap_[i] = Ai_index ;
       CHECK_ZERO(serialMatrix_->ExtractMyRowCopy(MyRow, NumEntries,
-          len, &Aval_[Ai_index], &Ai_[Ai_index]));
+          len, &rowValues[0], &rowIndices[0]));
+      // sort row entries by column index
+      for (int j=0;j<len;j++)
+        entries[j] = std::make_pair(invperm[rowIndices[j]], j);
+      std::sort(entries.begin(), entries.begin()+len);
       for (int j=0;j<len;j++)
         {
-        Aval_[Ai_index+j] *= (*scaLeft_)[MyRow] * (*scaRight_)[Ai_[Ai_index+j]];
-        Ai_[Ai_index+j] = invperm[Ai_[Ai_index+j]];
+        Ai_[Ai_index+j] = entries[j].first;
+        Aperm_[Ai_index+j] = entries[j].second;
         }
       Ai_index += len;
-      // sort row entries by column index
-      MatrixUtils::SortMatrixRow(&Ai_[Ai_index-len],&Aval_[Ai_index-len],len);
       }
     Ap_[N] = Ai_index;
+    haveCRSPattern_ = true;
+    }
+
+  // gather and scale the values
+  Aval_.resize(nnz);
+  const Epetra_CrsMatrix *crsMatrix =
+    dynamic_cast<const Epetra_CrsMatrix *>(serialMatrix_.get());
+  double *values;
+  int *indices;
+  for (int i = 0 ; i < N; i++)
+    {
+    int MyRow = row_perm_[i];
+    if (crsMatrix)
+      {
+      CHECK_ZERO(crsMatrix->ExtractMyRowView(MyRow, len, values, indices));
+      }
+    else
+      {
+      CHECK_ZERO(serialMatrix_->ExtractMyRowCopy(MyRow, NumEntries,
+          len, &rowValues[0], &rowIndices[0]));
+      values = &rowValues[0];
+      indices = &rowIndices[0];
+      }
+    double scaRow = (*scaLeft_)[MyRow];
+    for (int k = Ap_[i]; k < Ap_[i+1]; k++)
+      {
+      int j = Aperm_[k];
+      Aval_[k] = values[j] * scaRow * (*scaRight_)[indices[j]];
+      }
+    }
+
+  rowScaPerm_.resize(N);
+  colScaPerm_.resize(N);
+  for (int i = 0; i < N; i++)
+    {
+    rowScaPerm_[i] = (*scaLeft_)[row_perm_[i]];
+    colScaPerm_[i] = (*scaRight_)[col_perm_[i]];
     }
   return 0;
   }
@@ -780,6 +916,9 @@ int SparseDirectSolver::KluNumeric()
     }
   DO_KLU(rcond)(klu_->Symbolic_,klu_->Numeric_,klu_->Common_);
   Condest_ = klu_->Common_->rcond;
+
+  DO_KLU(flops)(klu_->Symbolic_,klu_->Numeric_,klu_->Common_);
+  ComputeFlops_ += klu_->Common_->flops;
   return status;
   }
 
@@ -797,12 +936,15 @@ int SparseDirectSolver::KluSolve(const Epetra_MultiVector& B, Epetra_MultiVector
   Teuchos::RCP<Epetra_MultiVector> serialX = Teuchos::rcp(&X,false);
   Teuchos::RCP<const Epetra_MultiVector> serialB = Teuchos::rcp(&B,false);
 
-  double *xbuf = new double[NumVectors * N];
+  if (solveBuffer_.size() < NumVectors * N)
+    solveBuffer_.resize(NumVectors * N);
+  double *xbuf = solveBuffer_.getRawPtr();
 
-  const Teuchos::RCP<Epetra_Vector>& sca_l =
-    UseTranspose_? scaRight_: scaLeft_;
-  const Teuchos::RCP<Epetra_Vector>& sca_r =
-    UseTranspose_? scaLeft_: scaRight_;
+  // the scaling is stored in the permuted order, see ConvertToCRS()
+  const Teuchos::Array<double>& sca_l =
+    UseTranspose_? colScaPerm_: rowScaPerm_;
+  const Teuchos::Array<double>& sca_r =
+    UseTranspose_? rowScaPerm_: colScaPerm_;
   const Teuchos::Array<int>& row_perm =
     UseTranspose_? col_perm_: row_perm_;
   const Teuchos::Array<int>& col_perm =
@@ -812,9 +954,9 @@ int SparseDirectSolver::KluSolve(const Epetra_MultiVector& B, Epetra_MultiVector
   if ( MyPID_ == 0 )
     {
     // Get direct pointers to the arrays, which speeds up the code somewhat
-    const double *sca_l_ptr = sca_l->Values();
+    const double *sca_l_ptr = sca_l.getRawPtr();
     const int *row_perm_ptr = row_perm.getRawPtr();
-    const double *sca_r_ptr = sca_r->Values();
+    const double *sca_r_ptr = sca_r.getRawPtr();
     const int *col_perm_ptr = col_perm.getRawPtr();
 
     for (int j = 0 ; j < NumVectors; j++)
@@ -823,7 +965,7 @@ int SparseDirectSolver::KluSolve(const Epetra_MultiVector& B, Epetra_MultiVector
       const double *serialB_ptr = (*serialB)[j];
       for (int i = 0; i < N; i++)
         {
-        xbuf_ptr[i] = serialB_ptr[row_perm_ptr[i]] * sca_l_ptr[row_perm_ptr[i]];
+        xbuf_ptr[i] = serialB_ptr[row_perm_ptr[i]] * sca_l_ptr[i];
         }
       }
 
@@ -843,14 +985,12 @@ int SparseDirectSolver::KluSolve(const Epetra_MultiVector& B, Epetra_MultiVector
       double *xbuf_ptr = xbuf + j * N;
       for (int i = 0; i < N; i++)
         {
-        serialX_ptr[col_perm_ptr[i]] = xbuf_ptr[i] * sca_r_ptr[col_perm_ptr[i]];
+        serialX_ptr[col_perm_ptr[i]] = xbuf_ptr[i] * sca_r_ptr[i];
         }
       }
     status = klu_->Common_->status;
     }
 
-  delete[] xbuf;
-
   if (serialX.get()!=&X) return -99; //not implemented
   return status;
   }
@@ -915,6 +1055,7 @@ int SparseDirectSolver::UmfpackNumeric()
     HYMLS::Tools::Error("UMFPACK Numeric Error",__FILE__,__LINE__);
     }
   Condest_=umf_Info_[UMFPACK_RCOND];
+  ComputeFlops_ += umf_Info_[UMFPACK_FLOPS];
   double rcond = Condest_;
 #ifdef HYMLS_TESTING
   if (rcond>0.0)
@@ -1002,6 +1143,229 @@ int SparseDirectSolver::UmfpackSolve(const Epetra_MultiVector& B, Epetra_MultiVe
 // END UMFPACK INTERFACE                                            //
 //////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////
+// CHOLMOD INTERFACE                                                //
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// wrap our CRS arrays in a cholmod_sparse. For a symmetric
+// matrix CRS is the same as CCS, and we tell CHOLMOD to only
+// look at the upper triangle.
+cholmod_sparse CholmodMatrix(int N, Teuchos::Array<int> &Ap,
+  Teuchos::Array<int> &Ai, Teuchos::Array<double> &Aval)
+  {
+  cholmod_sparse A;
+  A.nrow = N;
+  A.ncol = N;
+  A.nzmax = Aval.size();
+  A.p = &Ap[0];
+  A.i = &Ai[0];
+  A.nz = NULL;
+  A.x = &Aval[0];
+  A.z = NULL;
+  A.stype = 1;
+  A.itype = CHOLMOD_INT;
+  A.xtype = CHOLMOD_REAL;
+  A.dtype = CHOLMOD_DOUBLE;
+  A.sorted = 1;
+  A.packed = 1;
+  return A;
+  }
+
+// check if a CRS matrix with sorted column indices is symmetric in
+// pattern and values (up to rounding errors). A missing entry counts
+// as a zero.
+bool IsSymmetricCRS(int N, Teuchos::Array<int> const &Ap,
+  Teuchos::Array<int> const &Ai, Teuchos::Array<double> const &Aval)
+  {
+  const double tol = 1.0e-12;
+  for (int i = 0; i < N; i++)
+    {
+    for (int k = Ap[i]; k < Ap[i+1]; k++)
+      {
+      int j = Ai[k];
+      if (j == i)
+        continue;
+
+      const int *begin = &Ai[0] + Ap[j];
+      const int *end = &Ai[0] + Ap[j+1];
+      const int *pos = std::lower_bound(begin, end, i);
+      double aji = (pos != end && *pos == i) ? Aval[pos - &Ai[0]] : 0.0;
+      if (std::abs(Aval[k] - aji) > tol * (std::abs(Aval[k]) + std::abs(aji)))
+        return false;
+      }
+    }
+  return true;
+  }
+
+// returns 1.0 if all diagonal entries are positive, -1.0 if they are
+// all negative and 0.0 otherwise, in which case the matrix can not be
+// definite.
+double DiagonalSign(int N, Teuchos::Array<int> const &Ap,
+  Teuchos::Array<int> const &Ai, Teuchos::Array<double> const &Aval)
+  {
+  double sign = 0.0;
+  for (int i = 0; i < N; i++)
+    {
+    double d = 0.0;
+    for (int k = Ap[i]; k < Ap[i+1]; k++)
+      if (Ai[k] == i)
+        d = Aval[k];
+
+    double s = d > 0.0 ? 1.0 : (d < 0.0 ? -1.0 : 0.0);
+    if (s == 0.0 || (i > 0 && s != sign))
+      return 0.0;
+    sign = s;
+    }
+  return sign;
+  }
+
+  }
+
+int SparseDirectSolver::CholmodSymbolic()
+  {
+  if (MyPID_!=0) return 0;
+  HYMLS_PROF3(label_,"CholmodSymbolic");
+
+  int N = serialMatrix_->NumGlobalRows();
+
+  if (cholmod_->Factor_)
+    cholmod_free_factor(&cholmod_->Factor_, cholmod_->Common_);
+
+  cholmod_sparse A = CholmodMatrix(N, Ap_, Ai_, Aval_);
+  cholmod_->Factor_ = cholmod_analyze(&A, cholmod_->Common_);
+
+  if (cholmod_->Common_->status<CHOLMOD_OK || cholmod_->Factor_==NULL)
+    {
+    HYMLS::Tools::Error("CHOLMOD Symbolic Error "+
+      Teuchos::toString(cholmod_->Common_->status),__FILE__,__LINE__);
+    }
+
+  return 0;
+  }
+
+//=============================================================================
+
+int SparseDirectSolver::CholmodNumeric()
+  {
+  HYMLS_PROF3(label_,"CholmodNumeric");
+  if (MyPID_!=0) return 0;
+
+  int N = serialMatrix_->NumGlobalRows();
+
+  // CHOLMOD only looks at the upper triangle, so we have to make sure
+  // that the matrix is symmetric. A definite matrix has diagonal
+  // entries of one sign, and we factor -A if A is negative definite,
+  // which is the case for many of our (e.g. Laplace) matrices.
+  std::string reason;
+  if (!IsSymmetricCRS(N, Ap_, Ai_, Aval_))
+    reason = "matrix is not symmetric";
+  else
+    {
+    cholmodSign_ = DiagonalSign(N, Ap_, Ai_, Aval_);
+    if (cholmodSign_ == 0.0)
+      reason = "matrix is not definite";
+    }
+
+  if (reason.empty())
+    {
+    if (cholmodSign_ < 0.0)
+      {
+      for (int k = 0; k < Aval_.size(); k++)
+        Aval_[k] = -Aval_[k];
+      }
+
+    cholmod_sparse A = CholmodMatrix(N, Ap_, Ai_, Aval_);
+    cholmod_factorize(&A, cholmod_->Factor_, cholmod_->Common_);
+
+    if (cholmod_->Common_->status == CHOLMOD_NOT_POSDEF)
+      {
+      reason = "matrix is not definite";
+      if (cholmodSign_ < 0.0)
+        {
+        for (int k = 0; k < Aval_.size(); k++)
+          Aval_[k] = -Aval_[k];
+        }
+      }
+    else if (cholmod_->Common_->status<CHOLMOD_OK)
+      {
+      HYMLS::Tools::Error("CHOLMOD Numeric Error "+
+        Teuchos::toString(cholmod_->Common_->status),__FILE__,__LINE__);
+      }
+    }
+
+  if (!reason.empty())
+    {
+    // Use a multifrontal LU factorization instead
+    if (firstNotDefinite.exchange(false))
+      {
+      Tools::Warning(reason + ", switching from CHOLMOD to UMFPACK",
+        __FILE__, __LINE__);
+      }
+    cholmodSign_ = 1.0;
+    cholmod_free_factor(&cholmod_->Factor_, cholmod_->Common_);
+
+    method_ = UMFPACK;
+    CHECK_ZERO(this->UmfpackSymbolic());
+    return this->UmfpackNumeric();
+    }
+
+  Condest_ = cholmod_rcond(cholmod_->Factor_, cholmod_->Common_);
+  ComputeFlops_ += cholmod_->Common_->fl;
+  return 0;
+  }
+
+//=============================================================================
+
+int SparseDirectSolver::CholmodSolve(const Epetra_MultiVector& B, Epetra_MultiVector& X) const
+  {
+  HYMLS_PROF3(label_,"CholmodSolve");
+
+  if (Matrix_.get()!=serialMatrix_.get()) return -99; // not implemented
+
+  if (MyPID_ != 0) return 0;
+
+  int N = X.MyLength();
+  int NumVectors = X.NumVectors();
+
+  // CHOLMOD wants a column-major array with all vectors
+  Teuchos::Array<double> bbuf(N * NumVectors);
+  for (int j = 0; j < NumVectors; j++)
+    for (int i = 0; i < N; i++)
+      bbuf[j * N + i] = B[j][i];
+
+  cholmod_dense b;
+  b.nrow = N;
+  b.ncol = NumVectors;
+  b.nzmax = N * NumVectors;
+  b.d = N;
+  b.x = &bbuf[0];
+  b.z = NULL;
+  b.xtype = CHOLMOD_REAL;
+  b.dtype = CHOLMOD_DOUBLE;
+
+  cholmod_dense *x = cholmod_solve(CHOLMOD_A, cholmod_->Factor_, &b, cholmod_->Common_);
+  if (x == NULL)
+    {
+    Tools::Warning("CHOLMOD Solve Error "+
+      Teuchos::toString(cholmod_->Common_->status),__FILE__,__LINE__);
+    return -1;
+    }
+
+  const double *xbuf = (const double *)x->x;
+  for (int j = 0; j < NumVectors; j++)
+    for (int i = 0; i < N; i++)
+      X[j][i] = cholmodSign_ * xbuf[j * N + i];
+
+  cholmod_free_dense(&x, cholmod_->Common_);
+  return 0;
+  }
+
+//////////////////////////////////////////////////////////////////////
+// END CHOLMOD INTERFACE                                            //
+//////////////////////////////////////////////////////////////////////
+
 #endif // HAVE_SUITESPARSE
 
 #ifdef HAVE_PARDISO
@@ -1022,6 +1386,8 @@ int SparseDirectSolver::PardisoSymbolic()
     sscanf(var, "%d", &num_procs);
     }
   iparam(3) = num_procs;
+  iparam(18) = -1; // report the number of nonzeros in the factors
+  iparam(19) = -1; // report the MFlops of the factorization
 
   int N = serialMatrix_->NumGlobalRows();
   int NumVectors = 1;
@@ -1078,6 +1444,7 @@ int SparseDirectSolver::PardisoNumeric()
       __FILE__,__LINE__);
     // condition number is not in PARDISO?
     }
+  ComputeFlops_ += 1.0e6 * iparam(19);
   return 0;
   }
 
@@ -1277,16 +1644,39 @@ int SparseDirectSolver::NumGlobalNonzerosA() const
 
 int SparseDirectSolver::NumGlobalNonzerosL() const
   {
-    if (method_==KLU)
-      return klu_->Numeric_->lnz;
-    return 0;
+  if (method_==KLU && klu_->Numeric_)
+    return klu_->Numeric_->lnz;
+#ifdef HAVE_SUITESPARSE
+  if (method_==UMFPACK && umf_Numeric_)
+    return umf_Info_[UMFPACK_LNZ];
+  if (method_==CHOLMOD && cholmod_->Factor_)
+    return cholmod_->Common_->lnz;
+#endif
+  return 0;
   }
 
 int SparseDirectSolver::NumGlobalNonzerosU() const
   {
-    if (method_==KLU)
-      return klu_->Numeric_->unz;
-    return 0;
+  if (method_==KLU && klu_->Numeric_)
+    return klu_->Numeric_->unz;
+#ifdef HAVE_SUITESPARSE
+  if (method_==UMFPACK && umf_Numeric_)
+    return umf_Info_[UMFPACK_UNZ];
+  // U = L' is not stored separately
+  if (method_==CHOLMOD && cholmod_->Factor_)
+    return cholmod_->Common_->lnz;
+#endif
+  return 0;
+  }
+
+double SparseDirectSolver::NumGlobalNonzerosLU() const
+  {
+#ifdef HAVE_PARDISO
+  // Pardiso only reports the total number of nonzeros in the factors
+  if (method_==PARDISO && IsComputed_)
+    return iparam(18);
+#endif
+  return (double)NumGlobalNonzerosL() + NumGlobalNonzerosU();
   }
 
   }//namespace HYMLS
@@ -16,6 +16,7 @@ class Epetra_RowMatrix;
 class Epetra_Import;
 
 class KluWrapper;
+class CholmodWrapper;
 
 namespace HYMLS {
 
@@ -25,9 +26,16 @@ namespace HYMLS {
 //! and scaling more easily and consistently.
 //!
 //! This class accepts the following parameters:
-//! "amesos: solver type" can be "KLU" (default) or "UMFPACK"
-//!             (if HAVE_SUITESPARSE is defined). "Cholmod" is
-//!             intended to be added in the future. For consistency
+//! "amesos: solver type" can be "KLU" (default), "UMFPACK" or
+//!             "CHOLMOD" (if HAVE_SUITESPARSE is defined). CHOLMOD
+//!             is a supernodal Cholesky method for symmetric positive
+//!             or negative definite matrices. If the matrix turns out
+//!             not to be symmetric or not definite, we switch to
+//!             UMFPACK, which is a
+//!             multifrontal LU method. Both use BLAS-3 kernels on dense
+//!             fronts and are much faster than KLU for matrices with a
+//!             lot of fill (e.g. large 3D subdomains). CHOLMOD ignores
+//!             "Custom Ordering" and "Custom Scaling". For consistency
 //!             with Amesos, you can also set Amesos_Klu etc, and  
 //!             the option is case insensitive.
 //! "Custom Ordering" (bool) if false, we leave it to the method to
@@ -195,55 +203,55 @@ public:
   //! Returns the number of calls to Initialize().
   virtual int NumInitialize() const
   {
-    return -1;
+    return NumInitialize_;
   }
 
   //! Returns the number of calls to Compute().
   virtual int NumCompute() const
   {
-    return -1;
+    return NumCompute_;
   }
 
   //! Returns the number of calls to ApplyInverse().
   virtual int NumApplyInverse() const
   {
-    return -1;
+    return NumApplyInverse_;
   }
 
   //! Returns the total time spent in Initialize().
   virtual double InitializeTime() const
   {
-    return -1.0;
+    return InitializeTime_;
   }
 
   //! Returns the total time spent in Compute().
   virtual double ComputeTime() const
   {
-    return  -1.0;
+    return ComputeTime_;
   }
 
   //! Returns the total time spent in ApplyInverse().
   virtual double ApplyInverseTime() const
   {
-    return  -1.0;
+    return ApplyInverseTime_;
   }
 
   //! Returns the number of flops in the initialization phase.
   virtual double InitializeFlops() const
   {
-    return  -1.0;
+    return InitializeFlops_;
   }
 
   //! Returns the total number of flops to computate the preconditioner.
   virtual double ComputeFlops() const
   {
-    return -1.0;
+    return ComputeFlops_;
   }
 
   //! Returns the total number of flops to apply the preconditioner.
   virtual double ApplyInverseFlops() const
   {
-    return -1.0;
+    return ApplyInverseFlops_;
   }
 
   //! Prints on ostream basic information about \c this object.
@@ -260,6 +268,15 @@ public:
   //! return number of nonzeros in U
   int NumGlobalNonzerosU() const;
 
+  //! return number of nonzeros in L and U together. This is also
+  //! available for solvers that do not report L and U separately.
+  double NumGlobalNonzerosLU() const;
+
+  //! the solver package that is used. This differs from the
+  //! "amesos: solver type" if CHOLMOD switched to UMFPACK because
+  //! the matrix is not symmetric or not definite.
+  SolverType Method() const {return method_;}
+
 #ifdef STORE_SD_LU
 public:
 #else
@@ -319,6 +336,27 @@ private:
   //!
   int MyPID_;
 
+  //! Contains the number of successful calls to Initialize().
+  int NumInitialize_;
+  //! Contains the number of successful call to Compute().
+  int NumCompute_;
+  //! Contains the number of successful call to ApplyInverse().
+  mutable int NumApplyInverse_;
+
+  //! Contains the time for all successful calls to Initialize().
+  double InitializeTime_;
+  //! Contains the time for all successful calls to Compute().
+  double ComputeTime_;
+  //! Contains the time for all successful calls to ApplyInverse().
+  mutable double ApplyInverseTime_;
+
+  //! Contains the number of flops for Initialize().
+  double InitializeFlops_;
+  //! Contains the number of flops for Compute().
+  double ComputeFlops_;
+  //! Contains the number of flops for ApplyInverse().
+  mutable double ApplyInverseFlops_;
+
   //! serial matrix
   Teuchos::RCP<const Epetra_RowMatrix> serialMatrix_;
   
@@ -354,6 +392,12 @@ private:
     
     //! KLU objects wrapped up so we don't need to include the header
     KluWrapper *klu_;
+
+    //! CHOLMOD objects wrapped up so we don't need to include the header
+    CholmodWrapper *cholmod_;
+
+    //! -1 if we factor -A with CHOLMOD because A is negative definite
+    double cholmodSign_;
     
     //! row and column permutations
     Teuchos::Array<int> row_perm_, col_perm_;
@@ -361,6 +405,18 @@ private:
     mutable Teuchos::Array<int> Ap_;
     mutable Teuchos::Array<int> Ai_;
     mutable Teuchos::Array<double> Aval_;
+    //! for every entry of Aval_ its position in the (permuted) row of
+    //! serialMatrix_, so the values can be refreshed in a single pass
+    Teuchos::Array<int> Aperm_;
+    //! scaling in the permuted order, rowScaPerm_[i] = scaLeft_[row_perm_[i]]
+    //! and colScaPerm_[i] = scaRight_[col_perm_[i]], so that the solves
+    //! only need one indirect access per entry
+    Teuchos::Array<double> rowScaPerm_, colScaPerm_;
+    //! work array for the solves, kept to avoid allocating it every time
+    mutable Teuchos::Array<double> solveBuffer_;
+    //! whether Ap_, Ai_ and Aperm_ are valid for the current pattern
+    //! and ordering. Set to false in Initialize().
+    bool haveCRSPattern_;
     //@}
 
 private:  
@@ -384,6 +440,9 @@ private:
     Postconditions:
       Ai, Ap, and Aval are resized and populated with a compresses row storage 
       version of the input matrix A.
+    The pattern (Ap, Ai) and the position of every entry in the input
+    matrix are only computed once after Initialize(), later calls only
+    gather and scale the values.
   */
   int ConvertToCRS();
 
@@ -398,6 +457,18 @@ private:
   /*! perform solve using Umfpack */
   int UmfpackSolve(const Epetra_MultiVector& B, Epetra_MultiVector& X) const;
 
+  /*! symbolic factorization using CHOLMOD
+  */
+  int CholmodSymbolic();
+
+  /*! numeric factorization using CHOLMOD. Switches to UMFPACK
+      if the matrix is not definite.
+  */
+  int CholmodNumeric();
+
+  /*! perform solve using CHOLMOD */
+  int CholmodSolve(const Epetra_MultiVector& B, Epetra_MultiVector& X) const;
+
   /*! symbolic factorization using KLU
   */      
   int KluSymbolic();
@@ -25,7 +25,16 @@
 
 #include "EpetraExt_RowMatrixOut.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 class Epetra_RowMatrix;
 
@@ -54,13 +63,11 @@ int printf (const char *fmt, ...)
 namespace HYMLS {
 
 RCP<const Epetra_Comm> Tools::comm_=null;
-ParameterList Tools::timerList_;
 ParameterList Tools::breakpointList_;
 ParameterList Tools::memList_;
 RCP<FancyOStream> Tools::output_stream = null;
 RCP<FancyOStream> Tools::debug_stream = null;
 int Tools::traceLevel_=0;
-int Tools::timerCounter_=0;
 std::stack<std::string> Tools::functionStack_;
 std::streambuf* Tools::rdbuf_bak = std::cout.rdbuf();
 
@@ -342,9 +349,127 @@ int Tools::SplitBox(int nx, int ny, int nz, int nparts, int& ndx, int& ndy, int&
 // Timing functionality                                         //
 //////////////////////////////////////////////////////////////////
 
-RCP<Epetra_Time> Tools::StartTiming(std::string const &fname)
+namespace {
+
+//! accumulated timing of one timer on one thread
+struct TimerData
+  {
+  long long calls = 0;
+  double time = 0.0;
+  };
+
+typedef std::vector<TimerData> TimerDataList;
+
+//! protects the timer registry below
+std::mutex timerMutex;
+
+//! labels of the timers, indexed by timer ID
+std::vector<std::string> timerLabels;
+
+//! timer ID of each label
+std::unordered_map<std::string, int> timerIDs;
+
+//! timings of every thread that used a timer
+std::vector<std::shared_ptr<TimerDataList> > threadTimers;
+
+//! start times of the timers started with StartTiming
+thread_local std::map<int, std::chrono::steady_clock::time_point> startTimes;
+
+//! timings of the calling thread, which can be updated without locking
+TimerDataList &LocalTimers()
+  {
+  thread_local std::shared_ptr<TimerDataList> timers;
+  if (!timers)
+    {
+    timers = std::make_shared<TimerDataList>();
+    std::lock_guard<std::mutex> lock(timerMutex);
+    threadTimers.push_back(timers);
+    }
+  return *timers;
+  }
+
+//! begin and end time of a timer
+struct TraceEvent
+  {
+  int id;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+  };
+
+//! ring buffer with the trace events of one thread
+struct TraceBuffer
+  {
+  int tid;
+  std::vector<TraceEvent> events;
+  long long count = 0;
+  };
+
+//! are trace events being recorded?
+std::atomic<bool> tracing(false);
+
+//! number of events per thread
+int traceBufferSize = 0;
+
+//! time at which tracing was started, all events are relative to this
+std::chrono::steady_clock::time_point traceStart;
+
+//! trace buffers of every thread that recorded an event
+std::vector<std::shared_ptr<TraceBuffer> > traceBuffers;
+
+//! trace buffer of the calling thread
+TraceBuffer &LocalTraceBuffer()
+  {
+  thread_local std::shared_ptr<TraceBuffer> buffer;
+  if (!buffer)
+    {
+    buffer = std::make_shared<TraceBuffer>();
+    std::lock_guard<std::mutex> lock(timerMutex);
+    buffer->tid = traceBuffers.size();
+    buffer->events.resize(traceBufferSize);
+    traceBuffers.push_back(buffer);
+    }
+  return *buffer;
+  }
+
+//! escape a string for use in JSON
+std::string JSONString(std::string const &s)
+  {
+  std::string out = "\"";
+  for (char c: s)
+    {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    if ((unsigned char)c >= 0x20)
+      out += c;
+    }
+  return out + "\"";
+  }
+
+//! broadcast a list of labels from root to all processes
+void BroadcastLabels(Epetra_Comm const &comm, std::vector<std::string> &labels, int root)
+  {
+  std::string buffer;
+  if (comm.MyPID() == root)
+    for (std::string const &label: labels)
+      buffer += label + '\n';
+
+  int length = buffer.length();
+  comm.Broadcast(&length, 1, root);
+  buffer.resize(length);
+  if (length > 0)
+    comm.Broadcast(&buffer[0], length, root);
+
+  labels.clear();
+  std::istringstream ss(buffer);
+  std::string label;
+  while (std::getline(ss, label))
+    labels.push_back(label);
+  }
+
+  }
+
+void Tools::EnterFunction(std::string const &fname)
   {
-  RCP<Epetra_Time> T=null;
 #ifdef HYMLS_FUNCTION_TRACING
   traceLevel_++;
   functionStack_.push(fname);
@@ -362,20 +487,9 @@ RCP<Epetra_Time> Tools::StartTiming(std::string const &fname)
     }
 #endif
 #endif
-  if (InitializedIO())
-    {
-    T=rcp(new Epetra_Time(*comm_));
-    if (timerList_.sublist("timer id").isParameter(fname)==false)
-      {
-      timerCounter_++;
-      timerList_.sublist("timer id").set(fname,timerCounter_);
-      }  
-    timerList_.sublist("timers").set(fname,T);
-    }
-    return T;
   }
 
-void Tools::StopTiming(std::string const &fname, bool print, RCP<Epetra_Time> T)
+void Tools::LeaveFunction(std::string const &fname)
   {
 #ifdef HYMLS_FUNCTION_TRACING
   // when an exception or other error is encountered,
@@ -391,24 +505,166 @@ void Tools::StopTiming(std::string const &fname, bool print, RCP<Epetra_Time> T)
     }
   traceLevel_--;
 #endif
-  if (T == null)
+  }
+
+int Tools::TimerID(std::string const &label)
+  {
+  std::lock_guard<std::mutex> lock(timerMutex);
+  auto it = timerIDs.find(label);
+  if (it != timerIDs.end())
+    return it->second;
+
+  int id = timerLabels.size();
+  timerLabels.push_back(label);
+  timerIDs[label] = id;
+  return id;
+  }
+
+std::string Tools::TimerLabel(int id)
+  {
+  std::lock_guard<std::mutex> lock(timerMutex);
+  return timerLabels[id];
+  }
+
+void Tools::AddTiming(int id, double elapsed, bool print)
+  {
+  TimerDataList &timers = LocalTimers();
+  if (id >= (int)timers.size())
+    timers.resize(id + 1);
+  timers[id].calls++;
+  timers[id].time += elapsed;
+
+  if (print)
     {
-    T=timerList_.sublist("timers").get(fname,T);
+    out() << "### timing: "<<TimerLabel(id)<<" "<<elapsed<<std::endl;
     }
-  double elapsed=0;
-  if (T!=null)
+  }
+
+void Tools::AddTraceEvent(int id,
+  std::chrono::steady_clock::time_point const &start,
+  std::chrono::steady_clock::time_point const &end)
+  {
+  if (!tracing.load(std::memory_order_relaxed))
+    return;
+
+  TraceBuffer &buffer = LocalTraceBuffer();
+  if (buffer.events.empty())
+    return;
+
+  TraceEvent &event = buffer.events[buffer.count % buffer.events.size()];
+  event.id = id;
+  event.start = start;
+  event.end = end;
+  buffer.count++;
+  }
+
+void Tools::StartTracing(int bufferSize)
+  {
     {
-    elapsed=T->ElapsedTime();
-    int ncalls=timerList_.sublist("number of calls").get(fname,0);
-    double total_time=timerList_.sublist("total time").get(fname,0.0);
-    timerList_.sublist("number of calls").set(fname,ncalls+1);
-    timerList_.sublist("total time").set(fname,total_time+elapsed);
+    std::lock_guard<std::mutex> lock(timerMutex);
+    traceBufferSize = bufferSize;
+    for (auto &buffer: traceBuffers)
+      {
+      buffer->events.clear();
+      buffer->events.resize(bufferSize);
+      buffer->count = 0;
+      }
+    }
+
+  // Use the same starting point on all processes, so the timelines
+  // of the processes can be compared
+  if (comm_ != Teuchos::null)
+    comm_->Barrier();
+  traceStart = std::chrono::steady_clock::now();
+  tracing = true;
+  }
+
+void Tools::WriteTrace(std::string const &filename)
+  {
+  tracing = false;
+
+  int pid = comm_ != Teuchos::null ? comm_->MyPID() : 0;
+  int numProc = comm_ != Teuchos::null ? comm_->NumProc() : 1;
+
+  std::ostringstream ss;
+  ss << ",\n{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+     << ", \"args\": {\"name\": \"rank " << pid << "\"}}";
 
-    if (print)
+    {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    ss << std::fixed << std::setprecision(3);
+    for (auto const &buffer: traceBuffers)
       {
-      out() << "### timing: "<<fname<<" "<<elapsed<<std::endl;
+      long long size = buffer->events.size();
+      if (size == 0)
+        continue;
+
+      long long first = std::max(buffer->count - size, 0LL);
+      if (first > 0)
+        {
+        Tools::Warning("The trace buffer of thread " + Teuchos::toString(buffer->tid) +
+          " overflowed, only the last " + Teuchos::toString(size) + " events are kept",
+          __FILE__, __LINE__);
+        }
+
+      for (long long i = first; i < buffer->count; i++)
+        {
+        TraceEvent const &event = buffer->events[i % size];
+        std::chrono::duration<double, std::micro> ts = event.start - traceStart;
+        std::chrono::duration<double, std::micro> dur = event.end - event.start;
+        ss << ",\n{\"name\": " << JSONString(timerLabels[event.id])
+           << ", \"ph\": \"X\", \"pid\": " << pid
+           << ", \"tid\": " << buffer->tid
+           << ", \"ts\": " << ts.count()
+           << ", \"dur\": " << dur.count() << "}";
+        }
       }
     }
+
+  // The processes append their events to the file one after the other
+  for (int p = 0; p < numProc; p++)
+    {
+    if (p == pid)
+      {
+      std::ofstream ofs;
+      if (p == 0)
+        {
+        ofs.open(filename.c_str());
+        ofs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+            << "{\"name\": \"HYMLS\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 0, \"ts\": 0}";
+        }
+      else
+        {
+        ofs.open(filename.c_str(), std::ios::app);
+        }
+      ofs << ss.str();
+      if (p == numProc - 1)
+        ofs << "\n]}" << std::endl;
+      }
+    if (comm_ != Teuchos::null)
+      comm_->Barrier();
+    }
+  }
+
+void Tools::StartTiming(std::string const &fname)
+  {
+  EnterFunction(fname);
+  startTimes[TimerID(fname)] = std::chrono::steady_clock::now();
+  }
+
+void Tools::StopTiming(std::string const &fname, bool print)
+  {
+  LeaveFunction(fname);
+  int id = TimerID(fname);
+  auto it = startTimes.find(id);
+  if (it != startTimes.end())
+    {
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = end - it->second;
+    AddTraceEvent(id, it->second, end);
+    startTimes.erase(it);
+    AddTiming(id, elapsed.count(), print);
+    }
   }
 
 std::string mem2string(long long mem)
@@ -544,11 +800,92 @@ std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>&
   return s;
   }
 
+namespace {
+
+//! the labels of the timers of all processes, with the maximum
+//! number of calls and time over all processes
+void CollectTiming(Teuchos::RCP<const Epetra_Comm> comm,
+  std::vector<std::string> &allLabels, std::vector<double> &maxCalls,
+  std::vector<double> &maxElapsed)
+  {
+  // Add up the timings of all threads
+  std::vector<std::string> labels;
+  TimerDataList timers;
+    {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    labels = timerLabels;
+    timers.resize(labels.size());
+    for (auto const &thread_timers: threadTimers)
+      for (size_t id = 0; id < thread_timers->size(); id++)
+        {
+        timers[id].calls += (*thread_timers)[id].calls;
+        timers[id].time += (*thread_timers)[id].time;
+        }
+    }
+
+  // Timer IDs are given out in the order in which the timers are first
+  // used, which may differ between processes. Make a common list that
+  // starts with the labels of the first process.
+  allLabels = labels;
+  int numProc = comm != Teuchos::null ? comm->NumProc() : 1;
+  if (numProc > 1)
+    {
+    BroadcastLabels(*comm, allLabels, 0);
+
+    std::unordered_set<std::string> known(allLabels.begin(), allLabels.end());
+    std::vector<std::string> extraLabels;
+    for (std::string const &label: labels)
+      if (!known.count(label))
+        extraLabels.push_back(label);
+
+    int numExtra = extraLabels.size();
+    std::vector<int> allNumExtra(numProc);
+    comm->GatherAll(&numExtra, &allNumExtra[0], 1);
+    for (int pid = 1; pid < numProc; pid++)
+      {
+      if (allNumExtra[pid] == 0)
+        continue;
+      std::vector<std::string> newLabels = extraLabels;
+      BroadcastLabels(*comm, newLabels, pid);
+      for (std::string const &label: newLabels)
+        if (known.insert(label).second)
+          allLabels.push_back(label);
+      }
+    }
+
+  std::unordered_map<std::string, int> ids;
+  for (int id = 0; id < (int)labels.size(); id++)
+    ids[labels[id]] = id;
+
+  int n = allLabels.size();
+  std::vector<double> calls(n, 0.0), elapsed(n, 0.0);
+  for (int i = 0; i < n; i++)
+    {
+    auto it = ids.find(allLabels[i]);
+    if (it != ids.end())
+      {
+      calls[i] = timers[it->second].calls;
+      elapsed[i] = timers[it->second].time;
+      }
+    }
+
+  maxCalls = calls;
+  maxElapsed = elapsed;
+  if (numProc > 1 && n > 0)
+    {
+    comm->MaxAll(&calls[0], &maxCalls[0], n);
+    comm->MaxAll(&elapsed[0], &maxElapsed[0], n);
+    }
+  }
+
+  }
+
 void Tools::PrintTiming(std::ostream& os)
   {
-  ParameterList& idList=timerList_.sublist("timer id");
-  ParameterList& ncallsList=timerList_.sublist("number of calls");
-  ParameterList& elapsedList=timerList_.sublist("total time");
+  std::vector<std::string> allLabels;
+  std::vector<double> maxCalls, maxElapsed;
+  CollectTiming(comm_, allLabels, maxCalls, maxElapsed);
+  int n = allLabels.size();
 
   os << std::setfill('=') << std::setw(120) << centered(" TIMING RESULTS ") << std::endl;
   os << std::setfill(' ') << std::setw(120-17*3) << std::left << "Description"
@@ -558,33 +895,52 @@ void Tools::PrintTiming(std::ostream& os)
      << std::endl;
   os << std::setfill('=') << std::setw(120) << "" << std::endl;
 
-  // first construct a correctly sorted list according to timer ID
-  Teuchos::ParameterList sortedList;
-  for (ParameterList::ConstIterator i=ncallsList.begin();i!=ncallsList.end();i++)
+  for (int i = 0; i < n; i++)
     {
-    const string& fname = i->first;
-    int id = idList.get(fname,0);
-    std::stringstream label;
-    label << std::setw(6) << std::setfill('0') << id << " " << fname;
-    sortedList.set(label.str(),fname);
-    }
-
-  for (ParameterList::ConstIterator i=sortedList.begin();i!=sortedList.end();i++)
-    {
-    const string& label = i->first;
-    string fname = sortedList.get(label,"bad label");
-    int ncalls = ncallsList.get(fname,0);
-    double elapsed = elapsedList.get(fname,0.0);
-    os << std::setfill(' ') << std::setw(120-17*3) << std::left << fname
+    long long ncalls = maxCalls[i];
+    if (ncalls == 0)
+      continue;
+    os << std::setfill(' ') << std::setw(120-17*3) << std::left << allLabels[i]
        << std::setfill(' ') << std::setw(17) << std::left << ncalls
-       << std::setfill(' ') << std::setw(17) << std::left << elapsed
+       << std::setfill(' ') << std::setw(17) << std::left << maxElapsed[i]
        << std::setfill(' ') << std::setw(17) << std::left
-       << (ncalls > 0 ? elapsed/(double)ncalls : 0.0)
+       << maxElapsed[i] / (double)ncalls
        << std::endl;
     }
   os << std::setfill('=') << std::setw(120) << "" << std::endl;
   }
 
+void Tools::WriteTiming(std::string const &filename)
+  {
+  std::vector<std::string> allLabels;
+  std::vector<double> maxCalls, maxElapsed;
+  CollectTiming(comm_, allLabels, maxCalls, maxElapsed);
+
+  if (comm_ != Teuchos::null && comm_->MyPID() != 0)
+    return;
+
+  std::ofstream ofs(filename.c_str());
+  ofs << std::setprecision(10);
+  ofs << "{" << std::endl;
+  ofs << "  \"processes\": " << (comm_ != Teuchos::null ? comm_->NumProc() : 1)
+      << "," << std::endl;
+  ofs << "  \"timers\": [";
+  bool first = true;
+  for (int i = 0; i < (int)allLabels.size(); i++)
+    {
+    long long ncalls = maxCalls[i];
+    if (ncalls == 0)
+      continue;
+    ofs << (first ? "" : ",") << std::endl;
+    ofs << "    {\"label\": " << JSONString(allLabels[i])
+        << ", \"calls\": " << ncalls
+        << ", \"time\": " << maxElapsed[i] << "}";
+    first = false;
+    }
+  ofs << std::endl << "  ]" << std::endl;
+  ofs << "}" << std::endl;
+  }
+
 void Tools::PrintMemUsage(std::ostream& os)
   {
 #ifdef HYMLS_MEMORY_PROFILING
@@ -735,20 +1091,56 @@ bool Tools::GetCheckPoint(std::string fname, std::string& msg,
   return false;
   }
 
-TimerObject::TimerObject(std::string const &s, bool print)
+TimerObject::TimerObject(int id, bool print)
   :
-  s_(s),
-  print_(print)
+  id_(id),
+  print_(print),
+  memory_used_(-1),
+  memory_allocated_(-1)
   {
-  T_=Tools::StartTiming(s);
-  auto m = Tools::StartMemory(s);
+#ifdef HYMLS_FUNCTION_TRACING
+  Tools::EnterFunction(Tools::TimerLabel(id_));
+#endif
+#ifdef HYMLS_MEMORY_PROFILING
+  auto m = Tools::StartMemory(Tools::TimerLabel(id_));
   memory_used_ = std::get<0>(m);
   memory_allocated_ = std::get<1>(m);
+#endif
+  start_ = std::chrono::steady_clock::now();
   }
 
+TimerObject::TimerObject(std::string const &s, bool print)
+  :
+  TimerObject(Tools::TimerID(s), print)
+  {}
+
 TimerObject::~TimerObject()
   {
-  Tools::StopTiming(s_, print_, T_);
-  Tools::StopMemory(s_, print_, memory_used_, memory_allocated_);
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = end - start_;
+  Tools::AddTiming(id_, elapsed.count(), print_);
+  Tools::AddTraceEvent(id_, start_, end);
+#ifdef HYMLS_MEMORY_PROFILING
+  Tools::StopMemory(Tools::TimerLabel(id_), print_, memory_used_, memory_allocated_);
+#endif
+#ifdef HYMLS_FUNCTION_TRACING
+  Tools::LeaveFunction(Tools::TimerLabel(id_));
+#endif
+  }
+
+int TimerSite::Insert(std::string const &s1, std::string const &s2, int level)
+  {
+  std::string label = s1;
+  if (level >= 0)
+    label += "_L" + Teuchos::toString(level);
+  label += ": " + s2;
+
+  Entry entry;
+  entry.s1 = s1;
+  entry.s2 = s2;
+  entry.level = level;
+  entry.id = Tools::TimerID(label);
+  entries_.push_back(entry);
+  return entry.id;
   }
 }
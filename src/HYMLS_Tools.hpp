@@ -6,6 +6,8 @@
 #include <stack>
 #include <cstdio>
 #include <string>
+#include <vector>
+#include <chrono>
 #include <iosfwd>
 
 #include "Teuchos_RCP.hpp"
@@ -27,6 +29,8 @@ public:
 
   friend class Exception;
 
+  friend class TimerObject;
+
   //! returns the SVN revision number of the hymls directory
   static const char* Revision();
 
@@ -80,11 +84,21 @@ public:
   //! and number of calls for each std::string you put
   //! in. The std::string must be the same when you call
   // StopTiming, of course.
-  static Teuchos::RCP<Epetra_Time> StartTiming(std::string const &label);
+  static void StartTiming(std::string const &label);
 
   //! stop timing specific part of the code
-  static void StopTiming(std::string const &fname, bool print=false,
-    Teuchos::RCP<Epetra_Time> T=Teuchos::null);
+  static void StopTiming(std::string const &label, bool print=false);
+
+  //! returns the ID of the timer with the given label. The
+  //! timer is created the first time a label is used.
+  static int TimerID(std::string const &label);
+
+  //! returns the label of the timer with the given ID
+  static std::string TimerLabel(int id);
+
+  //! add a measurement of elapsed seconds to a timer. The timings
+  //! are kept per thread and only added up in PrintTiming().
+  static void AddTiming(int id, double elapsed, bool print=false);
 
   //! start memory profiling a specific part of the code
   static std::tuple<long long, long long> StartMemory(std::string const &label);
@@ -107,12 +121,31 @@ public:
   static bool GetCheckPoint(std::string function, std::string& msg,
     std::string& file, int& line);
 
-  //! print timing results
+  //! print timing results. The number of calls and the times are
+  //! the maximum over all processes. This has to be called by all
+  //! processes.
   static void PrintTiming(std::ostream& os);
 
+  //! write the timing results to a file in JSON format, with the
+  //! same numbers as PrintTiming(). This has to be called by all
+  //! processes.
+  static void WriteTiming(std::string const &filename);
+
   //! report memory usage
   static void PrintMemUsage(std::ostream& os);
 
+  //! start recording the begin and end time of every timer. The
+  //! events are kept in a ring buffer of bufferSize events per
+  //! thread, so only the last part of a long run is kept. This has
+  //! to be called by all processes.
+  static void StartTracing(int bufferSize=1048576);
+
+  //! stop recording events and write the events of all processes
+  //! and threads to a file in the Chrome trace event format, which
+  //! can be viewed in chrome://tracing or ui.perfetto.dev. This has
+  //! to be called by all processes.
+  static void WriteTrace(std::string const &filename);
+
   static Teuchos::RCP<Teuchos::FancyOStream> getOutputStream();
 
   static Teuchos::FancyOStream& out();
@@ -126,12 +159,6 @@ private:
 
   static std::streambuf* rdbuf_bak;
 
-  //! parameter list for timing individual parts of the code
-  static Teuchos::ParameterList timerList_;
-
-  //! keeps track of timer numbers (to get the ordering correct)
-  static int timerCounter_;
-
   //! parameter list for setting breakpoints
   static Teuchos::ParameterList breakpointList_;
 
@@ -153,6 +180,17 @@ private:
   // print the function stack if HYMLS_FUNCTION_TRACING is enabled
   static std::ostream& printFunctionStack(std::ostream& os);
 
+  //! function tracing and check points when entering a timed function
+  static void EnterFunction(std::string const &label);
+
+  //! function tracing when leaving a timed function
+  static void LeaveFunction(std::string const &label);
+
+  //! record a trace event if tracing was started
+  static void AddTraceEvent(int id,
+    std::chrono::steady_clock::time_point const &start,
+    std::chrono::steady_clock::time_point const &end);
+
   };
 
 //! this object starts a timer when it is constructed and
@@ -161,6 +199,8 @@ class TimerObject
   {
 public:
 
+  //!
+  TimerObject(int id, bool print);
   //!
   TimerObject(std::string const &s, bool print);
   //!
@@ -168,15 +208,51 @@ public:
 
 private:
   //!
-  std::string s_;
+  int id_;
   //!
   bool print_;
   //!
-  Teuchos::RCP<Epetra_Time> T_;
+  std::chrono::steady_clock::time_point start_;
   //!
-  size_t memory_used_;
+  long long memory_used_;
   //!
-  size_t memory_allocated_;
+  long long memory_allocated_;
+  };
+
+//! Caches the timer IDs that are used at one place in the code, so
+//! the label of a timer is only built and looked up the first time.
+//! The HYMLS_PROF macros keep one of these per thread in every scope
+//! that is timed.
+class TimerSite
+  {
+public:
+
+  //! ID of the timer with label "s1: s2", or "s1_L<level>: s2"
+  //! if a level is given
+  template<typename S1, typename S2>
+  int ID(S1 const &s1, S2 const &s2, int level=-1)
+    {
+    for (Entry const &entry: entries_)
+      if (entry.level == level && entry.s1 == s1 && entry.s2 == s2)
+        return entry.id;
+    return Insert(s1, s2, level);
+    }
+
+private:
+
+  struct Entry
+    {
+    std::string s1;
+    std::string s2;
+    int level;
+    int id;
+    };
+
+  //! register a new label at this site
+  int Insert(std::string const &s1, std::string const &s2, int level);
+
+  //! labels seen at this site so far
+  std::vector<Entry> entries_;
   };
 
   }
@@ -50,7 +50,13 @@ LinearSystemHymls(
  const Teuchos::RCP<NOX::Epetra::Scaling> s):
  LinearSystemAztecOO(printParams, linearSolverParams,
    iReq, cloneVector, s),
- V_(Teuchos::null)
+ V_(Teuchos::null),
+ useReusePolicy_(false),
+ refactorInterval_(1),
+ iterationThreshold_(0),
+ reusePattern_(false),
+ precAge_(0),
+ lastNumIter_(0)
 {
   // this is not tested and should not be used.
   std::cerr << "this constructor should not be used"<<std::endl;
@@ -70,7 +76,13 @@ LinearSystemHymls(
  const Teuchos::RCP<NOX::Epetra::Scaling> s):
   LinearSystemAztecOO(printParams, linearSolverParams,
     iReq, iJac, jacobian, cloneVector, s),
-  V_(Teuchos::null)
+  V_(Teuchos::null),
+  useReusePolicy_(false),
+  refactorInterval_(1),
+  iterationThreshold_(0),
+  reusePattern_(false),
+  precAge_(0),
+  lastNumIter_(0)
 {  
   // this is not tested and should not be used.
   std::cerr << "this constructor should not be used"<<std::endl;
@@ -92,7 +104,13 @@ LinearSystemHymls(
    LinearSystemAztecOO(printParams, linearSolverParams,
      iReq, iPrec, preconditioner, cloneVector, s),
    massMatrix_(massMatrix),
-   V_(Teuchos::null)
+   V_(Teuchos::null),
+   useReusePolicy_(false),
+   refactorInterval_(1),
+   iterationThreshold_(0),
+   reusePattern_(false),
+   precAge_(0),
+   lastNumIter_(0)
 {  
   reset(linearSolverParams);
 }
@@ -112,7 +130,13 @@ LinearSystemHymls(
   LinearSystemAztecOO(printParams, linearSolverParams, 
     iJac, jacobian, iPrec, preconditioner, cloneVector, s),
   massMatrix_(massMatrix),
-  V_(Teuchos::null)
+  V_(Teuchos::null),
+  useReusePolicy_(false),
+  refactorInterval_(1),
+  iterationThreshold_(0),
+  reusePattern_(false),
+  precAge_(0),
+  lastNumIter_(0)
 {
   reset(linearSolverParams);
 }
@@ -159,6 +183,17 @@ reset(Teuchos::ParameterList& p)
 //  belosList.set("Output Style",Belos::Brief);
   belosList.set("Output Style",1);
 
+  useReusePolicy_ = p.isSublist("HYMLS Preconditioner Reuse");
+  if (useReusePolicy_)
+    {
+    Teuchos::ParameterList& reuseList = p.sublist("HYMLS Preconditioner Reuse");
+    refactorInterval_ = reuseList.get("Refactor Interval", 1);
+    iterationThreshold_ = reuseList.get("Iteration Threshold", 0);
+    reusePattern_ = reuseList.get("Reuse Pattern", false);
+    }
+  precAge_ = 0;
+  lastNumIter_ = 0;
+
   // NOX puts its adaptive choice of tolerance into this place:
   double tol = p.get("Tolerance",1.0e-6);
   // so we use it to override the settings in the Belos list.
@@ -209,7 +244,23 @@ createPreconditioner(const NOX::Epetra::Vector& x, Teuchos::ParameterList& p,
 bool NOX::Epetra::LinearSystemHymls::
 recomputePreconditioner(const NOX::Epetra::Vector& x, Teuchos::ParameterList& p) const
   {
-  LinearSystemAztecOO::recomputePreconditioner(x,p);
+  Teuchos::RCP<HYMLS::Preconditioner> hymlsPrec =
+    Teuchos::rcp_dynamic_cast<HYMLS::Preconditioner>(precPtr);
+  if (useReusePolicy_ && reusePattern_ && hymlsPrec != Teuchos::null &&
+    hymlsPrec->IsInitialized())
+    {
+    // The preconditioner is built on the Jacobian, which already has its
+    // new values, so we only redo the numerical factorizations
+    if (hymlsPrec->Compute())
+      {
+      utils.out() << "WARNING:  HYMLS Compute() failed" << std::endl;
+      return false;
+      }
+    }
+  else
+    {
+    LinearSystemAztecOO::recomputePreconditioner(x,p);
+    }
   // setup deflation in the solver
   if (massMatrix_!=Teuchos::null)
     hymls_->SetMassMatrix(massMatrix_);
@@ -219,6 +270,45 @@ recomputePreconditioner(const NOX::Epetra::Vector& x, Teuchos::ParameterList& p)
   return true;
   }
 
+NOX::Epetra::LinearSystem::PreconditionerReusePolicyType
+NOX::Epetra::LinearSystemHymls::
+getPreconditionerPolicy(bool advanceReuseCounter)
+  {
+  if (!useReusePolicy_)
+    return LinearSystemAztecOO::getPreconditionerPolicy(advanceReuseCounter);
+
+  PreconditionerReusePolicyType policy = PRPT_REUSE;
+  if (!isPrecConstructed)
+    {
+    policy = PRPT_REBUILD;
+    }
+  else if ((refactorInterval_ > 0 && precAge_ >= refactorInterval_) ||
+    (iterationThreshold_ > 0 && lastNumIter_ > iterationThreshold_))
+    {
+    policy = reusePattern_ ? PRPT_RECOMPUTE : PRPT_REBUILD;
+    }
+
+  if (advanceReuseCounter)
+    {
+    if (policy != PRPT_REUSE)
+      {
+      precAge_ = 0;
+      lastNumIter_ = 0;
+      }
+    precAge_++;
+    }
+
+  if (utils.isPrintType(Utils::Details))
+    {
+    utils.out() << "HYMLS preconditioner: "
+                << (policy == PRPT_REUSE ? "reused" :
+                    policy == PRPT_RECOMPUTE ? "recomputed" : "rebuilt")
+                << std::endl;
+    }
+
+  return policy;
+  }
+
 // ***********************************************************************
 
 bool NOX::Epetra::LinearSystemHymls::
@@ -337,6 +427,7 @@ applyJacobianInverse(Teuchos::ParameterList &p,
   const Epetra_Vector& rhs = input.getEpetraVector();
   
   ierr=hymls_->ApplyInverse(rhs,sol);  
+  lastNumIter_ = hymls_->getNumIter();
   
   if (ierr!=0) {
     utils.out() << std::endl << "WARNING:  HYMLS returned "<<ierr << std::endl;
@@ -353,9 +444,8 @@ applyJacobianInverse(Teuchos::ParameterList &p,
     Teuchos::ParameterList& outputList = p.sublist("Output");
     int prevLinIters = 
       outputList.get("Total Number of Linear Iterations", 0);
-    int curLinIters = 0;
+    int curLinIters = hymls_->getNumIter();
     double achievedTol = -1.0;
- //   curLinIters = hymls_->getNumIters();
  //   for ( int i=0; i<numrhs; i++) {
  //     double actRes = actual_resids[i]/rhs_norm[i];
  //     utils.out()<<"Problem "<<i<<" : \t"<< actRes <<std::endl;
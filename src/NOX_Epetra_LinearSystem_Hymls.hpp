@@ -26,6 +26,24 @@ namespace Epetra {
     AztecOO. Right now the Aztec solver will still be      
     constructed, too. Belos parameters can be set in the   
     "Linear Solver"->"Belos" sublist.                      
+
+    If the "Linear Solver" list contains a sublist "HYMLS  
+    Preconditioner Reuse", the preconditioner reuse policy 
+    of NOX is replaced by our own, which allows a lagged   
+    preconditioner to be used for several Newton steps:    
+
+    - "Refactor Interval" (int, default 1): the            
+      preconditioner is recomputed after it has been used  
+      in this many Newton steps (0: never).                
+    - "Iteration Threshold" (int, default 0): the          
+      preconditioner is also recomputed if the last linear 
+      solve took more than this many iterations (0: off).  
+    - "Reuse Pattern" (bool, default false): only call     
+      Compute() on the HYMLS preconditioner and keep the   
+      partitioning and symbolic factorizations of          
+      Initialize(). This requires the preconditioner to be 
+      built on the Jacobian matrix itself, so that it sees 
+      the new values.                                      
  */
 class LinearSystemHymls : public LinearSystemAztecOO 
   {
@@ -107,6 +125,11 @@ public:
   //! set border on the HYMLS solver
   int SetBorder(Teuchos::RCP<const Epetra_MultiVector> const &V);
 
+  //! decides whether the preconditioner is rebuilt, recomputed or reused
+  //! in the next Newton step. See the class documentation.
+  virtual PreconditionerReusePolicyType getPreconditionerPolicy(
+    bool advanceReuseCounter = true);
+
 protected:
   
   /*! \brief Sets the epetra Jacobian operator in the Belos object.
@@ -145,7 +168,30 @@ Teuchos::RCP<const Epetra_CrsMatrix> massMatrix_;
 
 //! border for the solver
 Teuchos::RCP<const Epetra_MultiVector> V_;
-  
+
+//@}
+
+//!\name Preconditioner reuse policy
+//@{
+
+//! true if the "HYMLS Preconditioner Reuse" sublist was given
+bool useReusePolicy_;
+
+//! number of Newton steps after which the preconditioner is recomputed
+int refactorInterval_;
+
+//! number of linear iterations above which the preconditioner is recomputed
+int iterationThreshold_;
+
+//! only do the numerical part (Compute()) when recomputing
+bool reusePattern_;
+
+//! number of Newton steps in which the current preconditioner was used
+int precAge_;
+
+//! number of iterations of the last linear solve
+int lastNumIter_;
+
 //@}
 
 };
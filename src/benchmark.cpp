@@ -0,0 +1,320 @@
+// Times the individual stages of the setup and application of the
+// preconditioner on the first level and writes the results as JSON, so
+// performance regressions can be tracked on a single machine.
+//
+// The problem is defined in the same way as for hymls_main, by the
+// "Problem" list and a "Galeri Label" (e.g. "Stokes-C" or "Darcy", empty
+// for a Laplace problem). Instead of the "Driver" list we read a
+// "Benchmark" list with the parameters
+//
+//   "Galeri Label"   the Galeri problem (see MainUtils::create_matrix)
+//   "Repetitions"    how often every stage is timed (default 5)
+//   "Output File"    JSON file with the results (default "benchmark.json")
+//
+// For every stage the minimum, mean and maximum over the repetitions of
+// the maximum time over all processes are written.
+//
+// usage: mpirun -np <p> hymls_benchmark <parameter_filename> [<overloading files>]
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "HYMLS_config.h"
+
+#include "Epetra_MpiComm.h"
+#include "Epetra_Map.h"
+#include "Epetra_Import.h"
+#include "Epetra_Vector.h"
+#include "Epetra_MultiVector.h"
+#include "Epetra_CrsMatrix.h"
+#include "Epetra_CrsGraph.h"
+
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_ParameterList.hpp"
+#include "Teuchos_XMLParameterListHelpers.hpp"
+#include "Teuchos_StandardCatchMacros.hpp"
+#include "Teuchos_toString.hpp"
+
+#include "HYMLS_Macros.hpp"
+#include "HYMLS_Tools.hpp"
+#include "HYMLS_MainUtils.hpp"
+#include "HYMLS_MatrixUtils.hpp"
+#include "HYMLS_OverlappingPartitioner.hpp"
+#include "HYMLS_MatrixBlock.hpp"
+#include "HYMLS_SchurComplement.hpp"
+#include "HYMLS_SchurPreconditioner.hpp"
+#include "HYMLS_Preconditioner.hpp"
+#include "HYMLS_Solver.hpp"
+
+namespace {
+
+//! gives access to the assembly part of SchurPreconditioner::Compute()
+class BenchmarkSchurPreconditioner: public HYMLS::SchurPreconditioner
+  {
+public:
+  using HYMLS::SchurPreconditioner::SchurPreconditioner;
+  using HYMLS::SchurPreconditioner::AssembleMatrix;
+  };
+
+//! timings of all repetitions of one stage
+struct Stage
+  {
+  std::string name;
+  std::vector<double> times;
+  };
+
+//! run f on all processes and return the maximum time it took
+template<typename F>
+double TimeStage(Epetra_Comm const &comm, F f)
+  {
+  comm.Barrier();
+  auto start = std::chrono::steady_clock::now();
+  f();
+  double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  double maxElapsed = elapsed;
+  CHECK_ZERO(comm.MaxAll(&elapsed, &maxElapsed, 1));
+  return maxElapsed;
+  }
+
+//! add the time of a repetition of a stage
+void AddTime(std::vector<Stage> &stages, std::string const &name, double time)
+  {
+  for (Stage &stage: stages)
+    {
+    if (stage.name == name)
+      {
+      stage.times.push_back(time);
+      return;
+      }
+    }
+  stages.push_back(Stage{name, std::vector<double>(1, time)});
+  }
+
+void WriteJSON(std::ostream &os, Teuchos::ParameterList problemList,
+  std::string const &galeriLabel, long long numRows, int numProc,
+  int repetitions, std::vector<Stage> const &stages)
+  {
+  os << std::setprecision(10);
+  os << "{" << std::endl;
+  os << "  \"problem\": {" << std::endl;
+  os << "    \"galeri label\": \"" << galeriLabel << "\"," << std::endl;
+  os << "    \"equations\": \"" << problemList.get("Equations", "Laplace") << "\"," << std::endl;
+  os << "    \"dimension\": " << problemList.get("Dimension", 2) << "," << std::endl;
+  os << "    \"nx\": " << problemList.get("nx", 32) << "," << std::endl;
+  os << "    \"ny\": " << problemList.get("ny", 32) << "," << std::endl;
+  os << "    \"nz\": " << problemList.get("nz", 1) << "," << std::endl;
+  os << "    \"rows\": " << numRows << std::endl;
+  os << "  }," << std::endl;
+  os << "  \"processes\": " << numProc << "," << std::endl;
+  os << "  \"repetitions\": " << repetitions << "," << std::endl;
+  os << "  \"stages\": [";
+  for (size_t i = 0; i < stages.size(); i++)
+    {
+    double minTime = stages[i].times[0];
+    double maxTime = stages[i].times[0];
+    double sum = 0.0;
+    for (double t: stages[i].times)
+      {
+      minTime = std::min(minTime, t);
+      maxTime = std::max(maxTime, t);
+      sum += t;
+      }
+    os << (i ? "," : "") << std::endl;
+    os << "    {\"name\": \"" << stages[i].name << "\", "
+       << "\"min\": " << minTime << ", "
+       << "\"mean\": " << sum / stages[i].times.size() << ", "
+       << "\"max\": " << maxTime << "}";
+    }
+  os << std::endl << "  ]" << std::endl;
+  os << "}" << std::endl;
+  }
+
+  }
+
+int main(int argc, char* argv[])
+  {
+  MPI_Init(&argc, &argv);
+
+  bool status = true;
+
+  Teuchos::RCP<const Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  HYMLS::Tools::InitializeIO(comm);
+
+  try {
+
+  if (argc < 2)
+    {
+    HYMLS::Tools::Out("USAGE: hymls_benchmark <parameter_filename> [<overloading files>]");
+    MPI_Finalize();
+    return 0;
+    }
+
+  Teuchos::RCP<Teuchos::ParameterList> params =
+    Teuchos::getParametersFromXmlFile(argv[1]);
+  for (int i = 2; i < argc; i++)
+    Teuchos::updateParametersFromXmlFile(argv[i], params.ptr());
+
+  Teuchos::ParameterList &benchmarkList = params->sublist("Benchmark");
+  std::string galeriLabel = benchmarkList.get("Galeri Label", "");
+  int repetitions = benchmarkList.get("Repetitions", 5);
+  std::string outputFile = benchmarkList.get("Output File", "benchmark.json");
+  Teuchos::ParameterList galeriList;
+  if (benchmarkList.isSublist("Galeri")) galeriList = benchmarkList.sublist("Galeri");
+  params->remove("Benchmark");
+
+  // A cached partitioning or Schur complement would skip the work that
+  // we want to time. All stages below use copies of this list.
+  params->sublist("Preconditioner").set("Partition Cache", "");
+  params->sublist("Preconditioner").set("Schur Complement Cache", "");
+
+  // copy the problem list so the main utils don't modify the original
+  Teuchos::ParameterList problemList = params->sublist("Problem");
+
+  Teuchos::RCP<Epetra_Map> map = HYMLS::MainUtils::create_map(*comm, params);
+  Teuchos::RCP<Epetra_CrsMatrix> K = HYMLS::MainUtils::create_matrix(
+    *map, problemList, galeriLabel, galeriList);
+  Teuchos::RCP<Epetra_Vector> testVector =
+    HYMLS::MainUtils::create_testvector(problemList, *K);
+
+  HYMLS::Tools::Out("Benchmark of a problem with " +
+    Teuchos::toString(K->NumGlobalRows64()) + " unknowns on " +
+    Teuchos::toString(comm->NumProc()) + " processes");
+
+  Epetra_MultiVector b(*map, 1);
+  Epetra_MultiVector x(*map, 1);
+  HYMLS::MatrixUtils::Random(b);
+
+  // The constructor validates the parameters and sets the defaults
+  // that the individual stages below need.
+  Teuchos::RCP<Teuchos::ParameterList> stageParams = Teuchos::rcp(
+    new Teuchos::ParameterList(*params));
+  Teuchos::RCP<HYMLS::Preconditioner> precond = Teuchos::rcp(
+    new HYMLS::Preconditioner(K, stageParams, testVector));
+  Teuchos::ParameterList &precList = stageParams->sublist("Preconditioner");
+  std::string sdSolverType = precList.get("Subdomain Solver Type", "Sparse");
+  int numThreadsSD = precList.get("Subdomain Solver Num Threads", -1);
+  Teuchos::RCP<Teuchos::ParameterList> sdList = Teuchos::rcp(
+    new Teuchos::ParameterList(precList.sublist("Sparse Solver")));
+  precond = Teuchos::null;
+
+  Teuchos::RCP<const Epetra_Map> rangeMap = Teuchos::rcp(new Epetra_Map(K->RowMap()));
+  Teuchos::RCP<const Epetra_CrsGraph> graph =
+    Teuchos::rcpWithEmbeddedObj(&K->Graph(), K, false);
+
+  std::vector<Stage> stages;
+  for (int rep = 0; rep < repetitions; rep++)
+    {
+    HYMLS::Tools::Out("Repetition " + Teuchos::toString(rep + 1) +
+      " of " + Teuchos::toString(repetitions));
+
+    // The stages of Preconditioner::Initialize() and Compute() on the
+    // first level, one by one
+    Teuchos::RCP<HYMLS::OverlappingPartitioner> hid;
+    AddTime(stages, "Partition", TimeStage(*comm, [&]() {
+        hid = Teuchos::rcp(new HYMLS::OverlappingPartitioner(
+            rangeMap, stageParams, 0, Teuchos::null, graph));
+        }));
+
+    Teuchos::RCP<HYMLS::MatrixBlock> A11 = Teuchos::rcp(new HYMLS::MatrixBlock(hid,
+        HYMLS::HierarchicalMap::Interior, HYMLS::HierarchicalMap::Interior, 0));
+    Teuchos::RCP<HYMLS::MatrixBlock> A12 = Teuchos::rcp(new HYMLS::MatrixBlock(hid,
+        HYMLS::HierarchicalMap::Interior, HYMLS::HierarchicalMap::Separators, 0));
+    Teuchos::RCP<HYMLS::MatrixBlock> A21 = Teuchos::rcp(new HYMLS::MatrixBlock(hid,
+        HYMLS::HierarchicalMap::Separators, HYMLS::HierarchicalMap::Interior, 0));
+    Teuchos::RCP<HYMLS::MatrixBlock> A22 = Teuchos::rcp(new HYMLS::MatrixBlock(hid,
+        HYMLS::HierarchicalMap::Separators, HYMLS::HierarchicalMap::Separators, 0));
+
+    Teuchos::RCP<Epetra_CrsMatrix> reorderedMatrix;
+    AddTime(stages, "MatrixBlock::Compute", TimeStage(*comm, [&]() {
+        Epetra_Import importer(hid->OverlappingMap(), *rangeMap);
+        reorderedMatrix = Teuchos::rcp(new Epetra_CrsMatrix(Copy,
+            hid->OverlappingMap(), K->MaxNumEntries()));
+        CHECK_ZERO(reorderedMatrix->Import(*K, importer, Insert));
+        CHECK_ZERO(reorderedMatrix->FillComplete());
+
+        CHECK_ZERO(A12->Compute(K, reorderedMatrix));
+        CHECK_ZERO(A21->Compute(K, reorderedMatrix));
+        CHECK_ZERO(A22->Compute(K, reorderedMatrix));
+        }));
+
+    AddTime(stages, "Subdomain factorization", TimeStage(*comm, [&]() {
+        CHECK_ZERO(A11->InitializeSubdomainSolvers(sdSolverType, sdList, numThreadsSD));
+        CHECK_ZERO(A11->ComputeSubdomainSolvers(reorderedMatrix));
+        }));
+
+    Teuchos::RCP<HYMLS::SchurComplement> schur = Teuchos::rcp(
+      new HYMLS::SchurComplement(A11, A12, A21, A22, 0));
+
+    // same as Preconditioner::CreateTestVector()
+    Epetra_Map const &schurMap = A22->RowMap();
+    Epetra_Vector tmpVec(hid->OverlappingMap());
+    Teuchos::RCP<Epetra_Vector> schurTestVector = Teuchos::rcp(new Epetra_Vector(schurMap));
+    CHECK_ZERO(tmpVec.Import(*testVector,
+        Epetra_Import(hid->OverlappingMap(), *rangeMap), Insert));
+    CHECK_ZERO(schurTestVector->Import(tmpVec,
+        Epetra_Import(schurMap, hid->OverlappingMap()), Insert));
+
+    BenchmarkSchurPreconditioner schurPrec(schur, hid, stageParams, 0, schurTestVector);
+    CHECK_ZERO(schurPrec.Initialize());
+
+    // Only the assembly, without the factorization of the blocks and
+    // the next level, which are part of Preconditioner::Compute below
+    AddTime(stages, "SchurPreconditioner::AssembleMatrix", TimeStage(*comm, [&]() {
+        CHECK_ZERO(schurPrec.AssembleMatrix());
+        }));
+
+    Epetra_MultiVector v(schurMap, 1);
+    HYMLS::MatrixUtils::Random(v);
+    AddTime(stages, "ApplyOT", TimeStage(*comm, [&]() {
+        CHECK_ZERO(schurPrec.ApplyOT(false, v));
+        }));
+
+    // The complete preconditioner and solver
+    Teuchos::RCP<Teuchos::ParameterList> solverParams = Teuchos::rcp(
+      new Teuchos::ParameterList(*params));
+    precond = Teuchos::rcp(new HYMLS::Preconditioner(K, solverParams, testVector));
+
+    AddTime(stages, "Preconditioner::Initialize", TimeStage(*comm, [&]() {
+        CHECK_ZERO(precond->Initialize());
+        }));
+
+    AddTime(stages, "Preconditioner::Compute", TimeStage(*comm, [&]() {
+        CHECK_ZERO(precond->Compute());
+        }));
+
+    AddTime(stages, "Preconditioner::ApplyInverse", TimeStage(*comm, [&]() {
+        CHECK_ZERO(precond->ApplyInverse(b, x));
+        }));
+
+    HYMLS::Solver solver(K, precond, solverParams);
+    AddTime(stages, "Solve", TimeStage(*comm, [&]() {
+        x.PutScalar(0.0);
+        CHECK_ZERO(solver.ApplyInverse(b, x));
+        }));
+
+    precond = Teuchos::null;
+    }
+
+  std::ofstream ofs;
+  if (comm->MyPID() == 0)
+    {
+    ofs.open(outputFile.c_str());
+    WriteJSON(ofs, problemList, galeriLabel, K->NumGlobalRows64(),
+      comm->NumProc(), repetitions, stages);
+    }
+  HYMLS::Tools::Out("Benchmark results written to " + outputFile);
+
+  } TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, status);
+  if (!status) HYMLS::Tools::Fatal("Caught an exception", __FILE__, __LINE__);
+
+  MPI_Finalize();
+  return 0;
+  }
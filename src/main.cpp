@@ -42,6 +42,7 @@
 #include "HYMLS_Preconditioner.hpp"
 #include "HYMLS_Solver.hpp"
 #include "HYMLS_MatrixUtils.hpp"
+#include "HYMLS_PerformanceReport.hpp"
 
 
 
@@ -129,6 +130,10 @@ bool status=true;
     bool print_final_list = driverList.get("Store Final Parameter List",false);        
     bool store_solution = driverList.get("Store Solution",true);
     bool store_matrix = driverList.get("Store Matrix",false);
+    std::string report_file = driverList.get("Performance Report","");
+    std::string trace_file = driverList.get("Trace File","");
+    std::string timing_file = driverList.get("Timing File","");
+    int trace_buffer_size = driverList.get("Trace Buffer Size",1048576);
     int numComputes=driverList.get("Number of factorizations",1);
     int numSolves=driverList.get("Number of solves",1);
     int numRhs   =driverList.get("Number of rhs",1);
@@ -169,6 +174,11 @@ bool status=true;
     driverList.unused(std::cerr);
     params->remove("Driver");
 
+    if (trace_file != "")
+      {
+      HYMLS::Tools::StartTracing(trace_buffer_size);
+      }
+
         
     Teuchos::ParameterList& probl_params = params->sublist("Problem");
             
@@ -222,9 +232,18 @@ HYMLS::MatrixUtils::Dump(*map,"MainMatrixMap.txt");
     if (nullSpaceType=="File")
       {
       nullSpace=Teuchos::rcp(new Epetra_MultiVector(*map,dim0));
-      std::string nullSpace_file=datadir+"/nullSpace.mtx";
-      HYMLS::Tools::Out("Try to read null space from file '"+nullSpace_file+"'");
-      HYMLS::MatrixUtils::mmread(nullSpace_file,*nullSpace);
+      if (file_format=="Binary")
+        {
+        std::string nullSpace_file=datadir+"/nullSpace.bin";
+        HYMLS::Tools::Out("Try to read null space from file '"+nullSpace_file+"'");
+        HYMLS::MatrixUtils::binread(nullSpace_file,*nullSpace);
+        }
+      else
+        {
+        std::string nullSpace_file=datadir+"/nullSpace.mtx";
+        HYMLS::Tools::Out("Try to read null space from file '"+nullSpace_file+"'");
+        HYMLS::MatrixUtils::mmread(nullSpace_file,*nullSpace);
+        }
       }
     }
 
@@ -489,6 +508,27 @@ HYMLS_DEBVAR(*b);
     HYMLS::MatrixUtils::Dump(*b, "RHS.txt",false);
     }
     
+  if (report_file != "")
+    {
+    HYMLS::Tools::Out("write performance report to '"+report_file+"'");
+    HYMLS::PerformanceReport report(comm);
+    solver->AddToReport(report);
+    precond->AddToReport(report);
+    CHECK_ZERO(report.Write(report_file));
+    }
+
+  if (trace_file != "")
+    {
+    HYMLS::Tools::Out("write trace to '"+trace_file+"'");
+    HYMLS::Tools::WriteTrace(trace_file);
+    }
+
+  if (timing_file != "")
+    {
+    HYMLS::Tools::Out("write timing results to '"+timing_file+"'");
+    HYMLS::Tools::WriteTiming(timing_file);
+    }
+
   if (print_final_list)
     {
     if (comm->MyPID()==0)
@@ -0,0 +1,106 @@
+// Converts a matrix or (multi)vector in MatrixMarket format to the binary
+// format of HYMLS, which can be read much faster in parallel, e.g. by
+// setting "File Format" to "Binary" in the "Driver" list of main.cpp.
+//
+// usage: mpirun -np <p> hymls_mtx2bin <input.mtx> <output.bin>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <mpi.h>
+
+#include "HYMLS_config.h"
+
+#include "Epetra_MpiComm.h"
+#include "Epetra_Map.h"
+#include "Epetra_CrsMatrix.h"
+#include "Epetra_MultiVector.h"
+
+#include "EpetraExt_CrsMatrixIn.h"
+#include "EpetraExt_MultiVectorIn.h"
+
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_StandardCatchMacros.hpp"
+
+#include "HYMLS_Macros.hpp"
+#include "HYMLS_Tools.hpp"
+#include "HYMLS_MatrixUtils.hpp"
+
+int main(int argc, char* argv[])
+  {
+  MPI_Init(&argc, &argv);
+
+  bool status = true;
+
+  Teuchos::RCP<const Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  HYMLS::Tools::InitializeIO(comm);
+
+  try {
+
+  if (argc != 3)
+    {
+    HYMLS::Tools::Out("USAGE: hymls_mtx2bin <input.mtx> <output.bin>");
+    MPI_Finalize();
+    return 0;
+    }
+
+  std::string infile = argv[1];
+  std::string outfile = argv[2];
+
+  // The first line tells us if this is a sparse matrix (coordinate) or
+  // a dense (multi)vector (array), the first line that is not a comment
+  // gives its size.
+  std::ifstream ifs(infile.c_str());
+  if (!ifs)
+    {
+    HYMLS::Tools::Error("could not open file '" + infile + "'", __FILE__, __LINE__);
+    }
+
+  std::string line;
+  std::getline(ifs, line);
+  bool isMatrix = line.find("coordinate") != std::string::npos;
+  bool isArray = line.find("array") != std::string::npos;
+  if (line.find("%%MatrixMarket") != 0 || (!isMatrix && !isArray))
+    {
+    HYMLS::Tools::Error("'" + infile + "' is not a MatrixMarket file", __FILE__, __LINE__);
+    }
+
+  while (std::getline(ifs, line) && line[0] == '%');
+  long long m = 0, n = 0;
+  std::istringstream iss(line);
+  iss >> m >> n;
+  ifs.close();
+
+  if (isMatrix)
+    {
+    HYMLS::Tools::Out("convert matrix '" + infile + "' to '" + outfile + "'");
+
+    Epetra_Map map((hymls_gidx)m, 0, *comm);
+    Epetra_CrsMatrix* A;
+#ifdef HYMLS_LONG_LONG
+    CHECK_ZERO(EpetraExt::MatrixMarketFileToCrsMatrix64(infile.c_str(), map, A));
+#else
+    CHECK_ZERO(EpetraExt::MatrixMarketFileToCrsMatrix(infile.c_str(), map, A));
+#endif
+    CHECK_ZERO(HYMLS::MatrixUtils::binwrite(outfile, *A));
+    delete A;
+    }
+  else
+    {
+    HYMLS::Tools::Out("convert vector '" + infile + "' to '" + outfile + "'");
+
+    Epetra_Map map((hymls_gidx)m, 0, *comm);
+    Epetra_MultiVector* v;
+    CHECK_ZERO(EpetraExt::MatrixMarketFileToMultiVector(infile.c_str(), map, v));
+    CHECK_ZERO(HYMLS::MatrixUtils::binwrite(outfile, *v));
+    delete v;
+    }
+
+  } TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, status);
+  if (!status) HYMLS::Tools::Fatal("Caught an exception", __FILE__, __LINE__);
+
+  MPI_Finalize();
+  return 0;
+  }
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+'''Strong and weak scaling runs of hymls_main with a report of the
+parallel efficiency of every phase.
+
+For every number of processes a copy of the given parameter file is
+made in which the Driver writes its timers to a JSON file (see the
+"Timing File" parameter). In weak scaling mode the grid size in the
+"Problem" list is increased along with the number of processes, such
+that the number of unknowns per process stays the same. In strong
+scaling mode the grid is left as it is.
+
+The efficiency is computed relative to the run with the smallest
+number of processes. Phases with an efficiency below the threshold
+are flagged, and the script then exits with a nonzero status.
+
+Example:
+
+  python3 scaling.py --mode weak --procs 1,2,4,8 ../cavity.xml
+'''
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+DEFAULT_PHASES = ['main: Initialize Preconditioner',
+                  'main: Compute Preconditioner',
+                  'main: Solve']
+
+
+def find_list(root, name):
+    for child in root.findall('ParameterList'):
+        if child.get('name') == name:
+            return child
+    return None
+
+
+def set_parameter(plist, name, type_name, value):
+    for param in plist.findall('Parameter'):
+        if param.get('name') == name:
+            param.set('type', type_name)
+            param.set('value', str(value))
+            return
+    ET.SubElement(plist, 'Parameter', name=name, type=type_name, value=str(value))
+
+
+def get_parameter(plist, name, default):
+    for param in plist.findall('Parameter'):
+        if param.get('name') == name:
+            return int(param.get('value'))
+    return default
+
+
+def prime_factors(n):
+    factors = []
+    p = 2
+    while p * p <= n:
+        while n % p == 0:
+            factors.append(p)
+            n //= p
+        p += 1
+    if n > 1:
+        factors.append(n)
+    return factors
+
+
+def weak_grid(dims, procs):
+    '''Multiply the grid dimensions by the prime factors of procs, each
+    time on the dimension that has been scaled the least so far, so the
+    number of grid points grows exactly with procs.'''
+    dims = list(dims)
+    scale = [1] * len(dims)
+    for p in sorted(prime_factors(procs), reverse=True):
+        i = scale.index(min(scale))
+        scale[i] *= p
+        dims[i] *= p
+    return dims
+
+
+def make_input(base, mode, procs, run_dir, timing_file):
+    tree = ET.parse(base)
+    root = tree.getroot()
+
+    driver = find_list(root, 'Driver')
+    if driver is None:
+        driver = ET.SubElement(root, 'ParameterList', name='Driver')
+    set_parameter(driver, 'Timing File', 'string', timing_file)
+    set_parameter(driver, 'Store Solution', 'bool', 0)
+
+    problem = find_list(root, 'Problem')
+    if problem is None:
+        sys.exit('%s has no "Problem" list' % base)
+    dim = get_parameter(problem, 'Dimension', 2)
+    names = ['nx', 'ny', 'nz'][:dim]
+    dims = [get_parameter(problem, name, 1) for name in names]
+    if mode == 'weak':
+        dims = weak_grid(dims, procs)
+        for name, n in zip(names, dims):
+            set_parameter(problem, name, 'int', n)
+
+    filename = os.path.join(run_dir, 'params.xml')
+    tree.write(filename)
+    return filename, dims
+
+
+def command_path(command):
+    '''Commands are run from the run directory, so relative paths have
+    to be made absolute. Plain names are looked up in the PATH.'''
+    if os.path.dirname(command):
+        return os.path.abspath(command)
+    return command
+
+
+def run(args, procs):
+    run_dir = 'scaling_%s_p%d' % (args.mode, procs)
+    if not os.path.isdir(run_dir):
+        os.makedirs(run_dir)
+
+    timing_file = 'timing.json'
+    params, dims = make_input(args.input, args.mode, procs, run_dir,
+                              timing_file)
+
+    cmd = [command_path(args.mpirun), '-np', str(procs)] + \
+          args.mpirun_args.split() + \
+          [command_path(args.executable), os.path.basename(params)]
+    print('Running %s with grid %s in %s' % (
+        ' '.join(cmd), 'x'.join(str(n) for n in dims), run_dir))
+    sys.stdout.flush()
+
+    with open(os.path.join(run_dir, 'output.log'), 'w') as log:
+        status = subprocess.call(cmd, cwd=run_dir, stdout=log,
+                                 stderr=subprocess.STDOUT)
+    if status != 0:
+        sys.exit('%s failed with status %d, see %s' % (
+            args.executable, status, os.path.join(run_dir, 'output.log')))
+
+    with open(os.path.join(run_dir, timing_file)) as f:
+        timers = json.load(f)['timers']
+    return dims, dict((t['label'], t['time']) for t in timers)
+
+
+def efficiency(mode, base_procs, base_time, procs, time):
+    if time <= 0.0:
+        return None
+    if mode == 'strong':
+        return base_time * base_procs / (time * procs)
+    return base_time / time
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Strong and weak scaling runs of hymls_main.')
+    parser.add_argument('input', help='parameter file for hymls_main')
+    parser.add_argument('--mode', choices=['strong', 'weak'], default='strong')
+    parser.add_argument('--procs', default='1,2,4',
+                        help='comma separated list of process counts')
+    parser.add_argument('--executable', default='hymls_main')
+    parser.add_argument('--mpirun', default='mpirun')
+    parser.add_argument('--mpirun-args', default='--oversubscribe',
+                        help='extra arguments for mpirun')
+    parser.add_argument('--threshold', type=float, default=0.7,
+                        help='flag phases with a lower efficiency')
+    parser.add_argument('--phase', action='append', dest='phases',
+                        help='timer label of a phase to report (can be '
+                             'given more than once)')
+    parser.add_argument('--output', default='scaling.json',
+                        help='JSON file with the results')
+    args = parser.parse_args()
+
+    procs = sorted(set(int(p) for p in args.procs.split(',')))
+    phases = args.phases or DEFAULT_PHASES
+
+    results = []
+    for p in procs:
+        dims, times = run(args, p)
+        results.append({'processes': p, 'grid': dims, 'times': times})
+
+    base = results[0]
+    flagged = []
+    report = {'mode': args.mode, 'threshold': args.threshold, 'runs': []}
+
+    print('')
+    print('%-40s' % 'Phase' + ''.join('%18s' % ('p=%d' % r['processes'])
+                                      for r in results))
+    for phase in phases:
+        if phase not in base['times']:
+            print('%-40s not timed in the run with %d processes' % (
+                phase, base['processes']))
+            continue
+        line = '%-40s' % phase
+        for r in results:
+            time = r['times'].get(phase)
+            eff = None
+            if time is not None:
+                eff = efficiency(args.mode, base['processes'],
+                                 base['times'][phase], r['processes'], time)
+            r.setdefault('efficiency', {})[phase] = eff
+            if eff is None:
+                line += '%18s' % '-'
+                continue
+            mark = ''
+            if eff < args.threshold:
+                mark = '*'
+                flagged.append((phase, r['processes'], eff))
+            line += '%18s' % ('%.3fs %5.1f%%%s' % (time, 100 * eff, mark))
+        print(line)
+
+    for r in results:
+        report['runs'].append({'processes': r['processes'],
+                               'grid': r['grid'],
+                               'phases': dict((phase, {
+                                   'time': r['times'].get(phase),
+                                   'efficiency': r.get('efficiency', {}).get(phase)})
+                                   for phase in phases)})
+    report['flagged'] = [{'phase': phase, 'processes': p, 'efficiency': eff}
+                         for phase, p, eff in flagged]
+
+    with open(args.output, 'w') as f:
+        json.dump(report, f, indent=2)
+
+    if flagged:
+        print('')
+        for phase, p, eff in flagged:
+            print('WARNING: efficiency of "%s" on %d processes is %.1f%% '
+                  '(threshold %.1f%%)' % (phase, p, 100 * eff,
+                                         100 * args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
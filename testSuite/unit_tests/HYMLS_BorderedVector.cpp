@@ -0,0 +1,122 @@
+#include "HYMLS_BorderedVector.hpp"
+
+#include "Epetra_MpiComm.h"
+#include "Epetra_Map.h"
+#include "Epetra_MultiVector.h"
+#include "Epetra_SerialDenseMatrix.h"
+
+#include "Teuchos_SerialDenseMatrix.hpp"
+
+#include "HYMLS_UnitTests.hpp"
+
+#include <cmath>
+#include <vector>
+
+TEUCHOS_UNIT_TEST(BorderedVector, Dot)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+
+  int n = 10;
+  Epetra_Map map(n, 0, comm);
+  Epetra_MultiVector x1(map, 2);
+  Epetra_MultiVector y1(map, 2);
+  x1.PutScalar(2.0);
+  y1.PutScalar(3.0);
+
+  // The border has the same values on every process, so it should only
+  // be counted once
+  Epetra_SerialDenseMatrix x2(2, 2);
+  Epetra_SerialDenseMatrix y2(2, 2);
+  x2.Scale(0.0);
+  y2.Scale(0.0);
+  x2(0, 0) = 1.0;
+  x2(1, 0) = 1.0;
+  x2(0, 1) = -1.0;
+  y2(1, 1) = 4.0;
+
+  HYMLS::BorderedVector x(View, x1, x2);
+  HYMLS::BorderedVector y(View, y1, y2);
+
+  std::vector<double> result(2, 0.0);
+  TEST_EQUALITY(x.Dot(y, result), 0);
+  TEST_FLOATING_EQUALITY(result[0], 2.0 * 3.0 * n, 1e-14);
+  TEST_FLOATING_EQUALITY(result[1], 2.0 * 3.0 * n, 1e-14);
+
+  TEST_EQUALITY(y.Dot(x, result), 0);
+  TEST_FLOATING_EQUALITY(result[0], 2.0 * 3.0 * n, 1e-14);
+
+  TEST_EQUALITY(x.Dot(x, result), 0);
+  TEST_FLOATING_EQUALITY(result[0], 2.0 * 2.0 * n + 2.0, 1e-14);
+  TEST_FLOATING_EQUALITY(result[1], 2.0 * 2.0 * n + 1.0, 1e-14);
+
+  y2(0, 0) = 5.0;
+  TEST_EQUALITY(x.Dot(y, result), 0);
+  TEST_FLOATING_EQUALITY(result[0], 2.0 * 3.0 * n + 5.0, 1e-14);
+  }
+
+TEUCHOS_UNIT_TEST(BorderedVector, Norm)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+
+  int n = 10;
+  Epetra_Map map(n, 0, comm);
+  Epetra_MultiVector x1(map, 2);
+  x1.PutScalar(2.0);
+
+  Epetra_SerialDenseMatrix x2(2, 2);
+  x2(0, 0) = 1.0;
+  x2(1, 0) = -1.0;
+  x2(0, 1) = 0.0;
+  x2(1, 1) = -3.0;
+
+  HYMLS::BorderedVector x(View, x1, x2);
+
+  std::vector<double> result(2, 0.0);
+  TEST_EQUALITY(x.Norm1(result), 0);
+  TEST_FLOATING_EQUALITY(result[0], 2.0 * n + 2.0, 1e-14);
+  TEST_FLOATING_EQUALITY(result[1], 2.0 * n + 3.0, 1e-14);
+
+  TEST_EQUALITY(x.Norm2(result), 0);
+  TEST_FLOATING_EQUALITY(result[0], sqrt(4.0 * n + 2.0), 1e-14);
+  TEST_FLOATING_EQUALITY(result[1], sqrt(4.0 * n + 9.0), 1e-14);
+
+  TEST_EQUALITY(x.NormInf(result), 0);
+  TEST_FLOATING_EQUALITY(result[0], 2.0, 1e-14);
+  TEST_FLOATING_EQUALITY(result[1], 3.0, 1e-14);
+  }
+
+TEUCHOS_UNIT_TEST(BorderedVector, MvTransMv)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+
+  int n = 10;
+  Epetra_Map map(n, 0, comm);
+  Epetra_MultiVector x1(map, 2);
+  Epetra_MultiVector y1(map, 3);
+  x1.PutScalar(2.0);
+  y1.PutScalar(3.0);
+
+  Epetra_SerialDenseMatrix x2(2, 2);
+  Epetra_SerialDenseMatrix y2(2, 3);
+  x2.Scale(0.0);
+  y2.Scale(0.0);
+  x2(1, 1) = 1.0;
+  y2(1, 2) = 4.0;
+
+  HYMLS::BorderedVector x(View, x1, x2);
+  HYMLS::BorderedVector y(View, y1, y2);
+
+  Teuchos::SerialDenseMatrix<int, double> B(2, 3);
+  B.putScalar(1.0);
+
+  Belos::MultiVecTraits<double, HYMLS::BorderedVector>::MvTransMv(0.5, x, y, B);
+
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 3; j++)
+      {
+      double expected = 0.5 * 2.0 * 3.0 * n;
+      if (i == 1 && j == 2)
+        expected += 0.5 * 4.0;
+      TEST_FLOATING_EQUALITY(B(i, j), expected, 1e-14);
+      }
+  }
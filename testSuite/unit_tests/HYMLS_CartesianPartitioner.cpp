@@ -5,6 +5,7 @@
 
 #include "Epetra_MpiComm.h"
 #include "Epetra_Map.h"
+#include "Epetra_Vector.h"
 
 #include "HYMLS_config.h"
 #include "HYMLS_UnitTests.hpp"
@@ -13,6 +14,8 @@
 #include "HYMLS_InteriorGroup.hpp"
 #include "HYMLS_SeparatorGroup.hpp"
 
+#include <algorithm>
+
 TEUCHOS_UNIT_TEST(CartesianPartitioner, Partition2D)
   {
   Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
@@ -157,6 +160,48 @@ TEUCHOS_UNIT_TEST(CartesianPartitioner, MoveMap)
   part2.Partition(true);
   }
 
+TEUCHOS_UNIT_TEST(CartesianPartitioner, Weighted)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  int nx = 16;
+  int ny = 16;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(
+    new Teuchos::ParameterList);
+  params->sublist("Problem").set("nx", nx);
+  params->sublist("Problem").set("ny", ny);
+  params->sublist("Problem").set("Dimension", 2);
+  params->sublist("Problem").set("Degrees of Freedom", 1);
+  params->sublist("Preconditioner").set("Separator Length", 4);
+
+  // Only the left column of subdomains is active
+  Teuchos::RCP<Epetra_Map> map = Teuchos::rcp(new Epetra_Map(nx * ny, 0, *comm));
+  Teuchos::RCP<Epetra_Vector> weights = Teuchos::rcp(new Epetra_Vector(*map));
+  for (int lid = 0; lid < map->NumMyElements(); lid++)
+    (*weights)[lid] = map->GID64(lid) % nx < 4 ? 1.0 : 0.0;
+
+  HYMLS::CartesianPartitioner part(map, params, *comm);
+  part.SetWeights(weights);
+  part.Partition(false);
+
+  ENABLE_OUTPUT;
+
+  TEST_EQUALITY(part.GetMap()->NumGlobalElements64(), nx * ny);
+
+  int numActive = 0;
+  for (int lid = 0; lid < part.GetMap()->NumMyElements(); lid++)
+    if (part.GetMap()->GID64(lid) % nx < 4)
+      numActive++;
+
+  // Every processor gets an equal share of the 4 active subdomains
+  int nprocs = std::min(comm->NumProc(), 4);
+  if (comm->MyPID() < nprocs)
+    TEST_COMPARE(numActive, >, 0);
+  TEST_COMPARE(numActive, <=, 4 * 16 / nprocs + 16);
+  }
+
 #ifdef HYMLS_LONG_LONG
 TEUCHOS_UNIT_TEST(CartesianPartitioner, GID64)
   {
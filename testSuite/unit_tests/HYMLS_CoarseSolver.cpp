@@ -123,3 +123,57 @@ TEUCHOS_UNIT_TEST(CoarseSolver, BorderedApplyInverse)
   TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X, *X_EX), <, 1e-10);
   TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X2, *X_EX2), <, 1e-10);
   }
+
+TEUCHOS_UNIT_TEST(CoarseSolver, LowRankBorderUpdate)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->set("Low-Rank Border Update", true);
+  Teuchos::RCP<HYMLS::CoarseSolver> solver = createCoarseSolver(params, comm);
+  int ierr = solver->Initialize();
+  TEST_EQUALITY(ierr, 0);
+
+  ierr = solver->Compute();
+  TEST_EQUALITY(ierr, 0);
+
+  Epetra_Map const &map = solver->OperatorRangeMap();
+  Teuchos::RCP<Epetra_MultiVector> V = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  V->Random();
+  Teuchos::RCP<Epetra_MultiVector> W = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  W->Random();
+  Teuchos::RCP<Epetra_SerialDenseMatrix> C = HYMLS::UnitTests::RandomSerialDenseMatrix(2, 2, *comm);
+
+  // Setting the border should not require a new Compute()
+  ierr = solver->SetBorder(V, W, C);
+  TEST_EQUALITY(ierr, 0);
+  TEST_ASSERT(solver->IsComputed());
+
+  Teuchos::RCP<Epetra_MultiVector> X = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  X->Random();
+
+  Teuchos::RCP<Epetra_MultiVector> X_EX = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  X_EX->Random();
+
+  Teuchos::RCP<Epetra_SerialDenseMatrix> X2 = HYMLS::UnitTests::RandomSerialDenseMatrix(2, 2, *comm);
+
+  Teuchos::RCP<Epetra_SerialDenseMatrix> X_EX2 = HYMLS::UnitTests::RandomSerialDenseMatrix(2, 2, *comm);
+
+  Teuchos::RCP<Epetra_MultiVector> B = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  solver->Matrix().Multiply('N', *X_EX, *B);
+  ierr = B->Multiply('N', 'N', 1.0, *V, *HYMLS::DenseUtils::CreateView(*X_EX2), 1.0);
+  TEST_EQUALITY(ierr, 0);
+
+  Teuchos::RCP<Epetra_SerialDenseMatrix> B2 = Teuchos::rcp(new Epetra_SerialDenseMatrix(2, 2));
+  HYMLS::DenseUtils::MatMul(*W, *X_EX, *B2);
+  ierr = B2->Multiply('N', 'N', 1.0, *C, *X_EX2, 1.0);
+  TEST_EQUALITY(ierr, 0);
+
+  ierr = solver->ApplyInverse(*B, *B2, *X, *X2);
+  TEST_EQUALITY(ierr, 0);
+
+  // Check if they are the same
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X, *X_EX), <, 1e-10);
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X2, *X_EX2), <, 1e-10);
+  }
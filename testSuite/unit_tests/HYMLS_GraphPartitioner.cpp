@@ -0,0 +1,249 @@
+#include "HYMLS_GraphPartitioner.hpp"
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+#include "Epetra_MpiComm.h"
+#include "Epetra_Map.h"
+#include "Epetra_CrsMatrix.h"
+#include "Epetra_Vector.h"
+
+#include "Galeri_CrsMatrices.h"
+#include "GaleriExt_CrsMatrices.h"
+
+#include "HYMLS_config.h"
+#include "HYMLS_UnitTests.hpp"
+#include "HYMLS_Tools.hpp"
+#include "HYMLS_InteriorGroup.hpp"
+#include "HYMLS_SeparatorGroup.hpp"
+
+#include <algorithm>
+
+// Check that every owned node is in exactly one interior or is a separator
+// node, and that interior nodes only couple to nodes of their own subdomain
+static bool checkGroups(HYMLS::GraphPartitioner const &part, Epetra_CrsMatrix const &A,
+  Teuchos::FancyOStream &out)
+  {
+  bool success = true;
+
+  Teuchos::Array<int> numInterior(A.NumMyRows(), 0);
+  Teuchos::Array<int> numSeparator(A.NumMyRows(), 0);
+  for (int sd = 0; sd < part.NumLocalParts(); sd++)
+    {
+    HYMLS::InteriorGroup interior_group;
+    Teuchos::Array<HYMLS::SeparatorGroup> separator_groups;
+    part.GetGroups(sd, interior_group, separator_groups);
+
+    Teuchos::Array<hymls_gidx> nodes = interior_group.nodes();
+
+    for (hymls_gidx gid: interior_group.nodes())
+      numInterior[A.LRID(gid)]++;
+
+    for (auto const &group: separator_groups)
+      for (hymls_gidx gid: group.nodes())
+        {
+        nodes.append(gid);
+        if (A.LRID(gid) >= 0)
+          numSeparator[A.LRID(gid)]++;
+        }
+    std::sort(nodes.begin(), nodes.end());
+
+    for (hymls_gidx gid: interior_group.nodes())
+      {
+      int len;
+      int *indices;
+      double *values;
+      A.ExtractMyRowView(A.LRID(gid), len, values, indices);
+      for (int j = 0; j < len; j++)
+        TEST_ASSERT(std::binary_search(nodes.begin(), nodes.end(), A.GCID64(indices[j])));
+      }
+    }
+
+  for (int i = 0; i < A.NumMyRows(); i++)
+    {
+    TEST_COMPARE(numInterior[i], <=, 1);
+    TEST_ASSERT(numInterior[i] + numSeparator[i] > 0);
+    TEST_ASSERT(!(numInterior[i] && numSeparator[i]));
+    }
+
+  return success;
+  }
+
+TEUCHOS_UNIT_TEST(GraphPartitioner, Laplace2D)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  int nx = 32;
+  int ny = 32;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(
+    new Teuchos::ParameterList);
+  params->sublist("Problem").set("Dimension", 2);
+  params->sublist("Problem").set("Degrees of Freedom", 1);
+  params->sublist("Preconditioner").set("Separator Length", 4);
+
+  Epetra_Map map(nx * ny, 0, *comm);
+  Teuchos::ParameterList galeriList;
+  galeriList.set("nx", nx);
+  galeriList.set("ny", ny);
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(
+    Galeri::CreateCrsMatrix("Laplace2D", &map, galeriList));
+
+  HYMLS::GraphPartitioner part(Teuchos::rcp(&map, false),
+    Teuchos::rcp(&A->Graph(), false), params, *comm);
+  part.Partition();
+
+  ENABLE_OUTPUT;
+
+  // Every process makes subdomains of at most 4x4 nodes
+  TEST_COMPARE(part.NumGlobalParts(0, 0, 0), >=, nx * ny / 16);
+  TEST_COMPARE(part.NumGlobalParts(0, 0, 0), <=, nx * ny / 16 + comm->NumProc());
+  TEST_ASSERT(checkGroups(part, *A, out));
+  }
+
+TEUCHOS_UNIT_TEST(GraphPartitioner, Stokes2D)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  int nx = 16;
+  int ny = 16;
+  int dof = 3;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(
+    new Teuchos::ParameterList);
+  Teuchos::ParameterList &problemList = params->sublist("Problem");
+  problemList.set("nx", nx);
+  problemList.set("ny", ny);
+  problemList.set("Dimension", 2);
+  problemList.set("Equations", "Stokes-C");
+  params->sublist("Preconditioner").set("Separator Length", 4);
+
+  Teuchos::RCP<Epetra_Map> map = HYMLS::UnitTests::create_random_map(
+    *comm, nx * ny * dof, dof);
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(
+    GaleriExt::CreateCrsMatrix("Stokes2D", map.get(), problemList));
+
+  // Pretend that we don't know the grid size
+  problemList.remove("nx");
+  problemList.remove("ny");
+
+  HYMLS::GraphPartitioner part(map,
+    Teuchos::rcp(&A->Graph(), false), params, *comm);
+  part.Partition();
+
+  ENABLE_OUTPUT;
+
+  TEST_ASSERT(checkGroups(part, *A, out));
+
+  // Pressures are never on a separator, but one is retained per subdomain
+  for (int sd = 0; sd < part.NumLocalParts(); sd++)
+    {
+    HYMLS::InteriorGroup interior_group;
+    Teuchos::Array<HYMLS::SeparatorGroup> separator_groups;
+    part.GetGroups(sd, interior_group, separator_groups);
+
+    int numRetained = 0;
+    for (auto const &group: separator_groups)
+      for (hymls_gidx gid: group.nodes())
+        if (gid % dof == 2)
+          {
+          TEST_EQUALITY(group.length(), 1);
+          numRetained++;
+          }
+    TEST_EQUALITY(numRetained, 1);
+    }
+  }
+
+TEUCHOS_UNIT_TEST(GraphPartitioner, MaskedLaplace2D)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  int nx = 32;
+  int ny = 32;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(
+    new Teuchos::ParameterList);
+  params->sublist("Problem").set("Dimension", 2);
+  params->sublist("Problem").set("Degrees of Freedom", 1);
+  params->sublist("Preconditioner").set("Separator Length", 4);
+
+  // Laplace problem where the right half of the domain is masked out
+  // by Dirichlet conditions
+  Epetra_Map map(nx * ny, 0, *comm);
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(new Epetra_CrsMatrix(Copy, map, 5));
+  for (int lid = 0; lid < map.NumMyElements(); lid++)
+    {
+    hymls_gidx gid = map.GID64(lid);
+    int i = gid % nx;
+    int j = gid / nx;
+
+    hymls_gidx indices[5] = {gid, gid - 1, gid + 1, gid - nx, gid + nx};
+    double values[5] = {4, -1, -1, -1, -1};
+    bool valid[5] = {true, i > 0, i < nx / 2 - 1, j > 0, j < ny - 1};
+    for (int k = 0; k < 5; k++)
+      if (k == 0 || (valid[k] && i < nx / 2))
+        A->InsertGlobalValues(gid, 1, &values[k], &indices[k]);
+    }
+  A->FillComplete();
+
+  HYMLS::GraphPartitioner part(Teuchos::rcp(&map, false),
+    Teuchos::rcp(&A->Graph(), false), params, *comm);
+  part.Partition();
+
+  ENABLE_OUTPUT;
+
+  // Only the active cells count for the number of subdomains
+  TEST_COMPARE(part.NumGlobalParts(0, 0, 0), <=, nx * ny / 32 + comm->NumProc());
+  TEST_ASSERT(checkGroups(part, *A, out));
+  }
+
+TEUCHOS_UNIT_TEST(GraphPartitioner, Weights)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  int nx = 32;
+  int ny = 32;
+  int numProc = comm->NumProc();
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(
+    new Teuchos::ParameterList);
+  params->sublist("Problem").set("Dimension", 2);
+  params->sublist("Problem").set("Degrees of Freedom", 1);
+  params->sublist("Preconditioner").set("Separator Length", 4);
+  params->sublist("Preconditioner").set("Number of Subdomains", 4 * (numProc + 2));
+
+  Epetra_Map map(nx * ny, 0, *comm);
+  Teuchos::ParameterList galeriList;
+  galeriList.set("nx", nx);
+  galeriList.set("ny", ny);
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(
+    Galeri::CreateCrsMatrix("Laplace2D", &map, galeriList));
+
+  // The rows of the first process are three times as expensive,
+  // so it should get about three times as many subdomains
+  Teuchos::RCP<Epetra_Vector> weights = Teuchos::rcp(new Epetra_Vector(map));
+  weights->PutScalar(comm->MyPID() == 0 ? 3.0 : 1.0);
+
+  HYMLS::GraphPartitioner part(Teuchos::rcp(&map, false),
+    Teuchos::rcp(&A->Graph(), false), params, *comm);
+  part.SetWeights(weights);
+  part.Partition();
+
+  ENABLE_OUTPUT;
+
+  TEST_ASSERT(checkGroups(part, *A, out));
+
+  if (numProc > 1)
+    {
+    int parts[2] = {0, 0};
+    if (comm->MyPID() < 2)
+      parts[comm->MyPID()] = part.NumLocalParts();
+    int allParts[2];
+    CHECK_ZERO(comm->MaxAll(parts, allParts, 2));
+    TEST_COMPARE(allParts[0], >, 2 * allParts[1]);
+    }
+  }
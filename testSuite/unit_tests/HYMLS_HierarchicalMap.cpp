@@ -34,6 +34,11 @@ public:
     {
     return HYMLS::HierarchicalMap::Reset(sd);
     }
+
+  int FillComplete()
+    {
+    return HYMLS::HierarchicalMap::FillComplete();
+    }
   };
 
 TEUCHOS_UNIT_TEST(HierarchicalMap, AddInteriorGroup)
@@ -170,6 +175,111 @@ TEUCHOS_UNIT_TEST(HierarchicalMap, NumSeparatorGroups)
   TEST_EQUALITY(ret, 1);
   }
 
+TEUCHOS_UNIT_TEST(HierarchicalMap, FillComplete)
+  {
+  Teuchos::RCP<Epetra_MpiComm> Comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+
+  hymls_gidx n = 100;
+  Teuchos::RCP<Epetra_Map> map = Teuchos::rcp(new Epetra_Map(n, 0, *Comm));
+  int numMyElements = map->NumMyElements();
+
+  // Two subdomains that share a separator group of two nodes
+  HYMLS::InteriorGroup interior1, interior2;
+  HYMLS::SeparatorGroup separator;
+  for (int lid = 0; lid < numMyElements; lid++)
+    {
+    if (lid < numMyElements / 2 - 1)
+      interior1.append(map->GID64(lid));
+    else if (lid < numMyElements / 2 + 1)
+      separator.append(map->GID64(lid));
+    else
+      interior2.append(map->GID64(lid));
+    }
+
+  TestableHierarchicalMap hmap(map);
+  hmap.Reset(2);
+  hmap.AddInteriorGroup(0, interior1);
+  hmap.AddInteriorGroup(1, interior2);
+  hmap.AddSeparatorGroup(0, separator);
+  hmap.AddSeparatorGroup(1, separator);
+  hmap.FillComplete();
+
+  TEST_EQUALITY(hmap.OverlappingMap().NumMyElements(), numMyElements);
+  TEST_COMPARE_ARRAYS(hmap.GetInteriorGroup(0).nodes(), interior1.nodes());
+  TEST_COMPARE_ARRAYS(hmap.GetInteriorGroup(1).nodes(), interior2.nodes());
+  TEST_EQUALITY(hmap.NumSeparatorGroups(0), 1);
+  TEST_EQUALITY(hmap.NumSeparatorGroups(1), 1);
+  TEST_COMPARE_ARRAYS(hmap.GetSeparatorGroups(0)[0].nodes(), separator.nodes());
+  TEST_COMPARE_ARRAYS(hmap.GetSeparatorGroups(1)[0].nodes(), separator.nodes());
+
+  // Both subdomains refer to the same nodes
+  TEST_EQUALITY(&hmap.GetSeparatorGroups(0)[0][0], &hmap.GetSeparatorGroups(1)[0][0]);
+
+  // Modifying a copy of a group does not modify the map
+  HYMLS::SeparatorGroup group = hmap.GetSeparatorGroups(0)[0];
+  group.append(n);
+  TEST_EQUALITY(group.length(), separator.length() + 1);
+  TEST_EQUALITY(hmap.GetSeparatorGroups(0)[0].length(), separator.length());
+  TEST_EQUALITY(hmap.GetSeparatorGroups(1)[0].length(), separator.length());
+  }
+
+TEUCHOS_UNIT_TEST(HierarchicalMap, LIDs)
+  {
+  Teuchos::RCP<Epetra_MpiComm> Comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+
+  hymls_gidx n = 100;
+  Teuchos::RCP<Epetra_Map> map = Teuchos::rcp(new Epetra_Map(n, 0, *Comm));
+  int numMyElements = map->NumMyElements();
+
+  HYMLS::InteriorGroup interior1, interior2;
+  HYMLS::SeparatorGroup separator;
+  for (int lid = 0; lid < numMyElements; lid++)
+    {
+    if (lid < numMyElements / 2 - 1)
+      interior1.append(map->GID64(lid));
+    else if (lid < numMyElements / 2 + 1)
+      separator.append(map->GID64(lid));
+    else
+      interior2.append(map->GID64(lid));
+    }
+
+  TestableHierarchicalMap hmap(map);
+  hmap.Reset(2);
+  hmap.AddInteriorGroup(0, interior1);
+  hmap.AddInteriorGroup(1, interior2);
+  hmap.AddSeparatorGroup(0, separator);
+  hmap.AddSeparatorGroup(1, separator);
+  hmap.FillComplete();
+
+  for (int sd = 0; sd < 2; sd++)
+    {
+    HYMLS::InteriorGroup const &group = hmap.GetInteriorGroup(sd);
+    Teuchos::ArrayView<const int> lids = hmap.LIDs(group);
+    Teuchos::ArrayView<const int> overlappingLids = hmap.OverlappingLIDs(group);
+    TEST_EQUALITY(lids.size(), group.length());
+    TEST_EQUALITY(overlappingLids.size(), group.length());
+    for (int j = 0; j < group.length(); j++)
+      {
+      TEST_EQUALITY(lids[j], map->LID(group[j]));
+      TEST_EQUALITY(overlappingLids[j], hmap.OverlappingMap().LID(group[j]));
+      }
+
+    HYMLS::SeparatorGroup const &sep = hmap.GetSeparatorGroups(sd)[0];
+    Teuchos::RCP<const Epetra_Map> sdMap = hmap.SpawnMap(sd, HYMLS::HierarchicalMap::Separators);
+    int sdOffset = hmap.SubdomainOffset(sd, sep);
+    for (int j = 0; j < sep.length(); j++)
+      TEST_EQUALITY(sdOffset + j, sdMap->LID(sep[j]));
+    }
+
+  // Spawned objects share the groups but have their own maps
+  Teuchos::RCP<const HYMLS::HierarchicalMap> sepObject =
+    hmap.Spawn(HYMLS::HierarchicalMap::Separators);
+  HYMLS::SeparatorGroup const &sep = sepObject->GetSeparatorGroups(0)[0];
+  Teuchos::ArrayView<const int> lids = sepObject->LIDs(sep);
+  for (int j = 0; j < sep.length(); j++)
+    TEST_EQUALITY(lids[j], sepObject->Map().LID(sep[j]));
+  }
+
 // TEUCHOS_UNIT_TEST(HierarchicalMap, LID)
 //   {
 //   Teuchos::RCP<Epetra_MpiComm> Comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
@@ -0,0 +1,74 @@
+#include "HYMLS_HyperCube.hpp"
+
+#include "Epetra_MpiComm.h"
+
+#include "HYMLS_Macros.hpp"
+#include "HYMLS_UnitTests.hpp"
+
+#include <algorithm>
+
+TEUCHOS_UNIT_TEST(HyperCube, IsCongruent)
+  {
+  DISABLE_OUTPUT;
+  HYMLS::HyperCube cube;
+  ENABLE_OUTPUT;
+
+  Epetra_MpiComm world(MPI_COMM_WORLD);
+  Epetra_MpiComm self(MPI_COMM_SELF);
+
+  TEST_ASSERT(cube.IsCongruent(cube.Comm()));
+  TEST_ASSERT(cube.IsCongruent(world));
+  TEST_EQUALITY(cube.IsCongruent(self), world.NumProc() == 1);
+  }
+
+TEUCHOS_UNIT_TEST(HyperCube, NumProcOnNode)
+  {
+  DISABLE_OUTPUT;
+  HYMLS::HyperCube cube;
+  ENABLE_OUTPUT;
+
+  TEST_EQUALITY(HYMLS::HyperCube::Instance(), &cube);
+
+  int numProcOnNode = cube.NumProcOnNode();
+  TEST_COMPARE(numProcOnNode, >=, 1);
+  TEST_COMPARE(numProcOnNode, <=, cube.Comm().NumProc());
+
+  // Summing 1/numProcOnNode over all ranks gives the number of nodes,
+  // which is at least 1 and at most the number of ranks
+  double part = 1.0 / numProcOnNode, numNodes = 0.0;
+  CHECK_ZERO(cube.Comm().SumAll(&part, &numNodes, 1));
+  TEST_COMPARE(numNodes, >, 0.5);
+  TEST_COMPARE(numNodes, <, cube.Comm().NumProc() + 0.5);
+
+  TEST_EQUALITY(cube.NumActiveProcsOnNode(true), numProcOnNode);
+  TEST_EQUALITY(cube.NumActiveProcsOnNode(false), 0);
+  }
+
+TEUCHOS_UNIT_TEST(HyperCube, NumThreads)
+  {
+  DISABLE_OUTPUT;
+  HYMLS::HyperCube cube;
+  ENABLE_OUTPUT;
+
+  int numProcOnNode = cube.NumProcOnNode();
+
+  // All ranks are active, so every rank keeps its own cores
+  TEST_EQUALITY(cube.NumThreads(true), 1);
+  TEST_EQUALITY(cube.NumThreads(true, 2), 2);
+
+  // Only the even ranks are active, the odd ones hand over their cores
+  bool active = cube.Comm().MyPID() % 2 == 0;
+  int numActive = cube.NumActiveProcsOnNode(active);
+  TEST_COMPARE(numActive, <=, numProcOnNode);
+
+  int numThreads = cube.NumThreads(active, 2);
+  if (active)
+    {
+    TEST_COMPARE(numActive, >=, 1);
+    TEST_EQUALITY(numThreads, std::max(1, 2 * numProcOnNode / numActive));
+    }
+  else
+    {
+    TEST_EQUALITY(numThreads, 1);
+    }
+  }
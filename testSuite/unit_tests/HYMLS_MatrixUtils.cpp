@@ -0,0 +1,97 @@
+#include "HYMLS_MatrixUtils.hpp"
+
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_ParameterList.hpp"
+
+#include "Epetra_MpiComm.h"
+#include "Epetra_Map.h"
+#include "Epetra_CrsMatrix.h"
+#include "Epetra_MultiVector.h"
+#include "Epetra_Vector.h"
+#include "Epetra_Import.h"
+
+#include "Galeri_CrsMatrices.h"
+
+#include "HYMLS_UnitTests.hpp"
+
+#include <cstdio>
+
+namespace {
+
+// x[gid] = gid + 1 + 100 * k, so we can compare vectors with different maps
+void SetByGID(Epetra_MultiVector &x)
+  {
+  for (int k = 0; k < x.NumVectors(); k++)
+    for (int i = 0; i < x.MyLength(); i++)
+      x[k][i] = x.Map().GID64(i) + 1 + 100 * k;
+  }
+
+  }
+
+TEUCHOS_UNIT_TEST(MatrixUtils, BinaryMatrix)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  int nx = 8;
+  int n = nx * nx;
+  Teuchos::RCP<Epetra_Map> randomMap = HYMLS::UnitTests::create_random_map(comm, n, 1);
+  Epetra_Map linearMap(n, 0, comm);
+
+  Teuchos::ParameterList galeriList;
+  galeriList.set("nx", nx);
+  galeriList.set("ny", nx);
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(
+    Galeri::CreateCrsMatrix("Laplace2D", randomMap.get(), galeriList));
+
+  std::string filename = "binary_test_matrix.bin";
+  TEST_EQUALITY(HYMLS::MatrixUtils::binwrite(filename, *A), 0);
+
+  // read it back with a different distribution
+  Teuchos::RCP<Epetra_CrsMatrix> B = HYMLS::MatrixUtils::binread(filename, linearMap);
+  comm.Barrier();
+  if (comm.MyPID() == 0)
+    std::remove(filename.c_str());
+
+  TEST_EQUALITY(B->NumGlobalNonzeros64(), A->NumGlobalNonzeros64());
+  TEST_EQUALITY(B->NumGlobalRows64(), A->NumGlobalRows64());
+
+  Epetra_Vector xA(*randomMap), yA(*randomMap);
+  Epetra_Vector xB(linearMap), yB(linearMap);
+  SetByGID(xA);
+  SetByGID(xB);
+  TEST_EQUALITY(A->Multiply(false, xA, yA), 0);
+  TEST_EQUALITY(B->Multiply(false, xB, yB), 0);
+
+  Epetra_Import import(linearMap, *randomMap);
+  Epetra_Vector yAlinear(linearMap);
+  TEST_EQUALITY(yAlinear.Import(yA, import, Insert), 0);
+
+  TEST_EQUALITY(HYMLS::UnitTests::NormInfAminusB(yAlinear, yB), 0.0);
+  }
+
+TEUCHOS_UNIT_TEST(MatrixUtils, BinaryVector)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  int n = 37;
+  Teuchos::RCP<Epetra_Map> randomMap = HYMLS::UnitTests::create_random_map(comm, n, 1);
+  Epetra_Map linearMap(n, 0, comm);
+
+  Epetra_MultiVector x(*randomMap, 3);
+  SetByGID(x);
+
+  std::string filename = "binary_test_vector.bin";
+  TEST_EQUALITY(HYMLS::MatrixUtils::binwrite(filename, x), 0);
+
+  Epetra_MultiVector y(linearMap, 3);
+  TEST_EQUALITY(HYMLS::MatrixUtils::binread(filename, y), 0);
+  comm.Barrier();
+  if (comm.MyPID() == 0)
+    std::remove(filename.c_str());
+
+  Epetra_MultiVector y_ex(linearMap, 3);
+  SetByGID(y_ex);
+  TEST_EQUALITY(HYMLS::UnitTests::NormInfAminusB(y, y_ex), 0.0);
+  }
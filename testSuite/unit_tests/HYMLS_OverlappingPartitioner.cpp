@@ -10,7 +10,11 @@
 
 #include "Epetra_MpiComm.h"
 #include "Epetra_Map.h"
+#include "Epetra_Vector.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <numeric>
 
 #include "HYMLS_UnitTests.hpp"
@@ -1261,3 +1265,77 @@ TEUCHOS_UNIT_TEST_INST(OverlappingPartitioner, SkewStokes3D, 1, 8, 8, 8, 4, 4, 4
 TEUCHOS_UNIT_TEST_INST(OverlappingPartitioner, SkewStokes3D, 2, 16, 16, 16, 4, 4, 4);
 TEUCHOS_UNIT_TEST_INST(OverlappingPartitioner, SkewStokes3D, 3, 16, 8, 8, 4, 4, 4);
 TEUCHOS_UNIT_TEST_INST(OverlappingPartitioner, SkewStokes3D, 4, 16, 16, 16, 8, 8, 8);
+
+TEUCHOS_UNIT_TEST(OverlappingPartitioner, Cache)
+  {
+  Teuchos::RCP<Epetra_MpiComm> Comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+
+  DISABLE_OUTPUT;
+
+  std::string cacheFile = "OverlappingPartitioner_Cache";
+
+  Teuchos::RCP<Teuchos::ParameterList> paramList = Teuchos::rcp(new Teuchos::ParameterList);
+  Teuchos::ParameterList &problemList = paramList->sublist("Problem");
+  problemList.set("nx", 16);
+  problemList.set("ny", 16);
+  problemList.set("Dimension", 2);
+  problemList.set("Equations", "Stokes-C");
+
+  Teuchos::ParameterList &solverList = paramList->sublist("Preconditioner");
+  solverList.set("Separator Length", 4);
+  solverList.set("Partition Cache", cacheFile);
+
+  Teuchos::RCP<HYMLS::CartesianPartitioner> part = Teuchos::rcp(
+    new HYMLS::CartesianPartitioner(Teuchos::null, paramList, *Comm));
+  part->Partition(true);
+  Teuchos::RCP<const Epetra_Map> map = part->GetMap();
+
+  Teuchos::RCP<Teuchos::ParameterList> paramList2 = Teuchos::rcp(
+    new Teuchos::ParameterList(*paramList));
+
+  Teuchos::RCP<Teuchos::ParameterList> paramList3 = Teuchos::rcp(
+    new Teuchos::ParameterList(*paramList));
+
+  std::string fileName = cacheFile + ".0." + Teuchos::toString(Comm->MyPID()) + ".partition.bin";
+  std::remove(fileName.c_str());
+  Comm->Barrier();
+
+  // The first one writes the cache, the second one reads it
+  HYMLS::OverlappingPartitioner opart(map, paramList, 0);
+  HYMLS::OverlappingPartitioner opart2(map, paramList2, 0);
+
+  // Different weights give a different key, so the cache is not used
+  Teuchos::RCP<Epetra_Vector> weights = Teuchos::rcp(new Epetra_Vector(*map));
+  weights->PutScalar(1.0);
+  HYMLS::OverlappingPartitioner opart3(map, paramList3, 0,
+    Teuchos::null, Teuchos::null, weights);
+
+  ENABLE_OUTPUT;
+
+  TEST_ASSERT(std::ifstream(fileName.c_str()).good());
+
+  TEST_ASSERT(!opart.ReadFromCache());
+  TEST_ASSERT(opart2.ReadFromCache());
+  TEST_ASSERT(!opart3.ReadFromCache());
+
+  TEST_ASSERT(opart.Map().SameAs(opart2.Map()));
+  TEST_ASSERT(opart.OverlappingMap().SameAs(opart2.OverlappingMap()));
+  TEST_EQUALITY(opart.NumMySubdomains(), opart2.NumMySubdomains());
+  for (int sd = 0; sd < std::min(opart.NumMySubdomains(), opart2.NumMySubdomains()); sd++)
+    {
+    TEST_COMPARE_ARRAYS(opart.GetInteriorGroup(sd).nodes(),
+      opart2.GetInteriorGroup(sd).nodes());
+    TEST_EQUALITY(opart.NumSeparatorGroups(sd), opart2.NumSeparatorGroups(sd));
+    TEST_EQUALITY(opart.NumLinkedSeparatorGroups(sd), opart2.NumLinkedSeparatorGroups(sd));
+    for (int i = 0; i < std::min(opart.NumSeparatorGroups(sd), opart2.NumSeparatorGroups(sd)); i++)
+      {
+      HYMLS::SeparatorGroup const &group = opart.GetSeparatorGroups(sd)[i];
+      HYMLS::SeparatorGroup const &group2 = opart2.GetSeparatorGroups(sd)[i];
+      TEST_EQUALITY(group.type(), group2.type());
+      TEST_COMPARE_ARRAYS(group.nodes(), group2.nodes());
+      }
+    }
+
+  Comm->Barrier();
+  std::remove(fileName.c_str());
+  }
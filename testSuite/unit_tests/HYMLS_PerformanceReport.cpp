@@ -0,0 +1,120 @@
+#include "HYMLS_PerformanceReport.hpp"
+
+#include "Epetra_MpiComm.h"
+
+#include "HYMLS_UnitTests.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+TEUCHOS_UNIT_TEST(PerformanceReport, Write)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+
+  HYMLS::PerformanceReport report(comm);
+  report.Add(1, "Compute", "time", comm->MyPID());
+  report.Add(1, "Compute", "time", 1.0);
+  report.Add(0, "Solve", "iterations", 10);
+  report.Add(1, "ApplyInverse", "flops", 2.0);
+
+  std::ostringstream ss;
+  TEST_EQUALITY(report.Write(ss), 0);
+
+  if (comm->MyPID() != 0)
+    {
+    TEST_EQUALITY(ss.str(), "");
+    return;
+    }
+
+  std::string s = ss.str();
+  int numProc = comm->NumProc();
+
+  std::ostringstream time;
+  time << "\"time\": {\"min\": 1, \"max\": " << numProc
+       << ", \"mean\": " << (numProc + 1) / 2.0 << "}";
+  TEST_INEQUALITY(s.find(time.str()), std::string::npos);
+
+  TEST_INEQUALITY(s.find("\"iterations\": {\"min\": 10, \"max\": 10, \"mean\": 10}"),
+    std::string::npos);
+
+  // Levels are sorted, and so are the phases in a level
+  TEST_COMPARE(s.find("\"level\": 0"), <, s.find("\"level\": 1"));
+  TEST_COMPARE(s.find("\"ApplyInverse\""), <, s.find("\"Compute\""));
+  TEST_EQUALITY(std::count(s.begin(), s.end(), '{'), std::count(s.begin(), s.end(), '}'));
+  }
+
+TEUCHOS_UNIT_TEST(PerformanceReport, Merge)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+
+  HYMLS::PerformanceReport report(comm);
+  report.Add(1, "Compute", "time", 1.0);
+
+  // Only the even processes have the report of level 2
+  Teuchos::RCP<HYMLS::PerformanceReport> other;
+  if (comm->MyPID() % 2 == 0)
+    {
+    other = Teuchos::rcp(new HYMLS::PerformanceReport(comm));
+    other->Add(2, "Compute", "time", 2.0);
+    other->Add(2, "ApplyInverse", "flops", 3.0);
+    }
+  report.Merge(other.get(), 0);
+
+  std::ostringstream ss;
+  TEST_EQUALITY(report.Write(ss), 0);
+
+  if (comm->MyPID() != 0)
+    return;
+
+  std::string s = ss.str();
+  int numProc = comm->NumProc();
+  int numEven = (numProc + 1) / 2;
+  double min = numProc > 1 ? 0.0 : 2.0;
+
+  TEST_INEQUALITY(s.find("\"level\": 2"), std::string::npos);
+
+  std::ostringstream time;
+  time << std::setprecision(10);
+  time << "\"time\": {\"min\": " << min << ", \"max\": 2"
+       << ", \"mean\": " << 2.0 * numEven / numProc << "}";
+  TEST_INEQUALITY(s.find(time.str()), std::string::npos);
+  }
+
+TEUCHOS_UNIT_TEST(PerformanceReport, WriteDifferentKeys)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+
+  // Every process has the same number of metrics, but the odd
+  // processes have a different one, so the values have to be
+  // matched by key and not by position
+  HYMLS::PerformanceReport report(comm);
+  report.Add(0, "Solve", "iterations", 10);
+  if (comm->MyPID() % 2 == 0)
+    report.Add(1, "Compute", "calls", 1.0);
+  else
+    report.Add(1, "Compute", "flops", 5.0);
+
+  std::ostringstream ss;
+  DISABLE_OUTPUT;
+  TEST_EQUALITY(report.Write(ss), 0);
+  ENABLE_OUTPUT;
+
+  if (comm->MyPID() != 0)
+    return;
+
+  std::string s = ss.str();
+  int numProc = comm->NumProc();
+  int numEven = (numProc + 1) / 2;
+  double min = numProc > 1 ? 0.0 : 1.0;
+
+  std::ostringstream calls;
+  calls << std::setprecision(10);
+  calls << "\"calls\": {\"min\": " << min << ", \"max\": 1"
+        << ", \"mean\": " << (double)numEven / numProc << "}";
+  TEST_INEQUALITY(s.find(calls.str()), std::string::npos);
+
+  TEST_INEQUALITY(s.find("\"iterations\": {\"min\": 10, \"max\": 10, \"mean\": 10}"),
+    std::string::npos);
+  TEST_EQUALITY(s.find("\"flops\""), std::string::npos);
+  }
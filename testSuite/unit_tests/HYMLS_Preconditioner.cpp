@@ -7,15 +7,23 @@
 #include <Epetra_MpiComm.h>
 #include <Epetra_Map.h>
 #include <Epetra_MultiVector.h>
+#include <Epetra_Vector.h>
 #include <Epetra_CrsMatrix.h>
+#include <Epetra_FECrsMatrix.h>
 #include <Epetra_Util.h>
 #include <Epetra_Import.h>
 #include <Epetra_SerialDenseMatrix.h>
 
 #include "HYMLS_Macros.hpp"
+#include "HYMLS_BaseSolver.hpp"
 #include "HYMLS_DenseUtils.hpp"
 #include "HYMLS_MatrixBlock.hpp"
+#include "HYMLS_InteriorGroup.hpp"
 #include "HYMLS_SchurComplement.hpp"
+#include "HYMLS_SchurPreconditioner.hpp"
+#include "HYMLS_AgglomeratedSolver.hpp"
+#include "HYMLS_PerformanceReport.hpp"
+#include "HYMLS_HyperCube.hpp"
 #include "HYMLS_CartesianPartitioner.hpp"
 #include "HYMLS_SkewCartesianPartitioner.hpp"
 
@@ -25,6 +33,12 @@
 #include "HYMLS_FakeComm.hpp"
 #include "HYMLS_UnitTests.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
 class TestableSchurComplement: public HYMLS::SchurComplement
   {
 public:
@@ -61,6 +75,23 @@ public:
     {
     return V_;
     }
+
+  Teuchos::RCP<const HYMLS::SchurPreconditioner> SchurPrec()
+    {
+    return Teuchos::rcp_dynamic_cast<const HYMLS::SchurPreconditioner>(schurPrec_);
+    }
+
+  HYMLS::MatrixBlock const &A11()
+    {
+    return *A11_;
+    }
+
+  HYMLS::MatrixBlock const &A22Block()
+    {
+    return *A22_;
+    }
+
+  using HYMLS::Preconditioner::Partitioner;
   };
 
 Teuchos::RCP<TestablePreconditioner> createPreconditioner(
@@ -191,11 +222,12 @@ TEUCHOS_UNIT_TEST(Preconditioner, SetBorderNull)
 
 Teuchos::RCP<TestablePreconditioner> create2DStokesPreconditioner(
   Teuchos::RCP<Teuchos::ParameterList> &params,
-  Teuchos::RCP<Epetra_Comm> const &comm)
+  Teuchos::RCP<Epetra_Comm> const &comm,
+  int n = 8, int numLevels = 2)
   {
   Teuchos::ParameterList &problemList = params->sublist("Problem");
-  problemList.set("nx", 8);
-  problemList.set("ny", 8);
+  problemList.set("nx", n);
+  problemList.set("ny", n);
   problemList.set("nz", 1);
   problemList.set("Degrees of Freedom", 3);
   problemList.set("Dimension", 2);
@@ -204,7 +236,7 @@ Teuchos::RCP<TestablePreconditioner> create2DStokesPreconditioner(
   solverList.set("Separator Length", 4);
   solverList.set("Coarsening Factor", 2);
   solverList.set("Partitioner", "Skew Cartesian");
-  solverList.set("Number of Levels", 2);
+  solverList.set("Number of Levels", numLevels);
 
   for (int i = 0; i < 2; i++)
     {
@@ -244,6 +276,416 @@ TEUCHOS_UNIT_TEST(Preconditioner, 2DStokes)
   prec->Compute();
   }
 
+TEUCHOS_UNIT_TEST(Preconditioner, SchurComplementCache)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  std::string cacheFile = "Preconditioner_SchurComplementCache";
+
+  // The first one writes the cache, the second one reads it
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->sublist("Preconditioner").set("Schur Complement Cache", cacheFile);
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  Teuchos::RCP<Teuchos::ParameterList> params2 = Teuchos::rcp(new Teuchos::ParameterList());
+  params2->sublist("Preconditioner").set("Schur Complement Cache", cacheFile);
+  Teuchos::RCP<TestablePreconditioner> prec2 = create2DStokesPreconditioner(params2, comm);
+  TEST_EQUALITY(prec2->Initialize(), 0);
+  TEST_EQUALITY(prec2->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  // Only the second one should have taken the read path
+  TEST_ASSERT(!prec->SchurPrec()->ReadFromCache());
+  TEST_ASSERT(prec2->SchurPrec()->ReadFromCache());
+
+  std::string fileName = cacheFile + ".0." + Teuchos::toString(comm->MyPID()) + ".schur.bin";
+  std::string fileName1 = cacheFile + ".1." + Teuchos::toString(comm->MyPID()) + ".schur.bin";
+  TEST_ASSERT(std::ifstream(fileName.c_str()).good());
+  TEST_ASSERT(std::ifstream(fileName1.c_str()).good());
+
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Epetra_MultiVector B(map, 2);
+  B.Random();
+
+  Epetra_MultiVector X(map, 2);
+  Epetra_MultiVector X2(map, 2);
+  TEST_EQUALITY(prec->ApplyInverse(B, X), 0);
+  TEST_EQUALITY(prec2->ApplyInverse(B, X2), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(X, X2), <, 1e-12);
+
+  comm->Barrier();
+  std::remove(fileName.c_str());
+  std::remove(fileName1.c_str());
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, RefreshValues)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  // Change the values but not the structure of the matrix
+  Epetra_CrsMatrix &A = const_cast<Epetra_CrsMatrix &>(
+    dynamic_cast<Epetra_CrsMatrix const &>(prec->Matrix()));
+  Epetra_Vector scaling(A.RowMap());
+  scaling.Random();
+  CHECK_ZERO(scaling.Abs(scaling));
+  CHECK_ZERO(scaling.Shift(1.0));
+  CHECK_ZERO(A.LeftScale(scaling));
+  CHECK_ZERO(A.RightScale(scaling));
+
+  // This should only copy the new values
+  TEST_EQUALITY(prec->A22Block().NumRefreshValues(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+  TEST_EQUALITY(prec->A22Block().NumRefreshValues(), 1);
+
+  // Compare to a preconditioner that is computed from scratch
+  Teuchos::RCP<Teuchos::ParameterList> params2 = Teuchos::rcp(new Teuchos::ParameterList(*params));
+  Teuchos::RCP<TestablePreconditioner> prec2 = Teuchos::rcp(new TestablePreconditioner(
+      Teuchos::rcp(new Epetra_CrsMatrix(A)), params2));
+  TEST_EQUALITY(prec2->Initialize(), 0);
+  TEST_EQUALITY(prec2->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Epetra_MultiVector B(map, 2);
+  B.Random();
+
+  Epetra_MultiVector X(map, 2);
+  Epetra_MultiVector X2(map, 2);
+  TEST_EQUALITY(prec->ApplyInverse(B, X), 0);
+  TEST_EQUALITY(prec2->ApplyInverse(B, X2), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(X, X2), <, 1e-10);
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, AutoSubdomainSolvers)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  // The subdomains at the boundary are smaller than the ones in the
+  // interior, so use a crossover at the size of the smallest one
+  HYMLS::OverlappingPartitioner const &hid = prec->Partitioner();
+  int sizes[2] = {std::numeric_limits<int>::max(), 0};
+  for (int sd = 0; sd < hid.NumMySubdomains(); sd++)
+    {
+    sizes[0] = std::min(sizes[0], hid.GetInteriorGroup(sd).length());
+    sizes[1] = std::max(sizes[1], hid.GetInteriorGroup(sd).length());
+    }
+  int minSize, maxSize;
+  CHECK_ZERO(comm->MinAll(&sizes[0], &minSize, 1));
+  CHECK_ZERO(comm->MaxAll(&sizes[1], &maxSize, 1));
+
+  // Use dense solvers only for the small subdomains. The fill
+  // threshold can not be reached, so the large ones are sparse.
+  Teuchos::RCP<Teuchos::ParameterList> params2 = Teuchos::rcp(new Teuchos::ParameterList());
+  params2->sublist("Preconditioner").set("Subdomain Solver Type", "Auto");
+  params2->sublist("Preconditioner").set("Dense Solver Crossover", minSize);
+  params2->sublist("Preconditioner").set("Dense Solver Fill", 2.0);
+  Teuchos::RCP<TestablePreconditioner> prec2 = create2DStokesPreconditioner(params2, comm);
+  TEST_EQUALITY(prec2->Initialize(), 0);
+  TEST_EQUALITY(prec2->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  TEST_COMPARE(minSize, <, maxSize);
+
+  int counts[2], globalCounts[2];
+  prec2->A11().SubdomainSolverCounts(counts[0], counts[1]);
+  CHECK_ZERO(comm->SumAll(counts, globalCounts, 2));
+  TEST_INEQUALITY(globalCounts[0], 0);
+  TEST_INEQUALITY(globalCounts[1], 0);
+
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Epetra_MultiVector B(map, 2);
+  B.Random();
+
+  Epetra_MultiVector X(map, 2);
+  Epetra_MultiVector X2(map, 2);
+  TEST_EQUALITY(prec->ApplyInverse(B, X), 0);
+  TEST_EQUALITY(prec2->ApplyInverse(B, X2), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(X, X2), <, 1e-10);
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, AutoSubdomainSolversBorder)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm);
+  TEST_EQUALITY(prec->Initialize(), 0);
+
+  // Without a border all subdomain solvers are dense
+  Teuchos::RCP<Teuchos::ParameterList> params2 = Teuchos::rcp(new Teuchos::ParameterList());
+  params2->sublist("Preconditioner").set("Subdomain Solver Type", "Auto");
+  params2->sublist("Preconditioner").set("Dense Solver Crossover", 1000000);
+  Teuchos::RCP<TestablePreconditioner> prec2 = create2DStokesPreconditioner(params2, comm);
+  TEST_EQUALITY(prec2->Initialize(), 0);
+  TEST_EQUALITY(prec2->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  int counts[2], globalCounts[2];
+  prec2->A11().SubdomainSolverCounts(counts[0], counts[1]);
+  CHECK_ZERO(comm->SumAll(counts, globalCounts, 2));
+  TEST_INEQUALITY(globalCounts[0], 0);
+  TEST_EQUALITY(globalCounts[1], 0);
+
+  // The border needs the transpose of A11, which the dense
+  // solvers can not apply, so they are replaced by sparse ones
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Teuchos::RCP<Epetra_MultiVector> V = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  V->Random();
+  Teuchos::RCP<Epetra_MultiVector> W = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  W->Random();
+  Teuchos::RCP<Epetra_SerialDenseMatrix> C = Teuchos::rcp(new Epetra_SerialDenseMatrix(2, 2));
+
+  DISABLE_OUTPUT;
+  TEST_EQUALITY(prec->SetBorder(V, W, C), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+  TEST_EQUALITY(prec2->SetBorder(V, W, C), 0);
+  TEST_EQUALITY(prec2->Compute(), 0);
+  ENABLE_OUTPUT;
+
+  prec2->A11().SubdomainSolverCounts(counts[0], counts[1]);
+  CHECK_ZERO(comm->SumAll(counts, globalCounts, 2));
+  TEST_EQUALITY(globalCounts[0], 0);
+  TEST_INEQUALITY(globalCounts[1], 0);
+
+  Epetra_MultiVector B(map, 2);
+  B.Random();
+  Teuchos::RCP<Epetra_SerialDenseMatrix> B2 = HYMLS::UnitTests::RandomSerialDenseMatrix(2, 2, *comm);
+
+  Epetra_MultiVector X(map, 2);
+  Epetra_MultiVector Y(map, 2);
+  Epetra_SerialDenseMatrix X2(2, 2);
+  Epetra_SerialDenseMatrix Y2(2, 2);
+  TEST_EQUALITY(prec->ApplyInverse(B, *B2, X, X2), 0);
+  TEST_EQUALITY(prec2->ApplyInverse(B, *B2, Y, Y2), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(X, Y), <, 1e-10);
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(X2, Y2), <, 1e-10);
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, Agglomeration)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm, 32, 3);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  // Solve the second level on one processor
+  Teuchos::RCP<Teuchos::ParameterList> params2 = Teuchos::rcp(new Teuchos::ParameterList());
+  params2->sublist("Preconditioner").set("Agglomeration Threshold", 1000000);
+  Teuchos::RCP<TestablePreconditioner> prec2 = create2DStokesPreconditioner(params2, comm, 32, 3);
+  TEST_EQUALITY(prec2->Initialize(), 0);
+  TEST_EQUALITY(prec2->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  Teuchos::RCP<const HYMLS::AgglomeratedSolver> nextLevel =
+    Teuchos::rcp_dynamic_cast<const HYMLS::AgglomeratedSolver>(prec2->SchurPrec()->NextLevel());
+  if (comm->NumProc() > 1)
+    {
+    TEST_ASSERT(nextLevel != Teuchos::null);
+    TEST_EQUALITY(nextLevel->NumActiveProcs(), 1);
+    TEST_EQUALITY(nextLevel->IsActive(), comm->MyPID() == 0);
+    if (nextLevel->IsActive())
+      {
+      TEST_EQUALITY(nextLevel->NextLevel()->Comm().NumProc(), 1);
+      }
+    else
+      {
+      TEST_EQUALITY(nextLevel->NextLevel(), Teuchos::null);
+      }
+    }
+  else
+    {
+    TEST_EQUALITY(nextLevel, Teuchos::null);
+    }
+
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Epetra_MultiVector B(map, 2);
+  B.Random();
+
+  Epetra_MultiVector X(map, 2);
+  Epetra_MultiVector X2(map, 2);
+  TEST_EQUALITY(prec->ApplyInverse(B, X), 0);
+  TEST_EQUALITY(prec2->ApplyInverse(B, X2), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(X, X2), <, 1e-8);
+
+  // All processors report the agglomerated level
+  HYMLS::PerformanceReport report(comm);
+  prec2->AddToReport(report);
+  std::ostringstream ss;
+  TEST_EQUALITY(report.Write(ss), 0);
+  if (comm->MyPID() == 0)
+    {
+    TEST_INEQUALITY(ss.str().find("\"level\": 2"), std::string::npos);
+    }
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, AgglomerationThreads)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  HYMLS::HyperCube cube;
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->sublist("Preconditioner").set("Agglomeration Threshold", 1000000);
+  params->sublist("Preconditioner").set("Topology-Aware Threads", true);
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm, 32, 3);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  // The thread budget is computed on the full communicator, since the
+  // HyperCube cannot be queried on the sub-communicator
+  Teuchos::RCP<const HYMLS::AgglomeratedSolver> nextLevel =
+    Teuchos::rcp_dynamic_cast<const HYMLS::AgglomeratedSolver>(prec->SchurPrec()->NextLevel());
+  if (comm->NumProc() > 1)
+    {
+    TEST_ASSERT(nextLevel != Teuchos::null);
+    if (nextLevel != Teuchos::null)
+      {
+      TEST_EQUALITY(nextLevel->ThreadBudget(), cube.NumThreads(nextLevel->IsActive()));
+      }
+    }
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, SchurComplementApply)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  // Compare the matrix-free Apply() to the assembled Schur complement
+  HYMLS::SchurComplement const &schur = prec->SchurComplement();
+  Epetra_Map const &map = schur.OperatorDomainMap();
+  Teuchos::RCP<Epetra_FECrsMatrix> S = Teuchos::rcp(
+    new Epetra_FECrsMatrix(Copy, map, prec->Matrix().MaxNumEntries()));
+  TEST_EQUALITY(schur.Construct(S), 0);
+
+  Epetra_MultiVector X(map, 2);
+  X.Random();
+
+  Epetra_MultiVector Y(map, 2);
+  Epetra_MultiVector Y_EX(map, 2);
+  TEST_EQUALITY(schur.Apply(X, Y), 0);
+  TEST_EQUALITY(S->Apply(X, Y_EX), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(Y, Y_EX), <, 1e-10);
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, SchurComplementIterations)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->sublist("Preconditioner").set("Schur Complement Iterations", 50);
+  params->sublist("Preconditioner").set("Schur Complement Tolerance", 1e-12);
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  // With an (almost) exact solve of the Schur complement system
+  // the preconditioner is a direct solver
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Epetra_MultiVector X_EX(map, 1);
+  X_EX.Random();
+
+  Epetra_MultiVector B(map, 1);
+  TEST_EQUALITY(prec->Matrix().Multiply(false, X_EX, B), 0);
+
+  Epetra_MultiVector X(map, 1);
+  TEST_EQUALITY(prec->ApplyInverse(B, X), 0);
+
+  Epetra_MultiVector R(map, 1);
+  TEST_EQUALITY(prec->Matrix().Multiply(false, X, R), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(R, B), <, 1e-8);
+
+  // The preconditioner is variable, so the solver should use flexible GMRES
+  TEST_ASSERT(prec->IsVariable());
+  DISABLE_OUTPUT;
+  HYMLS::BaseSolver solver(Teuchos::rcp(&prec->Matrix(), false), prec, params);
+  ENABLE_OUTPUT;
+  TEST_ASSERT(params->sublist("Solver").sublist("Iterative Solver").get("Flexible Gmres", false));
+  }
+
+TEUCHOS_UNIT_TEST(Preconditioner, SchurComplementIterations3Levels)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->sublist("Preconditioner").set("Schur Complement Iterations", 50);
+  params->sublist("Preconditioner").set("Schur Complement Tolerance", 1e-12);
+  Teuchos::RCP<TestablePreconditioner> prec = create2DStokesPreconditioner(params, comm, 32, 3);
+  TEST_EQUALITY(prec->Initialize(), 0);
+  TEST_EQUALITY(prec->Compute(), 0);
+
+  ENABLE_OUTPUT;
+
+  // Only the first level does inner iterations, so the inner GMRES
+  // is preconditioned by a fixed operator
+  TEST_ASSERT(prec->IsVariable());
+  Teuchos::RCP<const HYMLS::Preconditioner> nextLevel =
+    Teuchos::rcp_dynamic_cast<const HYMLS::Preconditioner>(prec->SchurPrec()->NextLevel());
+  TEST_ASSERT(nextLevel != Teuchos::null);
+  if (nextLevel != Teuchos::null)
+    {
+    TEST_ASSERT(!nextLevel->IsVariable());
+    }
+
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Epetra_MultiVector X_EX(map, 1);
+  X_EX.Random();
+
+  Epetra_MultiVector B(map, 1);
+  TEST_EQUALITY(prec->Matrix().Multiply(false, X_EX, B), 0);
+
+  Epetra_MultiVector X(map, 1);
+  TEST_EQUALITY(prec->ApplyInverse(B, X), 0);
+
+  Epetra_MultiVector R(map, 1);
+  TEST_EQUALITY(prec->Matrix().Multiply(false, X, R), 0);
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(R, B), <, 1e-8);
+  }
+
 TEUCHOS_UNIT_TEST(Preconditioner, ApplyInverse)
   {
   Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
@@ -376,3 +818,57 @@ TEUCHOS_UNIT_TEST(Preconditioner, BorderedApplyInverse)
   TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X, *X_EX), <, 1e-10);
   TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X2, *X_EX2), <, 1e-10);
   }
+
+TEUCHOS_UNIT_TEST(Preconditioner, LowRankBorderUpdate)
+  {
+  Teuchos::RCP<Epetra_MpiComm> comm = Teuchos::rcp(new Epetra_MpiComm(MPI_COMM_WORLD));
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->sublist("Preconditioner").set("Low-Rank Border Update", true);
+  Teuchos::RCP<TestablePreconditioner> prec = createPreconditioner(params, comm);
+  int ierr = prec->Initialize();
+  TEST_EQUALITY(ierr, 0);
+
+  ierr = prec->Compute();
+  TEST_EQUALITY(ierr, 0);
+
+  Epetra_Map const &map = prec->OperatorRangeMap();
+  Teuchos::RCP<Epetra_MultiVector> V = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  V->Random();
+  Teuchos::RCP<Epetra_MultiVector> W = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  W->Random();
+  Teuchos::RCP<Epetra_SerialDenseMatrix> C = HYMLS::UnitTests::RandomSerialDenseMatrix(2, 2, *comm);
+
+  // Setting the border should not require a new Compute()
+  ierr = prec->SetBorder(V, W, C);
+  TEST_EQUALITY(ierr, 0);
+  TEST_ASSERT(prec->IsComputed());
+
+  Teuchos::RCP<Epetra_MultiVector> X = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  X->Random();
+
+  Teuchos::RCP<Epetra_MultiVector> X_EX = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  X_EX->Random();
+
+  Teuchos::RCP<Epetra_SerialDenseMatrix> X2 = HYMLS::UnitTests::RandomSerialDenseMatrix(2, 2, *comm);
+
+  Teuchos::RCP<Epetra_SerialDenseMatrix> X_EX2 = HYMLS::UnitTests::RandomSerialDenseMatrix(2, 2, *comm);
+
+  Teuchos::RCP<Epetra_MultiVector> B = Teuchos::rcp(new Epetra_MultiVector(map, 2));
+  prec->Matrix().Multiply('N', *X_EX, *B);
+  ierr = B->Multiply('N', 'N', 1.0, *V, *HYMLS::DenseUtils::CreateView(*X_EX2), 1.0);
+  TEST_EQUALITY(ierr, 0);
+
+  Teuchos::RCP<Epetra_SerialDenseMatrix> B2 = Teuchos::rcp(new Epetra_SerialDenseMatrix(2, 2));
+  HYMLS::DenseUtils::MatMul(*W, *X_EX, *B2);
+  ierr = B2->Multiply('N', 'N', 1.0, *C, *X_EX2, 1.0);
+  TEST_EQUALITY(ierr, 0);
+
+  ierr = prec->ApplyInverse(*B, *B2, *X, *X2);
+  TEST_EQUALITY(ierr, 0);
+
+  // Check if they are the same
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X, *X_EX), <, 1e-10);
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*X2, *X_EX2), <, 1e-10);
+  }
@@ -17,9 +17,14 @@
 #include <Epetra_Map.h>
 #include <Epetra_MultiVector.h>
 #include <Epetra_CrsMatrix.h>
+#include <Epetra_InvOperator.h>
+
+#include "AnasaziTypes.hpp"
 
 #include "HYMLS_UnitTests.hpp"
 
+#include <cmath>
+
 class TestableSolver: public HYMLS::Solver
   {
 public:
@@ -36,6 +41,109 @@ public:
     }
   };
 
+class TestableDeflatedSolver: public HYMLS::DeflatedSolver
+  {
+public:
+  TestableDeflatedSolver(Teuchos::RCP<const Epetra_Operator> K,
+    Teuchos::RCP<Epetra_Operator> P,
+    Teuchos::RCP<Teuchos::ParameterList> params)
+  :
+  HYMLS::BaseSolver(K, P, params, false),
+  HYMLS::DeflatedSolver(K, P, params, false)
+    {
+    setParameterList(params, false);
+    }
+
+  Teuchos::RCP<Epetra_MultiVector> const &DeflationVectors()
+    {
+    return deflationVectors_;
+    }
+
+  Teuchos::RCP<Epetra_MultiVector> const &DeflationRhs()
+    {
+    return deflationRhs_;
+    }
+
+  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > const &PrecEigs()
+    {
+    return precEigs_;
+    }
+
+  std::string const &StartVector()
+    {
+    return startVec_;
+    }
+  };
+
+// Diagonal matrix with two small entries, rotated by theta in the (0, 2)
+// plane, so the dominant eigenvectors of its inverse change with theta.
+// If inverse is true, the inverse of this matrix is returned.
+Teuchos::RCP<Epetra_CrsMatrix> RotatedDiagonalMatrix(Epetra_Map const &map,
+  double theta, bool inverse)
+  {
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(new Epetra_CrsMatrix(Copy, map, 2));
+
+  double c = std::cos(theta);
+  double s = std::sin(theta);
+  double a = inverse ? 1.0e4 : 1.0e-4;
+  double b = inverse ? 1.0 / 3.0 : 3.0;
+  int idx[2] = {0, 2};
+  double val[2];
+  for (int i = 0; i < map.NumMyElements(); i++)
+    {
+    int gid = map.GID(i);
+    if (gid == 0)
+      {
+      val[0] = c * c * a + s * s * b;
+      val[1] = c * s * (a - b);
+      A->InsertGlobalValues(gid, 2, val, idx);
+      }
+    else if (gid == 2)
+      {
+      val[0] = c * s * (a - b);
+      val[1] = s * s * a + c * c * b;
+      A->InsertGlobalValues(gid, 2, val, idx);
+      }
+    else
+      {
+      double d = (gid == 1) ? 1.0e-3 : gid + 1.0;
+      val[0] = inverse ? 1.0 / d : d;
+      A->InsertGlobalValues(gid, 1, val, &gid);
+      }
+    }
+  A->FillComplete();
+  return A;
+  }
+
+// Solve with a random exact solution and return the inf-norm of the residual
+double DeflatedSolveResidual(HYMLS::BaseSolver &solver,
+  Epetra_CrsMatrix const &A, int &ierr)
+  {
+  Epetra_MultiVector X_EX(A.RowMap(), 1);
+  X_EX.Random();
+  Epetra_MultiVector B(A.RowMap(), 1);
+  A.Multiply(false, X_EX, B);
+
+  Epetra_MultiVector X(A.RowMap(), 1);
+  ierr = solver.ApplyInverse(B, X);
+
+  Epetra_MultiVector AX(A.RowMap(), 1);
+  A.Multiply(false, X, AX);
+  return HYMLS::UnitTests::NormInfAminusB(AX, B);
+  }
+
+Teuchos::RCP<Teuchos::ParameterList> DeflationParameterList(int refinementSteps)
+  {
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  Teuchos::ParameterList &solverList = params->sublist("Solver");
+  solverList.set("Initial Vector", "Zero");
+  solverList.set("Deflated Subspace Dimension", 2);
+  solverList.set("Deflation Update Tolerance", 1.0e-6);
+  solverList.set("Deflation Refinement Steps", refinementSteps);
+  solverList.sublist("Iterative Solver").set("Convergence Tolerance", 1.0e-10);
+  return params;
+  }
+
 // Test that we can use the parameterlist to select various solvers
 TEUCHOS_UNIT_TEST(Solver, BaseSolver)
   {
@@ -215,6 +323,151 @@ TEUCHOS_UNIT_TEST(Solver, BorderedDeflatedSolver)
 #endif
   }
 
+// If the preconditioner did not change, the old deflation vectors are kept
+// and the old solution with them is used as starting vector
+TEUCHOS_UNIT_TEST(Solver, DeflationUpdateTolerance)
+  {
+  Epetra_MpiComm Comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = DeflationParameterList(0);
+
+  Epetra_Map map(200, 0, Comm);
+  Teuchos::RCP<Epetra_CrsMatrix> A = RotatedDiagonalMatrix(map, 0.0, false);
+  Teuchos::RCP<Epetra_CrsMatrix> Ainv = RotatedDiagonalMatrix(map, 0.0, true);
+  Teuchos::RCP<Epetra_Operator> P = Teuchos::rcp(new Epetra_InvOperator(Ainv.get()));
+
+  TestableDeflatedSolver solver(A, P, params);
+
+  int ierr = solver.SetupDeflation();
+  TEST_EQUALITY(ierr, 0);
+  TEST_INEQUALITY(solver.PrecEigs(), Teuchos::null);
+  TEST_EQUALITY(solver.DeflationVectors()->NumVectors(), 2);
+
+  Teuchos::RCP<Epetra_MultiVector> V = solver.DeflationVectors();
+  Teuchos::RCP<Epetra_MultiVector> rhs = solver.DeflationRhs();
+  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > eigs = solver.PrecEigs();
+  Epetra_MultiVector oldRhs(*rhs);
+
+  double res = DeflatedSolveResidual(solver, *A, ierr);
+  TEST_EQUALITY(ierr, 0);
+  TEST_COMPARE(res, <, 1e-6);
+
+  ierr = solver.SetupDeflation();
+  TEST_EQUALITY(ierr, 0);
+
+  // The eigensolver was not called and the basis was not touched
+  TEST_EQUALITY(solver.PrecEigs().get(), eigs.get());
+  TEST_EQUALITY(solver.DeflationVectors().get(), V.get());
+
+  // The solve started from the previous solution, which was still correct,
+  // and the start vector was restored afterwards
+  TEST_EQUALITY(solver.DeflationRhs().get(), rhs.get());
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(*solver.DeflationRhs(), oldRhs), <, 1e-6);
+  TEST_EQUALITY(solver.StartVector(), "Zero");
+
+  res = DeflatedSolveResidual(solver, *A, ierr);
+  TEST_EQUALITY(ierr, 0);
+  TEST_COMPARE(res, <, 1e-6);
+  }
+
+// If the preconditioner changed slightly, the old deflation vectors are
+// refined by subspace iteration instead of calling the eigensolver
+TEUCHOS_UNIT_TEST(Solver, DeflationRefinementSteps)
+  {
+  Epetra_MpiComm Comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = DeflationParameterList(1);
+
+  Epetra_Map map(200, 0, Comm);
+  Teuchos::RCP<Epetra_CrsMatrix> A = RotatedDiagonalMatrix(map, 0.0, false);
+  Teuchos::RCP<Epetra_CrsMatrix> Ainv = RotatedDiagonalMatrix(map, 0.0, true);
+  Teuchos::RCP<Epetra_Operator> P = Teuchos::rcp(new Epetra_InvOperator(Ainv.get()));
+
+  TestableDeflatedSolver solver(A, P, params);
+
+  int ierr = solver.SetupDeflation();
+  TEST_EQUALITY(ierr, 0);
+
+  Teuchos::RCP<Epetra_MultiVector> V = solver.DeflationVectors();
+  Teuchos::RCP<Epetra_MultiVector> rhs = solver.DeflationRhs();
+  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > eigs = solver.PrecEigs();
+
+  Teuchos::RCP<Epetra_CrsMatrix> A2 = RotatedDiagonalMatrix(map, 1.0e-3, false);
+  Teuchos::RCP<Epetra_CrsMatrix> A2inv = RotatedDiagonalMatrix(map, 1.0e-3, true);
+  Teuchos::RCP<Epetra_Operator> P2 = Teuchos::rcp(new Epetra_InvOperator(A2inv.get()));
+  solver.SetOperator(A2);
+  solver.SetPrecond(P2);
+
+  ierr = solver.SetupDeflation();
+  TEST_EQUALITY(ierr, 0);
+
+  // The eigensolver was not called, but the basis was replaced
+  TEST_EQUALITY(solver.PrecEigs().get(), eigs.get());
+  TEST_INEQUALITY(solver.DeflationVectors().get(), V.get());
+  TEST_EQUALITY(solver.DeflationVectors()->NumVectors(), 2);
+  TEST_INEQUALITY(solver.DeflationRhs().get(), rhs.get());
+
+  // The refined vectors span the rotated dominant eigenvector
+  Epetra_MultiVector Qe0(map, 1);
+  if (map.MyGID(0))
+    Qe0[0][map.LID(0)] = std::cos(1.0e-3);
+  if (map.MyGID(2))
+    Qe0[0][map.LID(2)] = std::sin(1.0e-3);
+  double projection = 0.0;
+  for (int j = 0; j < solver.DeflationVectors()->NumVectors(); j++)
+    {
+    double dot;
+    (*solver.DeflationVectors())(j)->Dot(*Qe0(0), &dot);
+    projection += dot * dot;
+    }
+  TEST_COMPARE(std::abs(projection - 1.0), <, 1e-6);
+
+  double res = DeflatedSolveResidual(solver, *A2, ierr);
+  TEST_EQUALITY(ierr, 0);
+  TEST_COMPARE(res, <, 1e-6);
+  }
+
+// Without refinement steps the eigensolver is called again if the old
+// deflation vectors are not good enough anymore
+TEUCHOS_UNIT_TEST(Solver, DeflationUpdateRecompute)
+  {
+  Epetra_MpiComm Comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = DeflationParameterList(0);
+
+  Epetra_Map map(200, 0, Comm);
+  Teuchos::RCP<Epetra_CrsMatrix> A = RotatedDiagonalMatrix(map, 0.0, false);
+  Teuchos::RCP<Epetra_CrsMatrix> Ainv = RotatedDiagonalMatrix(map, 0.0, true);
+  Teuchos::RCP<Epetra_Operator> P = Teuchos::rcp(new Epetra_InvOperator(Ainv.get()));
+
+  TestableDeflatedSolver solver(A, P, params);
+
+  int ierr = solver.SetupDeflation();
+  TEST_EQUALITY(ierr, 0);
+
+  Teuchos::RCP<Epetra_MultiVector> V = solver.DeflationVectors();
+  Teuchos::RCP<Anasazi::Eigensolution<double, Epetra_MultiVector> > eigs = solver.PrecEigs();
+
+  Teuchos::RCP<Epetra_CrsMatrix> A2 = RotatedDiagonalMatrix(map, 1.0e-3, false);
+  Teuchos::RCP<Epetra_CrsMatrix> A2inv = RotatedDiagonalMatrix(map, 1.0e-3, true);
+  Teuchos::RCP<Epetra_Operator> P2 = Teuchos::rcp(new Epetra_InvOperator(A2inv.get()));
+  solver.SetOperator(A2);
+  solver.SetPrecond(P2);
+
+  ierr = solver.SetupDeflation();
+  TEST_EQUALITY(ierr, 0);
+
+  TEST_INEQUALITY(solver.PrecEigs().get(), eigs.get());
+  TEST_INEQUALITY(solver.DeflationVectors().get(), V.get());
+
+  double res = DeflatedSolveResidual(solver, *A2, ierr);
+  TEST_EQUALITY(ierr, 0);
+  TEST_COMPARE(res, <, 1e-6);
+  }
+
 #ifdef HAVE_TEUCHOS_COMPLEX
 
 TEUCHOS_UNIT_TEST(Solver, ComplexSolver)
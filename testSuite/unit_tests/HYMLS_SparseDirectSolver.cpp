@@ -1,9 +1,13 @@
 #include "HYMLS_SparseDirectSolver.hpp"
 
+#include "HYMLS_config.h"
+
 #include "Epetra_SerialComm.h"
 #include "Epetra_Map.h"
 #include "Epetra_CrsMatrix.h"
+#include "Epetra_Vector.h"
 
+#include "Galeri_CrsMatrices.h"
 #include "GaleriExt_Stokes2D.h"
 
 #include "HYMLS_Macros.hpp"
@@ -150,3 +154,133 @@ TEUCHOS_UNIT_TEST(SparseDirectSolver, CustomOrdering)
 
   TEST_EQUALITY(solver->NumGlobalNonzerosL(), 2033); // 2134 in the paper
   }
+
+TEUCHOS_UNIT_TEST(SparseDirectSolver, Counters)
+  {
+  DISABLE_OUTPUT;
+  Teuchos::RCP<Epetra_CrsMatrix> A = createStokesMatrix(5);
+  Teuchos::RCP<HYMLS::SparseDirectSolver> solver =
+    Teuchos::rcp(new HYMLS::SparseDirectSolver(A.get()));
+
+  CHECK_ZERO(solver->Initialize());
+  CHECK_ZERO(solver->Compute());
+
+  Epetra_Vector b(A->RowMap());
+  Epetra_Vector x(A->RowMap());
+  CHECK_ZERO(b.PutScalar(1.0));
+  CHECK_ZERO(solver->ApplyInverse(b, x));
+  CHECK_ZERO(solver->ApplyInverse(b, x));
+
+  TEST_EQUALITY(solver->NumInitialize(), 1);
+  TEST_EQUALITY(solver->NumCompute(), 1);
+  TEST_EQUALITY(solver->NumApplyInverse(), 2);
+
+  TEST_COMPARE(solver->InitializeTime(), >=, 0.0);
+  TEST_COMPARE(solver->ComputeTime(), >=, 0.0);
+  TEST_COMPARE(solver->ApplyInverseTime(), >=, 0.0);
+
+  TEST_COMPARE(solver->ComputeFlops(), >, 0.0);
+  double nnzLU = solver->NumGlobalNonzerosL() + solver->NumGlobalNonzerosU();
+  TEST_EQUALITY(solver->ApplyInverseFlops(), 4 * nnzLU);
+  }
+
+TEUCHOS_UNIT_TEST(SparseDirectSolver, RecomputeNewValues)
+  {
+  DISABLE_OUTPUT;
+  Teuchos::RCP<Epetra_CrsMatrix> A = createStokesMatrix(5);
+
+  Teuchos::ParameterList params;
+  params.set("Custom Ordering", true);
+
+  Teuchos::RCP<HYMLS::SparseDirectSolver> solver =
+    Teuchos::rcp(new HYMLS::SparseDirectSolver(A.get()));
+  CHECK_ZERO(solver->SetParameters(params));
+  CHECK_ZERO(solver->Initialize());
+  CHECK_ZERO(solver->Compute());
+
+  // Change the values but not the pattern and compute again
+  Epetra_Vector scaling(A->RowMap());
+  CHECK_ZERO(scaling.Random());
+  CHECK_ZERO(scaling.Abs(scaling));
+  CHECK_ZERO(scaling.Shift(1.0));
+  CHECK_ZERO(A->LeftScale(scaling));
+  CHECK_ZERO(solver->Compute());
+
+  Epetra_Vector x_ex(A->RowMap());
+  Epetra_Vector b(A->RowMap());
+  Epetra_Vector x(A->RowMap());
+  CHECK_ZERO(x_ex.Random());
+  CHECK_ZERO(A->Multiply(false, x_ex, b));
+  CHECK_ZERO(solver->ApplyInverse(b, x));
+
+  ENABLE_OUTPUT;
+
+  TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(x, x_ex), <, 1e-8);
+  }
+
+TEUCHOS_UNIT_TEST(SparseDirectSolver, Cholmod)
+  {
+  DISABLE_OUTPUT;
+
+  Teuchos::ParameterList params;
+  params.set("amesos: solver type", "CHOLMOD");
+
+  // A positive and a negative definite matrix, which CHOLMOD should
+  // factor, and a nonsymmetric and a Stokes matrix for which we should
+  // switch to an LU factorization. Without SuiteSparse this just uses
+  // KLU.
+  Epetra_SerialComm comm;
+  Epetra_Map map(64, 0, comm);
+  Teuchos::ParameterList galeriList;
+  galeriList.set("nx", 8);
+  galeriList.set("ny", 8);
+
+  Teuchos::Array<Teuchos::RCP<Epetra_CrsMatrix> > matrices;
+  Teuchos::Array<HYMLS::SparseDirectSolver::SolverType> methods;
+
+  matrices.append(Teuchos::rcp(Galeri::CreateCrsMatrix("Laplace2D", &map, galeriList)));
+  methods.append(HYMLS::SparseDirectSolver::CHOLMOD);
+
+  matrices.append(Teuchos::rcp(Galeri::CreateCrsMatrix("Laplace2D", &map, galeriList)));
+  CHECK_ZERO(matrices.back()->Scale(-1.0));
+  methods.append(HYMLS::SparseDirectSolver::CHOLMOD);
+
+  // Convection-diffusion with a positive diagonal
+  Teuchos::ParameterList recircList(galeriList);
+  recircList.set("conv", 1.0);
+  recircList.set("diff", 1.0);
+  matrices.append(Teuchos::rcp(Galeri::CreateCrsMatrix("Recirc2D", &map, recircList)));
+  methods.append(HYMLS::SparseDirectSolver::UMFPACK);
+
+  matrices.append(createStokesMatrix(5));
+  methods.append(HYMLS::SparseDirectSolver::UMFPACK);
+
+  for (int i = 0; i < matrices.size(); i++)
+    {
+    Teuchos::RCP<Epetra_CrsMatrix> const &A = matrices[i];
+    Teuchos::RCP<HYMLS::SparseDirectSolver> solver =
+      Teuchos::rcp(new HYMLS::SparseDirectSolver(A.get()));
+    CHECK_ZERO(solver->SetParameters(params));
+    CHECK_ZERO(solver->Initialize());
+    CHECK_ZERO(solver->Compute());
+
+#if defined(HAVE_SUITESPARSE)
+    TEST_EQUALITY(solver->Method(), methods[i]);
+#elif defined(HYMLS_USE_SUITESPARSE)
+    // SuiteSparse was requested but not found, the solver falls back to KLU
+    // and this should fail
+    TEST_EQUALITY(solver->Method(), methods[i]);
+#else
+    TEST_EQUALITY(solver->Method(), HYMLS::SparseDirectSolver::KLU);
+#endif
+
+    Epetra_Vector x_ex(A->RowMap());
+    Epetra_Vector b(A->RowMap());
+    Epetra_Vector x(A->RowMap());
+    CHECK_ZERO(x_ex.Random());
+    CHECK_ZERO(A->Multiply(false, x_ex, b));
+    CHECK_ZERO(solver->ApplyInverse(b, x));
+
+    TEST_COMPARE(HYMLS::UnitTests::NormInfAminusB(x, x_ex), <, 1e-8);
+    }
+  }
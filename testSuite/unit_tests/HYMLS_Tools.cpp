@@ -3,9 +3,14 @@
 
 #include "Epetra_Map.h"
 #include "Epetra_SerialComm.h"
+#include "Epetra_MpiComm.h"
 
 #include "HYMLS_UnitTests.hpp"
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 // A class for which we can set the number of processors that are available.
 class SplitBoxComm : public Epetra_SerialComm {
     int numProc_;
@@ -53,3 +58,40 @@ TEUCHOS_UNIT_TEST(Tools, SplitBox)
   TEST_EQUALITY(ny, 5);
   TEST_EQUALITY(nz, 5);
   }
+
+TEUCHOS_UNIT_TEST(Tools, Trace)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  // The buffer only keeps the last 4 events
+  HYMLS::Tools::StartTracing(4);
+  for (int i = 0; i < 6; i++)
+    {
+    HYMLS::TimerObject timer("Tools: trace test", false);
+    }
+
+  // All processes write to the same file
+  std::string filename = "trace_test.json";
+  HYMLS::Tools::WriteTrace(filename);
+  comm.Barrier();
+
+  if (comm.MyPID() == 0)
+    {
+    std::ifstream ifs(filename.c_str());
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    std::string s = ss.str();
+
+    TEST_EQUALITY(s.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": ["), 0);
+    TEST_EQUALITY(s.substr(s.length() - 3), "]}\n");
+
+    int numEvents = 0;
+    for (size_t pos = s.find("Tools: trace test"); pos != std::string::npos;
+         pos = s.find("Tools: trace test", pos + 1))
+      numEvents++;
+    TEST_EQUALITY(numEvents, 4 * comm.NumProc());
+
+    std::remove(filename.c_str());
+    }
+  }
@@ -0,0 +1,166 @@
+#include "NOX_Epetra_LinearSystem_Hymls.hpp"
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+#include <Epetra_MpiComm.h>
+#include <Epetra_Map.h>
+#include <Epetra_Vector.h>
+#include <Epetra_CrsMatrix.h>
+
+#include "NOX_Epetra_Interface_Jacobian.H"
+#include "NOX_Epetra_Interface_Preconditioner.H"
+#include "NOX_Epetra_Vector.H"
+
+#include "Galeri_CrsMatrices.h"
+#include "HYMLS_UnitTests.hpp"
+
+typedef NOX::Epetra::LinearSystem::PreconditionerReusePolicyType PolicyType;
+
+class TestableLinearSystemHymls: public NOX::Epetra::LinearSystemHymls
+  {
+public:
+  TestableLinearSystemHymls(
+    Teuchos::ParameterList &printParams,
+    Teuchos::ParameterList &linearSolverParams,
+    const Teuchos::RCP<NOX::Epetra::Interface::Jacobian> &iJac,
+    const Teuchos::RCP<Epetra_Operator> &J,
+    const Teuchos::RCP<NOX::Epetra::Interface::Preconditioner> &iPrec,
+    const Teuchos::RCP<Epetra_Operator> &M,
+    const NOX::Epetra::Vector &cloneVector)
+    :
+    NOX::Epetra::LinearSystemHymls(printParams, linearSolverParams,
+      iJac, J, iPrec, M, cloneVector)
+    {}
+
+  //! pretend that the preconditioner was built
+  void SetPrecConstructed(bool constructed)
+    {
+    isPrecConstructed = constructed;
+    }
+
+  //! pretend that the last linear solve took this many iterations
+  void SetLastNumIter(int numIter)
+    {
+    lastNumIter_ = numIter;
+    }
+  };
+
+// The policy does not call the interface, but we need one
+class TestInterface: public NOX::Epetra::Interface::Jacobian,
+                     public NOX::Epetra::Interface::Preconditioner
+  {
+public:
+  bool computeJacobian(const Epetra_Vector &x, Epetra_Operator &Jac)
+    {
+    return true;
+    }
+
+  bool computePreconditioner(const Epetra_Vector &x, Epetra_Operator &M,
+    Teuchos::ParameterList *precParams)
+    {
+    return true;
+    }
+  };
+
+Teuchos::RCP<TestableLinearSystemHymls> createLinearSystem(
+  Teuchos::ParameterList &linearSolverParams, Epetra_Comm const &comm)
+  {
+  Teuchos::ParameterList galeriList;
+  galeriList.set("n", 16);
+  Epetra_Map map(16, 0, comm);
+  Teuchos::RCP<Epetra_CrsMatrix> A = Teuchos::rcp(
+    Galeri::CreateCrsMatrix("Laplace1D", &map, galeriList));
+
+  Teuchos::RCP<TestInterface> iface = Teuchos::rcp(new TestInterface);
+  Epetra_Vector x(A->RowMap());
+  NOX::Epetra::Vector cloneVector(x);
+
+  // The matrix itself is used as preconditioner, the policy does not
+  // depend on the type of preconditioner
+  linearSolverParams.set("Preconditioner", "User Defined");
+  Teuchos::ParameterList printParams;
+  return Teuchos::rcp(new TestableLinearSystemHymls(printParams,
+      linearSolverParams, iface, A, iface, A, cloneVector));
+  }
+
+TEUCHOS_UNIT_TEST(LinearSystemHymls, NoReusePolicy)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  // Without the sublist NOX decides, which rebuilds by default
+  Teuchos::ParameterList linearSolverParams;
+  Teuchos::RCP<TestableLinearSystemHymls> linsys =
+    createLinearSystem(linearSolverParams, comm);
+
+  ENABLE_OUTPUT;
+
+  linsys->SetPrecConstructed(true);
+  for (int i = 0; i < 3; i++)
+    TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REBUILD);
+  }
+
+TEUCHOS_UNIT_TEST(LinearSystemHymls, RefactorInterval)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  Teuchos::ParameterList linearSolverParams;
+  linearSolverParams.sublist("HYMLS Preconditioner Reuse").set("Refactor Interval", 3);
+  Teuchos::RCP<TestableLinearSystemHymls> linsys =
+    createLinearSystem(linearSolverParams, comm);
+
+  ENABLE_OUTPUT;
+
+  // The first preconditioner is always built
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REBUILD);
+  linsys->SetPrecConstructed(true);
+
+  // It is used in 3 Newton steps, after which it is rebuilt
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REUSE);
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REUSE);
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REBUILD);
+
+  // Asking without advancing the counter does not age the preconditioner
+  for (int i = 0; i < 3; i++)
+    TEST_EQUALITY(linsys->getPreconditionerPolicy(false), NOX::Epetra::LinearSystem::PRPT_REUSE);
+
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REUSE);
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REUSE);
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REBUILD);
+  }
+
+TEUCHOS_UNIT_TEST(LinearSystemHymls, IterationThreshold)
+  {
+  Epetra_MpiComm comm(MPI_COMM_WORLD);
+  DISABLE_OUTPUT;
+
+  Teuchos::ParameterList linearSolverParams;
+  Teuchos::ParameterList &reuseList = linearSolverParams.sublist("HYMLS Preconditioner Reuse");
+  reuseList.set("Refactor Interval", 0);
+  reuseList.set("Iteration Threshold", 10);
+  reuseList.set("Reuse Pattern", true);
+  Teuchos::RCP<TestableLinearSystemHymls> linsys =
+    createLinearSystem(linearSolverParams, comm);
+
+  ENABLE_OUTPUT;
+
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REBUILD);
+  linsys->SetPrecConstructed(true);
+
+  // Without a refactor interval the preconditioner is kept as long as
+  // the linear solves converge fast enough
+  for (int i = 0; i < 5; i++)
+    {
+    linsys->SetLastNumIter(10);
+    TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REUSE);
+    }
+
+  // With "Reuse Pattern" only the numerical part is redone
+  linsys->SetLastNumIter(11);
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_RECOMPUTE);
+
+  // The iteration count of the old preconditioner is forgotten
+  TEST_EQUALITY(linsys->getPreconditionerPolicy(), NOX::Epetra::LinearSystem::PRPT_REUSE);
+  }